@@ -25,7 +25,7 @@
 
 #define LOG_TAG "texgz"
 #include "libcc/cc_log.h"
-#include "texgz_inlier.h"
+#include "texgz/texgz_inlier.h"
 #include "../texgz_png.h"
 
 /***********************************************************
@@ -25,77 +25,10 @@
 #include <string.h>
 
 #define LOG_TAG "texgz"
-#include "libcc/math/cc_pow2n.h"
 #include "libcc/cc_log.h"
 #include "texgz/texgz_png.h"
-#include "texgz/pil_lanczos.h"
 
-#define TEXGZ_MIPMAP_SIZE_MAX 257
-
-#define TEXGZ_MIPMAP_METHOD_BOX      0
-#define TEXGZ_MIPMAP_METHOD_LANCZOS3 1
-
-/***********************************************************
-* private                                                  *
-***********************************************************/
-
-static int
-texgz_mipmap(texgz_tex_t* src, int method, int level,
-             texgz_tex_t* conv, texgz_tex_t* dst)
-{
-	ASSERT(src);
-	ASSERT(conv);
-	ASSERT(dst);
-
-	float support[] =
-	{
-		0.5f, // TEXGZ_MIPMAP_METHOD_BOX
-		3.0f, // TEXGZ_MIPMAP_METHOD_LANCZOS3
-	};
-
-	// default box filter
-	float mask[TEXGZ_MIPMAP_SIZE_MAX] =
-	{
-		0.5f,
-		0.5f,
-	};
-
-	// determine filter size
-	int   scale  = cc_pow2n(level);
-	float scalef = (float) scale;
-	int   n      = (int) (scalef*support[method] + 0.01f);
-	int   size   = 2*n;
-	if(size >= TEXGZ_MIPMAP_SIZE_MAX)
-	{
-		LOGE("unsupported method=%i, level=%i",
-		     method, level);
-		return 0;
-	}
-
-	// generate masks
-	if(method == TEXGZ_MIPMAP_METHOD_LANCZOS3)
-	{
-		float step = 1.0f/scalef;
-		float x    = support[method] - step/2.0f;
-		float y;
-		int   i;
-		for(i = 0; i < n; ++i)
-		{
-			y = pil_lanczos3_filter(x)/scale;
-			mask[i]            = y;
-			mask[size - i - 1] = y;
-			x -= step;
-		}
-	}
-
-	// apply filter and decimate
-	texgz_tex_convolveF(src,  conv,
-	                    size, 1, scale, 1, mask);
-	texgz_tex_convolveF(conv, dst,
-	                    1, size, 1, scale, mask);
-
-	return 1;
-}
+#define TEXGZ_MIPMAP_LEVEL_MAX 16
 
 /***********************************************************
 * public                                                   *
@@ -103,100 +36,99 @@ texgz_mipmap(texgz_tex_t* src, int method, int level,
 
 int main(int argc, char** argv)
 {
-	if(argc != 5)
+	if((argc != 5) && (argc != 6))
 	{
-		LOGE("usage: %s method level src.png dst.png", argv[0]);
-		LOGE("method: box | lanczos3");
+		LOGE("usage: %s method level src.png dst.png [depth]",
+		     argv[0]);
+		LOGE("method: box | lanczos3 | inlier");
 		LOGE("level: mipmap level (1 to N)");
+		LOGE("depth: resampling depth (0=recursive, 1=direct)");
 		return EXIT_FAILURE;
 	}
 
 	int method = TEXGZ_MIPMAP_METHOD_BOX;
 	int level  = (int) strtol(argv[2], NULL, 0);
+	int depth  = 0;
 	if(strcmp(argv[1], "lanczos3") == 0)
 	{
 		method = TEXGZ_MIPMAP_METHOD_LANCZOS3;
-		if(level < 1)
-		{
-			LOGE("invalid level=%i", level);
-			return EXIT_FAILURE;
-		}
+
+		// lanczos3 defaults to filtering directly from
+		// the base level
+		depth = 1;
 	}
-	else
+	else if(strcmp(argv[1], "inlier") == 0)
 	{
-		// box only supports zoom level 1
-		// e.g. recursively apply box filter
-		if(level != 1)
-		{
-			LOGE("invalid level=%i", level);
-			return EXIT_FAILURE;
-		}
+		method = TEXGZ_MIPMAP_METHOD_INLIER;
+
+		// inlier defaults to rejecting outliers over the
+		// full footprint of the base level
+		depth = 1;
 	}
 
-	texgz_tex_t* src;
-	src = texgz_png_import(argv[3]);
-	if(src == NULL)
+	if(argc == 6)
 	{
-		return EXIT_FAILURE;
+		depth = (int) strtol(argv[5], NULL, 0);
 	}
 
-	int dst_width  = src->width/cc_pow2n(level);
-	int dst_height = src->height/cc_pow2n(level);
-
-	if((src->width%dst_width) || (src->height%dst_height))
+	if((level < 1) || (level >= TEXGZ_MIPMAP_LEVEL_MAX) ||
+	   (depth < 0))
 	{
-		LOGE("invalid width=%i:%i, height=%i:%i",
-		     src->width,  dst_width,
-		     src->height, dst_height);
-		goto fail_src_size;
+		LOGE("invalid level=%i, depth=%i", level, depth);
+		return EXIT_FAILURE;
 	}
 
-	if(texgz_tex_convertF(src, 0.0f, 1.0f,
-	                      TEXGZ_FLOAT,
-	                      TEXGZ_RGBA) == 0)
+	texgz_tex_t* src;
+	src = texgz_png_import(argv[3]);
+	if(src == NULL)
 	{
-		goto fail_convert_src;
+		return EXIT_FAILURE;
 	}
 
-	texgz_tex_t* conv;
-	conv = texgz_tex_new(dst_width, src->height,
-	                     dst_width, src->height,
-	                     TEXGZ_FLOAT, TEXGZ_RGBA,
-	                     NULL);
-	if(conv == NULL)
+	if(texgz_tex_convert(src, TEXGZ_UNSIGNED_BYTE,
+	                     TEXGZ_RGBA) == 0)
 	{
-		goto fail_conv;
+		goto fail_convert;
 	}
 
-	texgz_tex_t* dst;
-	dst = texgz_tex_new(dst_width, dst_height,
-	                    dst_width, dst_height,
-	                    TEXGZ_FLOAT, TEXGZ_RGBA,
-	                    NULL);
-	if(dst == NULL)
+	// determine the filter plan
+	int miplevels = level + 1;
+	texgz_mipmapPlan_t plan[TEXGZ_MIPMAP_LEVEL_MAX];
+	if(texgz_tex_mipmapPlan(src->width, src->height,
+	                        method, depth, miplevels,
+	                        plan) == 0)
 	{
-		goto fail_dst;
+		goto fail_plan;
 	}
 
-	if(texgz_mipmap(src, method, level, conv, dst) == 0)
+	int l;
+	for(l = 1; l < miplevels; ++l)
 	{
-		goto fail_mipmap;
+		LOGI("level=%i, src=%i, depth=%i, scale=%ix%i, "
+		     "taps=%ix%i, cost=%0.0lf",
+		     l, plan[l].src, plan[l].depth,
+		     plan[l].scalex, plan[l].scaley,
+		     plan[l].tapsx,  plan[l].tapsy,
+		     plan[l].cost);
 	}
 
-	if(texgz_tex_convertF(dst, 0.0f, 1.0f,
-	                      TEXGZ_UNSIGNED_BYTE,
-	                      TEXGZ_RGBA) == 0)
+	texgz_tex_t* mipmaps[TEXGZ_MIPMAP_LEVEL_MAX];
+	if(texgz_tex_mipmapPlanned(src, method, miplevels,
+	                           plan, mipmaps) == 0)
 	{
-		goto fail_convert_dst;
+		goto fail_mipmap;
 	}
 
-	if(texgz_png_export(dst, argv[4]) == 0)
+	if(texgz_png_export(mipmaps[level], argv[4]) == 0)
 	{
 		goto fail_export;
 	}
 
-	texgz_tex_delete(&dst);
-	texgz_tex_delete(&conv);
+	// note that mipmaps[0] is src
+	for(l = 1; l < miplevels; ++l)
+	{
+		texgz_tex_delete(&mipmaps[l]);
+	}
 	texgz_tex_delete(&src);
 
 	// success
@@ -204,14 +136,15 @@ int main(int argc, char** argv)
 
 	// failure
 	fail_export:
-	fail_convert_dst:
+	{
+		for(l = 1; l < miplevels; ++l)
+		{
+			texgz_tex_delete(&mipmaps[l]);
+		}
+	}
 	fail_mipmap:
-		texgz_tex_delete(&dst);
-	fail_dst:
-		texgz_tex_delete(&conv);
-	fail_conv:
-	fail_convert_src:
-	fail_src_size:
+	fail_plan:
+	fail_convert:
 		texgz_tex_delete(&src);
 	return EXIT_FAILURE;
 }
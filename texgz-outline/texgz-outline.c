@@ -52,8 +52,19 @@ int main(int argc, char** argv)
 		goto fail_convert1;
 	}
 
+	// the outline masks are limited to sizes 3-11 and
+	// other sizes are derived from the distance field
 	int          size = (int) strtol(argv[1], NULL, 0);
-	texgz_tex_t* out  = texgz_tex_outline(tex, size);
+	texgz_tex_t* out  = NULL;
+	if((size >= 3) && (size <= 11) && (size%2 == 1))
+	{
+		out = texgz_tex_outline(tex, size);
+	}
+	else
+	{
+		out = texgz_tex_outlineSDF(tex, ((float) size)/2.0f);
+	}
+
 	if(out == NULL)
 	{
 		goto fail_outline;
@@ -8,7 +8,29 @@
 # r: recenter clusters
 # steps: maximum step count
 
-../texgz-slic 8 10.0 0.0 3 1 10 tomato-256
-../texgz-slic 8  1.0 2.0 3 0 10 tomato-256
-../texgz-slic 8  1.0 1.0 3 0 10 tomato-256
-../texgz-slic 8  1.0 0.0 3 0 10 tomato-256
+# the label hash is pinned to detect unintended changes to
+# the superpixels and must be updated when the results
+# change intentionally where the cluster statistics are
+# accumulated per chunk of rows rather than per thread so
+# the hash does not depend on the thread count (these cases
+# were checked at 1, 2, 3, 5, 8, 16 and 64 threads)
+STATUS=0
+check()
+{
+	EXPECT=$1
+	shift
+
+	LABELS=$(../texgz-slic "$@" 2>&1 | tee /dev/stderr |
+	         sed -n 's/^.*labels=\(0x[0-9A-F]*\).*$/\1/p')
+	if [ "$LABELS" != "$EXPECT" ]; then
+		echo "FAILED: texgz-slic $* labels=$LABELS expected=$EXPECT"
+		STATUS=1
+	fi
+}
+
+check 0x1EEBF550 8 10.0 0.0 3 1 10 tomato-256
+check 0xF5B12691 8  1.0 2.0 3 0 10 tomato-256
+check 0xEAE5737C 8  1.0 1.0 3 0 10 tomato-256
+check 0x6249F4FE 8  1.0 0.0 3 0 10 tomato-256
+
+exit $STATUS
@@ -36,6 +36,36 @@
 * private                                                  *
 ***********************************************************/
 
+static uint32_t
+hash_labels(texgz_slic_t* slic)
+{
+	ASSERT(slic);
+
+	// FNV-1a hash of the label map which is independent of
+	// the thread count and is pinned by run-tomato-256.sh
+	texgz_tex_t* input = slic->input;
+
+	int      i;
+	int      x;
+	int      y;
+	uint32_t label;
+	uint32_t hash = 2166136261u;
+	for(y = 0; y < input->height; ++y)
+	{
+		for(x = 0; x < input->width; ++x)
+		{
+			label = (uint32_t) slic->labels[y*input->stride + x];
+			for(i = 0; i < 4; ++i)
+			{
+				hash ^= (label >> (8*i)) & 0xFF;
+				hash *= 16777619u;
+			}
+		}
+	}
+
+	return hash;
+}
+
 static int
 save_output(texgz_slic_t* slic, texgz_tex_t* sp,
             float min, float max,
@@ -108,15 +138,161 @@ save_image(texgz_tex_t* tex, float min, float max,
 	return 0;
 }
 
+static int
+save_labels(texgz_slic_t* slic, const char* fname)
+{
+	ASSERT(slic);
+	ASSERT(fname);
+
+	texgz_tex_t* labels = texgz_slic_labels(slic);
+	if(labels == NULL)
+	{
+		return 0;
+	}
+
+	if(texgz_tex_exportz(labels, fname) == 0)
+	{
+		goto fail_export;
+	}
+
+	texgz_tex_delete(&labels);
+
+	// success
+	return 1;
+
+	// failure
+	fail_export:
+		texgz_tex_delete(&labels);
+	return 0;
+}
+
+static int
+save_features(texgz_slic_t* slic, const char* fname)
+{
+	ASSERT(slic);
+	ASSERT(fname);
+
+	int K = slic->kw*slic->kh;
+
+	texgz_slicFeature_t* features;
+	features = (texgz_slicFeature_t*)
+	           CALLOC(K, sizeof(texgz_slicFeature_t));
+	if(features == NULL)
+	{
+		LOGE("CALLOC failed");
+		return 0;
+	}
+
+	texgz_slic_features(slic, features);
+
+	FILE* f = fopen(fname, "w");
+	if(f == NULL)
+	{
+		LOGE("invalid fname=%s", fname);
+		goto fail_fopen;
+	}
+
+	if(fwrite(features, sizeof(texgz_slicFeature_t), K,
+	          f) != K)
+	{
+		LOGE("fwrite failed");
+		goto fail_fwrite;
+	}
+
+	fclose(f);
+	FREE(features);
+
+	// success
+	return 1;
+
+	// failure
+	fail_fwrite:
+		fclose(f);
+	fail_fopen:
+		FREE(features);
+	return 0;
+}
+
+static int
+read_rows(void* priv, int y, int rows, float* pixels)
+{
+	ASSERT(priv);
+	ASSERT(pixels);
+
+	texgz_tex_t* tex = (texgz_tex_t*) priv;
+
+	// the input is resident so the rows are copied however a
+	// large image would be read incrementally
+	int    i;
+	float* src = (float*) tex->pixels;
+	for(i = 0; i < rows; ++i)
+	{
+		memcpy(&pixels[4*i*tex->width],
+		       &src[4*(y + i)*tex->stride],
+		       4*tex->width*sizeof(float));
+	}
+
+	return 1;
+}
+
+static int
+save_stream(texgz_tex_t* tex, int s, float m, float sdx,
+            int n, int r, int steps, float epsilon,
+            const char* base)
+{
+	ASSERT(tex);
+	ASSERT(base);
+
+	char fname_labels[256];
+	char fname_stats[256];
+	snprintf(fname_labels, 256, "%s-stream-labels.bin", base);
+	snprintf(fname_stats,  256, "%s-stream-stats.bin",  base);
+
+	FILE* flabels = fopen(fname_labels, "w");
+	if(flabels == NULL)
+	{
+		LOGE("invalid fname=%s", fname_labels);
+		return 0;
+	}
+
+	FILE* fstats = fopen(fname_stats, "w");
+	if(fstats == NULL)
+	{
+		LOGE("invalid fname=%s", fname_stats);
+		goto fail_fstats;
+	}
+
+	if(texgz_slic_stream(tex->width, tex->height,
+	                     s, m, sdx, n, r, steps, epsilon,
+	                     read_rows, tex,
+	                     flabels, fstats) == 0)
+	{
+		goto fail_stream;
+	}
+
+	fclose(fstats);
+	fclose(flabels);
+
+	// success
+	return 1;
+
+	// failure
+	fail_stream:
+		fclose(fstats);
+	fail_fstats:
+		fclose(flabels);
+	return 0;
+}
+
 /***********************************************************
 * public                                                   *
 ***********************************************************/
 
 int main(int argc, char** argv)
 {
-	if(argc != 8)
+	if((argc < 8) || (argc > 11))
 	{
-		LOGE("usage: %s s m sdx n r steps prefix",
+		LOGE("usage: %s s m sdx n r steps prefix [epsilon] [levels] [stream]",
 		     argv[0]);
 		LOGE("s: superpixel size (sxs)");
 		LOGE("m: compactness control");
@@ -124,6 +300,9 @@ int main(int argc, char** argv)
 		LOGE("n: gradient neighborhood (nxn)");
 		LOGE("r: recenter clusters");
 		LOGE("steps: maximum step count");
+		LOGE("epsilon: residual error threshold (default 0.0)");
+		LOGE("levels: coarse levels (default 0)");
+		LOGE("stream: streaming segmentation (default 0)");
 		return EXIT_FAILURE;
 	}
 
@@ -136,6 +315,36 @@ int main(int argc, char** argv)
 
 	const char* prefix = argv[7];
 
+	float epsilon = 0.0f;
+	if(argc >= 9)
+	{
+		epsilon = strtof(argv[8], NULL);
+	}
+
+	int levels = 0;
+	if(argc >= 10)
+	{
+		levels = (int) strtol(argv[9], NULL, 0);
+	}
+
+	int stream = 0;
+	if(argc >= 11)
+	{
+		stream = (int) strtol(argv[10], NULL, 0);
+	}
+
+	// the streaming segmentation is single-scale
+	if(stream && levels)
+	{
+		LOGE("invalid stream=%i, levels=%i", stream, levels);
+		return EXIT_FAILURE;
+	}
+
+	char base[256];
+	snprintf(base, 256, "%s-%i-%i-%i-%i-%i",
+	         prefix, s, (int) (10.0f*m), (int) (10.0f*sdx),
+	         n, r);
+
 	char input[256];
 	snprintf(input, 256, "%s.png", prefix);
 
@@ -157,6 +366,20 @@ int main(int argc, char** argv)
 		goto fail_convert_tex;
 	}
 
+	if(stream)
+	{
+		if(save_stream(tex, s, m, sdx, n, r, steps, epsilon,
+		               base) == 0)
+		{
+			goto fail_stream;
+		}
+
+		texgz_tex_delete(&tex);
+
+		// success
+		return EXIT_SUCCESS;
+	}
+
 	texgz_tex_t* gray = texgz_tex_grayscaleF(tex);
 	if(gray == NULL)
 	{
@@ -198,39 +421,41 @@ int main(int argc, char** argv)
 	texgz_tex_convolveF(gray, gx, 3, 3, 1, 1, sobelx);
 	texgz_tex_convolveF(gray, gy, 3, 3, 1, 1, sobely);
 
-	texgz_slic_t* slic = texgz_slic_new(tex, s, m, sdx, n, r);
+	texgz_slic_t* slic;
+	slic = texgz_slic_new(tex, s, m, sdx, n, r, levels);
 	if(slic == NULL)
 	{
 		goto fail_slic;
 	}
 
 	// solve slic superpixels
-	// TODO - loop for steps or until E <= thresh
-	int step;
-	for(step = 0; step < steps; ++step)
+	int count = texgz_slic_solve(slic, steps, epsilon);
+	LOGI("steps=%i, error=%f", count, texgz_slic_error(slic));
+
+	// merge fragments smaller than a quarter superpixel
+	if(texgz_slic_connect(slic, s*s/4) == 0)
 	{
-		texgz_slic_step(slic, step);
+		goto fail_connect;
 	}
-
-	// TODO - enforce connectivity
+	LOGI("labels=0x%08X", hash_labels(slic));
 
 	// output names
-	char base[256];
 	char fname_avg[256];
 	char fname_slic[256];
 	char fname_stddev[256];
 	char fname_outlier[256];
 	char fname_gx[256];
 	char fname_gy[256];
-	snprintf(base, 256, "%s-%i-%i-%i-%i-%i",
-	         prefix, s, (int) (10.0f*m), (int) (10.0f*sdx),
-	         n, r);
+	char fname_labels[256];
+	char fname_features[256];
 	snprintf(fname_avg,    256, "%s-avg.png",    base);
 	snprintf(fname_slic,    256, "%s-slic.png",    base);
 	snprintf(fname_stddev, 256, "%s-stddev.png", base);
 	snprintf(fname_outlier, 256, "%s-outlier.png", base);
 	snprintf(fname_gx, 256, "%s-gx.png", base);
 	snprintf(fname_gy, 256, "%s-gy.png", base);
+	snprintf(fname_labels, 256, "%s-labels.texz", base);
+	snprintf(fname_features, 256, "%s-features.bin", base);
 
 	// save avg
 	save_output(slic, slic->sp_avg,
@@ -267,6 +492,8 @@ int main(int argc, char** argv)
 	save_image(gy, -0.25f, 0.25f, fname_gy);
 	save_image(slic->sp_outlier, 0.0f, 1.0f, fname_outlier);
 	save_image(slic->sp_avg, 0.0f, 1.0f, fname_slic);
+	save_labels(slic, fname_labels);
+	save_features(slic, fname_features);
 
 	texgz_slic_delete(&slic);
 	texgz_tex_delete(&gy);
@@ -278,6 +505,8 @@ int main(int argc, char** argv)
 	return EXIT_SUCCESS;
 
 	// failure
+	fail_connect:
+		texgz_slic_delete(&slic);
 	fail_slic:
 		texgz_tex_delete(&gy);
 	fail_gy:
@@ -285,6 +514,7 @@ int main(int argc, char** argv)
 	fail_gx:
 		texgz_tex_delete(&gray);
 	fail_gray:
+	fail_stream:
 	fail_convert_tex:
 		texgz_tex_delete(&tex);
 	return EXIT_FAILURE;
@@ -21,6 +21,7 @@
  *
  */
 
+#include <float.h>
 #include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -30,33 +31,30 @@
 #include "libcc/cc_log.h"
 #include "libcc/cc_memory.h"
 #include "texgz/texgz_png.h"
+#include "texgz/texgz_sat.h"
+#include "texgz/texgz_thread.h"
 #include "texgz_slic.h"
 
-/***********************************************************
-* private                                                  *
-***********************************************************/
+// pixels per distance evaluation
+#define TEXGZ_SLIC_LANES 8
 
-static texgz_slicCluster_t*
-texgz_slic_cluster(texgz_slic_t* self, int i, int j)
-{
-	ASSERT(self);
-	ASSERT(i < self->kh);
-	ASSERT(j < self->kw);
+// full resolution steps after solving the coarse level
+#define TEXGZ_SLIC_REFINE_STEPS 2
 
-	return &self->clusters[i*self->kw + j];
-}
+// cluster rows above/below each chunk of samples whose
+// statistics are accumulated per chunk
+#define TEXGZ_SLIC_CHUNK_RADIUS 2
+#define TEXGZ_SLIC_CHUNK_SIZE   (2*TEXGZ_SLIC_CHUNK_RADIUS + 1)
 
-static texgz_slicSample_t*
-texgz_slic_sample(texgz_slic_t* self, int x, int y)
+typedef struct
 {
-	ASSERT(self);
-
-	texgz_tex_t* input = self->input;
-	ASSERT(x < input->width);
-	ASSERT(y < input->height);
+	texgz_slic_t* self;
+	int           step;
+} texgz_slicTask_t;
 
-	return &self->samples[y*input->stride + x];
-}
+/***********************************************************
+* private                                                  *
+***********************************************************/
 
 static float
 texgz_slic_gradient(texgz_slic_t* self, int x, int y)
@@ -70,6 +68,17 @@ texgz_slic_gradient(texgz_slic_t* self, int x, int y)
 	int xm = x - 1;
 	int ym = y - 1;
 
+	// the neighborhood of the last superpixel reaches the
+	// image edge when s is even and n = s - 1
+	if(xp >= self->input->width)
+	{
+		xp = self->input->width - 1;
+	}
+	if(yp >= self->input->height)
+	{
+		yp = self->input->height - 1;
+	}
+
 	// plus/minus pixels
 	float pixel_p0[4];
 	float pixel_m0[4];
@@ -96,126 +105,206 @@ texgz_slic_gradient(texgz_slic_t* self, int x, int y)
 	       sqrtf(dyr*dyr + dyg*dyg + dyb*dyb + dya*dya);
 }
 
-static float
-texgz_slic_dist(texgz_slic_t* self,
-                texgz_slicCluster_t* cluster,
-                float* pixel, int x, int y)
+// compute the squared distance D^2 = dc^2 + (m/s)^2*dxy^2
+// for n consecutive pixels in a row against a cluster
+// where the cluster avg is hoisted by the caller and
+// dx,dy is the offset of the first pixel from the center
+// https://www.iro.umontreal.ca/~mignotte/IFT6150/Articles/SLIC_Superpixels.pdf
+static void
+texgz_slic_dist(int n, const float* pixel, const float* avg,
+                float wxy, float dx, float dy, float* d)
 {
-	ASSERT(self);
-	ASSERT(cluster);
 	ASSERT(pixel);
+	ASSERT(avg);
+	ASSERT(d);
 
-	int i = cluster->i;
-	int j = cluster->j;
-	float avg[4];
-	texgz_tex_getPixelF(self->sp_avg, j, i, avg);
-	float dr = pixel[0] - avg[0];
-	float dg = pixel[1] - avg[1];
-	float db = pixel[2] - avg[2];
-	float da = pixel[3] - avg[3];
-	float dp = sqrtf(dr*dr + dg*dg + db*db * da*da);
-	float dx = (float) (x - cluster->x);
-	float dy = (float) (y - cluster->y);
-	float dxy = sqrtf(dx*dx + dy*dy);
-
-	return dp + (self->m/self->s)*dxy;
-}
-
-static void texgz_slic_reset(texgz_slic_t* self)
-{
-	ASSERT(self);
+	float ar  = avg[0];
+	float ag  = avg[1];
+	float ab  = avg[2];
+	float aa  = avg[3];
+	float dy2 = dy*dy;
 
-	// reset cluster indices/centers
-	int i;
-	int j;
-	int s  = self->s;
-	int s2 = s/2;
-	texgz_slicCluster_t* cluster;
-	for(i = 0; i < self->kh; ++i)
+	// a fixed lane count allows the compiler to vectorize
+	int l;
+	if(n == TEXGZ_SLIC_LANES)
 	{
-		for(j = 0; j < self->kw; ++j)
+		for(l = 0; l < TEXGZ_SLIC_LANES; ++l)
 		{
-			cluster = texgz_slic_cluster(self, i, j);
-
-			cluster->i = i;
-			cluster->j = j;
-			cluster->x = s*j + s2;
-			cluster->y = s*i + s2;
+			const float* p = &pixel[4*l];
+
+			float dr = p[0] - ar;
+			float dg = p[1] - ag;
+			float db = p[2] - ab;
+			float da = p[3] - aa;
+			float fx = dx + (float) l;
+			d[l] = dr*dr + dg*dg + db*db + da*da +
+			       wxy*(fx*fx + dy2);
 		}
+		return;
+	}
+
+	for(l = 0; l < n; ++l)
+	{
+		const float* p = &pixel[4*l];
+
+		float dr = p[0] - ar;
+		float dg = p[1] - ag;
+		float db = p[2] - ab;
+		float da = p[3] - aa;
+		float fx = dx + (float) l;
+		d[l] = dr*dr + dg*dg + db*db + da*da +
+		       wxy*(fx*fx + dy2);
 	}
+}
+
+// seed the cluster row i on the grid where the centers
+// are perterbed to the lowest gradient position
+static void
+texgz_slic_seed(texgz_slic_t* self, texgz_sat_t* sat, int i)
+{
+	ASSERT(self);
+	ASSERT(sat);
 
+	int   j;
+	int   k;
 	int   x;
 	int   y;
+	int   s     = self->s;
+	int   s2    = s/2;
 	int   cx    = 0;
 	int   cy    = 0;
 	float gbest = 0.0f;
 	float g;
 	float avg[4];
-	float pixel[4];
-	for(i = 0; i < self->kh; ++i)
+	float stddev[4];
+	for(j = 0; j < self->kw; ++j)
 	{
-		for(j = 0; j < self->kw; ++j)
+		k = i*self->kw + j;
+
+		// perterb cluster centers in a neighborhood
+		// to the lowest gradient position
+		int x0 = s*j + s2 - self->n/2;
+		int y0 = s*i + s2 - self->n/2;
+		int x1 = x0 + self->n;
+		int y1 = y0 + self->n;
+		for(y = y0; y < y1; ++y)
 		{
-			cluster = texgz_slic_cluster(self, i, j);
-
-			// perterb cluster centers in a neighborhood
-			// to the lowest gradient position
-			int x0 = cluster->x - self->n/2;
-			int y0 = cluster->y - self->n/2;
-			int x1 = x0 + self->n;
-			int y1 = y0 + self->n;
-			for(y = y0; y < y1; ++y)
+			for(x = x0; x < x1; ++x)
 			{
-				for(x = x0; x < x1; ++x)
+				g = texgz_slic_gradient(self, x, y);
+				if(((x == x0) && (y == y0)) || (g < gbest))
 				{
-					g = texgz_slic_gradient(self, x, y);
-					if(((x == x0) && (y == y0)) || (g < gbest))
-					{
-						cx    = x;
-						cy    = y;
-						gbest = g;
-					}
+					cx    = x;
+					cy    = y;
+					gbest = g;
 				}
 			}
+		}
 
-			// compute average cluster pixel
-			x0     = j*s;
-			y0     = i*s;
-			x1     = x0 + s;
-			y1     = y0 + s;
-			avg[0] = 0;
-			avg[1] = 0;
-			avg[2] = 0;
-			avg[3] = 0;
-			for(y = y0; y < y1; ++y)
-			{
-				for(x = x0; x < x1; ++x)
-				{
-					texgz_tex_getPixelF(self->input, x, y, pixel);
-					avg[0] += pixel[0];
-					avg[1] += pixel[1];
-					avg[2] += pixel[2];
-					avg[3] += pixel[3];
-				}
-			}
-			int S = s*s;
-			avg[0] /= S;
-			avg[1] /= S;
-			avg[2] /= S;
-			avg[3] /= S;
+		// compute average/stddev cluster pixel
+		texgz_sat_stddev(sat, j*s, i*s, s, s, avg, stddev);
+
+		// update cluster
+		self->cx[k] = cx;
+		self->cy[k] = cy;
+
+		texgz_tex_setPixelF(self->sp_avg, j, i, avg);
+		texgz_tex_setPixelF(self->sp_stddev, j, i, stddev);
+	}
+}
+
+static int texgz_slic_reset(texgz_slic_t* self)
+{
+	ASSERT(self);
+
+	// the sat computes the cluster avg/stddev in O(1)
+	texgz_sat_t* sat = texgz_sat_new(self->input);
+	if(sat == NULL)
+	{
+		return 0;
+	}
+
+	int i;
+	for(i = 0; i < self->kh; ++i)
+	{
+		texgz_slic_seed(self, sat, i);
+	}
+
+	texgz_sat_delete(&sat);
+
+	// labels are unassigned until the first step
+	texgz_tex_t* input = self->input;
+	for(i = 0; i < input->stride*input->height; ++i)
+	{
+		self->labels[i] = -1;
+	}
+
+	return 1;
+}
+
+// slide the clusters up by one cluster row after the input
+// has been shifted up by s rows so the solved clusters are
+// kept as the initial state and only the last row is seeded
+static int texgz_slic_slide(texgz_slic_t* self)
+{
+	ASSERT(self);
 
-			// update cluster
-			cluster->x = cx;
-			cluster->y = cy;
+	texgz_tex_t* input = self->input;
+
+	int s  = self->s;
+	int kw = self->kw;
+	int K  = kw*self->kh;
+
+	// the sat computes the cluster avg/stddev in O(1)
+	texgz_sat_t* sat = texgz_sat_new(input);
+	if(sat == NULL)
+	{
+		return 0;
+	}
 
-			texgz_tex_setPixelF(self->sp_avg, j, i, avg);
+	int    k;
+	float* avg    = (float*) self->sp_avg->pixels;
+	float* stddev = (float*) self->sp_stddev->pixels;
+	memmove(self->cx, &self->cx[kw], (K - kw)*sizeof(int));
+	memmove(self->cy, &self->cy[kw], (K - kw)*sizeof(int));
+	memmove(avg, &avg[4*kw], 4*(K - kw)*sizeof(float));
+	memmove(stddev, &stddev[4*kw], 4*(K - kw)*sizeof(float));
+	for(k = 0; k < K - kw; ++k)
+	{
+		// recentered clusters may have moved into the
+		// rows which were removed
+		self->cy[k] -= s;
+		if(self->cy[k] < 0)
+		{
+			self->cy[k] = 0;
 		}
 	}
+	texgz_slic_seed(self, sat, self->kh - 1);
+
+	texgz_sat_delete(&sat);
+
+	// samples assigned to the removed cluster row and the
+	// samples in the new rows are unassigned
+	int      i;
+	int      n      = (input->height - s)*input->stride;
+	int32_t* labels = self->labels;
+	memmove(labels, &labels[s*input->stride],
+	        n*sizeof(int32_t));
+	for(i = 0; i < n; ++i)
+	{
+		labels[i] = (labels[i] < kw) ? -1 : labels[i] - kw;
+	}
+	for(i = n; i < input->stride*input->height; ++i)
+	{
+		labels[i] = -1;
+	}
+
+	return 1;
 }
 
 static int
-texgz_slic_outlier(texgz_slic_t* self, float* pixel,
-                   float* avg, float* stddev)
+texgz_slic_outlier(texgz_slic_t* self, const float* pixel,
+                   const float* avg, const float* stddev)
 {
 	ASSERT(self);
 	ASSERT(pixel);
@@ -233,13 +322,577 @@ texgz_slic_outlier(texgz_slic_t* self, float* pixel,
 	return 1;
 }
 
+static void
+texgz_slic_assignRows(void* priv, int tid, int y0, int y1)
+{
+	ASSERT(priv);
+
+	texgz_slicTask_t* task  = (texgz_slicTask_t*) priv;
+	texgz_slic_t*     self  = task->self;
+	texgz_tex_t*      input = self->input;
+
+	int      s      = self->s;
+	int      w      = input->width;
+	int      stride = input->stride;
+	float*   pixels = (float*) input->pixels;
+	float*   avg    = (float*) self->sp_avg->pixels;
+	float*   dist   = &self->dist[tid*s*w];
+	int32_t* prev   = &self->prev[tid*s*w];
+
+	// the distances are compared squared so the
+	// compactness weight is also squared
+	float wxy = (self->m/s)*(self->m/s);
+
+	// each thread owns a band of rows which is processed
+	// in chunks of s rows and visits the clusters in the
+	// same order as a serial assignment so that ties
+	// resolve identically and labels are never shared
+	// between threads
+	int   c0;
+	int   i;
+	int   j;
+	int   k;
+	int   l;
+	int   n;
+	int   x;
+	int   y;
+	float d[TEXGZ_SLIC_LANES];
+	int   changed = 0;
+	for(c0 = y0; c0 < y1; c0 += s)
+	{
+		int c1 = c0 + s;
+		if(c1 > y1)
+		{
+			c1 = y1;
+		}
+
+		// save and reset labels
+		for(y = c0; y < c1; ++y)
+		{
+			int32_t* labels = &self->labels[y*stride];
+			memcpy(&prev[(y - c0)*w], labels,
+			       w*sizeof(int32_t));
+			for(x = 0; x < w; ++x)
+			{
+				labels[x] = -1;
+			}
+		}
+
+		for(i = 0; i < self->kh; ++i)
+		{
+			// skip cluster rows which cannot reach the chunk
+			if((self->cy_max[i] + s < c0) ||
+			   (self->cy_min[i] - s >= c1))
+			{
+				continue;
+			}
+
+			for(j = 0; j < self->kw; ++j)
+			{
+				k = i*self->kw + j;
+
+				// compute/clamp cluster neighborhood
+				int cx0 = self->cx[k] - s;
+				int cy0 = self->cy[k] - s;
+				int cx1 = cx0 + 2*s;
+				int cy1 = cy0 + 2*s;
+				if(cx0 < 0)
+				{
+					cx0 = 0;
+				}
+				if(cy0 < 0)
+				{
+					cy0 = 0;
+				}
+				if(cx1 >= w)
+				{
+					cx1 = w - 1;
+				}
+				if(cy1 >= input->height)
+				{
+					cy1 = input->height - 1;
+				}
+
+				// clip the neighborhood to the chunk
+				if(cy0 < c0)
+				{
+					cy0 = c0;
+				}
+				if(cy1 >= c1)
+				{
+					cy1 = c1 - 1;
+				}
+
+				// assign samples in cluster neighborhood to
+				// cluster with lowest distance
+				for(y = cy0; y <= cy1; ++y)
+				{
+					int32_t* labels = &self->labels[y*stride];
+					float*   drow   = &dist[(y - c0)*w];
+					float*   prow   = &pixels[4*y*stride];
+					for(x = cx0; x <= cx1; x += TEXGZ_SLIC_LANES)
+					{
+						n = cx1 - x + 1;
+						if(n > TEXGZ_SLIC_LANES)
+						{
+							n = TEXGZ_SLIC_LANES;
+						}
+
+						texgz_slic_dist(n, &prow[4*x], &avg[4*k], wxy,
+						                (float) (x - self->cx[k]),
+						                (float) (y - self->cy[k]), d);
+						for(l = 0; l < n; ++l)
+						{
+							if((labels[x + l] < 0) ||
+							   (drow[x + l] > d[l]))
+							{
+								drow[x + l]   = d[l];
+								labels[x + l] = k;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// count the reassigned samples
+		for(y = c0; y < c1; ++y)
+		{
+			int32_t* labels  = &self->labels[y*stride];
+			int32_t* plabels = &prev[(y - c0)*w];
+			for(x = 0; x < w; ++x)
+			{
+				changed += (labels[x] != plabels[x]);
+			}
+		}
+	}
+
+	self->changed[tid] = changed;
+}
+
+// update the online mean/variance of cluster k
+// https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+static void
+texgz_slic_welford(int K, int k, int* count, float* mean,
+                   float* m2, const float* pixel)
+{
+	ASSERT(count);
+	ASSERT(mean);
+	ASSERT(m2);
+	ASSERT(pixel);
+
+	int   c;
+	float rn = 1.0f/((float) (++count[k]));
+	for(c = 0; c < 4; ++c)
+	{
+		float* mu    = &mean[c*K + k];
+		float  delta = pixel[c] - *mu;
+		*mu         += rn*delta;
+		m2[c*K + k] += delta*(pixel[c] - *mu);
+	}
+}
+
+// merge the online mean/variance of cluster kb of set b
+// with Kb clusters into cluster ka of set a with Ka
+// clusters using the parallel variance algorithm
+static void
+texgz_slic_chan(int Ka, int ka, int* count_a, float* mean_a,
+                float* m2_a, int Kb, int kb, const int* count_b,
+                const float* mean_b, const float* m2_b)
+{
+	ASSERT(count_a);
+	ASSERT(mean_a);
+	ASSERT(m2_a);
+	ASSERT(count_b);
+	ASSERT(mean_b);
+	ASSERT(m2_b);
+
+	int nb = count_b[kb];
+	if(nb == 0)
+	{
+		return;
+	}
+
+	int   c;
+	int   na = count_a[ka];
+	float fa = (float) na;
+	float fb = (float) nb;
+	float fn = (float) (na + nb);
+	for(c = 0; c < 4; ++c)
+	{
+		float delta = mean_b[c*Kb + kb] - mean_a[c*Ka + ka];
+		mean_a[c*Ka + ka] += delta*fb/fn;
+		m2_a[c*Ka + ka]   += m2_b[c*Kb + kb] +
+		                     delta*delta*fa*fb/fn;
+	}
+	count_a[ka] = na + nb;
+}
+
+// the chunk set of cluster row r holds the statistics of
+// the samples in rows [r*s, r*s + s) for the clusters in
+// cluster rows r - TEXGZ_SLIC_CHUNK_RADIUS to
+// r + TEXGZ_SLIC_CHUNK_RADIUS where cluster k is stored at
+// k + (TEXGZ_SLIC_CHUNK_RADIUS - r)*kw
+static void
+texgz_slic_chunkStats(texgz_slic_t* self, int r,
+                      texgz_slicStats_t* chunk)
+{
+	ASSERT(self);
+	ASSERT(chunk);
+
+	texgz_slicStats_t* stats = &self->stats;
+
+	size_t K  = self->kw*self->kh;
+	size_t Kc = TEXGZ_SLIC_CHUNK_SIZE*self->kw;
+	size_t o  = K + r*Kc;
+
+	chunk->count         = &stats->count[o];
+	chunk->sum_x         = &stats->sum_x[o];
+	chunk->sum_y         = &stats->sum_y[o];
+	chunk->mean          = &stats->mean[4*o];
+	chunk->m2            = &stats->m2[4*o];
+	chunk->outlier_count = &stats->outlier_count[o];
+	chunk->outlier_mean  = &stats->outlier_mean[4*o];
+	chunk->outlier_m2    = &stats->outlier_m2[4*o];
+}
+
+// accumulate the sample (x, y) of cluster k into cluster
+// kk of a set with K clusters
+static void
+texgz_slic_accumSample(texgz_slic_t* self, int step,
+                       int x, int y, int k,
+                       texgz_slicStats_t* stats, int K, int kk)
+{
+	ASSERT(self);
+	ASSERT(stats);
+
+	texgz_tex_t* input = self->input;
+
+	int    idx    = y*input->stride + x;
+	float* pixel  = &((float*) input->pixels)[4*idx];
+	float* avg    = (float*) self->sp_avg->pixels;
+	float* stddev = (float*) self->sp_stddev->pixels;
+	float* out    = (float*) self->sp_outlier->pixels;
+
+	float red[4]   = { 1.0f, 0.0f, 0.0f, 1.0f };
+	float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	if(step && (self->sdx != 0.0f))
+	{
+		// discard samples which were identified as outliers
+		// in the previous iteration
+		if(texgz_slic_outlier(self, pixel, &avg[4*k],
+		                      &stddev[4*k]))
+		{
+			texgz_slic_welford(K, kk, stats->outlier_count,
+			                   stats->outlier_mean,
+			                   stats->outlier_m2, pixel);
+			memcpy(&out[4*idx], red, sizeof(red));
+			return;
+		}
+		memcpy(&out[4*idx], clear, sizeof(clear));
+	}
+
+	texgz_slic_welford(K, kk, stats->count, stats->mean,
+	                   stats->m2, pixel);
+	stats->sum_x[kk] += x;
+	stats->sum_y[kk] += y;
+}
+
+static void
+texgz_slic_accumRows(void* priv, int tid, int r0, int r1)
+{
+	ASSERT(priv);
+
+	texgz_slicTask_t* task  = (texgz_slicTask_t*) priv;
+	texgz_slic_t*     self  = task->self;
+	texgz_tex_t*      input = self->input;
+
+	// the samples are accumulated into the chunk set of
+	// each cluster row of samples so that the statistics
+	// do not depend on the thread count and samples of
+	// distant clusters (e.g. merged by connect) are
+	// deferred to texgz_slic_accumStats
+	int s  = self->s;
+	int kw = self->kw;
+	int Kc = TEXGZ_SLIC_CHUNK_SIZE*kw;
+
+	int k;
+	int r;
+	int x;
+	int y;
+	texgz_slicStats_t chunk;
+	for(r = r0; r < r1; ++r)
+	{
+		texgz_slic_chunkStats(self, r, &chunk);
+
+		int kk = (TEXGZ_SLIC_CHUNK_RADIUS - r)*kw;
+		for(y = r*s; y < (r + 1)*s; ++y)
+		{
+			for(x = 0; x < input->width; ++x)
+			{
+				k = self->labels[y*input->stride + x];
+				if(k < 0)
+				{
+					continue;
+				}
+
+				if(abs(k/kw - r) > TEXGZ_SLIC_CHUNK_RADIUS)
+				{
+					self->overflow[r] = 1;
+					continue;
+				}
+
+				texgz_slic_accumSample(self, task->step, x, y, k,
+				                       &chunk, Kc, k + kk);
+			}
+		}
+	}
+}
+
+// merge the chunk sets into the cluster statistics in
+// chunk order
+static void
+texgz_slic_mergeRows(void* priv, int tid, int i0, int i1)
+{
+	ASSERT(priv);
+
+	texgz_slicTask_t*  task  = (texgz_slicTask_t*) priv;
+	texgz_slic_t*      self  = task->self;
+	texgz_slicStats_t* stats = &self->stats;
+
+	int kw = self->kw;
+	int K  = kw*self->kh;
+	int Kc = TEXGZ_SLIC_CHUNK_SIZE*kw;
+
+	int i;
+	int j;
+	int k;
+	int r;
+	texgz_slicStats_t chunk;
+	for(i = i0; i < i1; ++i)
+	{
+		for(r = i - TEXGZ_SLIC_CHUNK_RADIUS;
+		    r <= i + TEXGZ_SLIC_CHUNK_RADIUS; ++r)
+		{
+			if((r < 0) || (r >= self->kh))
+			{
+				continue;
+			}
+
+			texgz_slic_chunkStats(self, r, &chunk);
+
+			int kk = (TEXGZ_SLIC_CHUNK_RADIUS - r)*kw;
+			for(j = 0; j < kw; ++j)
+			{
+				k = i*kw + j;
+				stats->sum_x[k] += chunk.sum_x[k + kk];
+				stats->sum_y[k] += chunk.sum_y[k + kk];
+				texgz_slic_chan(K, k, stats->count,
+				                stats->mean, stats->m2,
+				                Kc, k + kk, chunk.count,
+				                chunk.mean, chunk.m2);
+				texgz_slic_chan(K, k, stats->outlier_count,
+				                stats->outlier_mean,
+				                stats->outlier_m2,
+				                Kc, k + kk, chunk.outlier_count,
+				                chunk.outlier_mean,
+				                chunk.outlier_m2);
+			}
+		}
+	}
+}
+
+// compute the cluster statistics of the current labels
+static void
+texgz_slic_accumStats(texgz_slic_t* self, int step)
+{
+	ASSERT(self);
+
+	texgz_tex_t* input = self->input;
+
+	texgz_slicTask_t task =
+	{
+		.self = self,
+		.step = step,
+	};
+
+	// the stats and overflow flags share one allocation
+	size_t K = self->kw*self->kh;
+	size_t n = K + TEXGZ_SLIC_CHUNK_SIZE*K;
+	memset(self->stats.count, 0,
+	       (4*n + self->kh)*sizeof(int) +
+	       16*n*sizeof(float));
+
+	texgz_thread_parallel(self->kh, &task,
+	                      texgz_slic_accumRows);
+	texgz_thread_parallel(self->kh, &task,
+	                      texgz_slic_mergeRows);
+
+	// accumulate the deferred samples in chunk order
+	int k;
+	int r;
+	int x;
+	int y;
+	for(r = 0; r < self->kh; ++r)
+	{
+		if(self->overflow[r] == 0)
+		{
+			continue;
+		}
+
+		for(y = r*self->s; y < (r + 1)*self->s; ++y)
+		{
+			for(x = 0; x < input->width; ++x)
+			{
+				k = self->labels[y*input->stride + x];
+				if((k < 0) ||
+				   (abs(k/self->kw - r) <= TEXGZ_SLIC_CHUNK_RADIUS))
+				{
+					continue;
+				}
+
+				texgz_slic_accumSample(self, step, x, y, k,
+				                       &self->stats, K, k);
+			}
+		}
+	}
+}
+
+static void texgz_slic_updateRange(texgz_slic_t* self)
+{
+	ASSERT(self);
+
+	int i;
+	int j;
+	int k;
+	for(i = 0; i < self->kh; ++i)
+	{
+		k = i*self->kw;
+		self->cy_min[i] = self->cy[k];
+		self->cy_max[i] = self->cy[k];
+		for(j = 1; j < self->kw; ++j)
+		{
+			++k;
+			if(self->cy[k] < self->cy_min[i])
+			{
+				self->cy_min[i] = self->cy[k];
+			}
+			if(self->cy[k] > self->cy_max[i])
+			{
+				self->cy_max[i] = self->cy[k];
+			}
+		}
+	}
+}
+
+// initialize the clusters from the solved coarse level
+static void texgz_slic_upsample(texgz_slic_t* self)
+{
+	ASSERT(self);
+	ASSERT(self->coarse);
+
+	texgz_slic_t* coarse = self->coarse;
+	texgz_tex_t*  input  = self->input;
+
+	// coarse pixel x covers [x*scale, (x + 1)*scale)
+	int k;
+	int K     = self->kw*self->kh;
+	int scale = 1 << self->levels;
+	for(k = 0; k < K; ++k)
+	{
+		int cx = coarse->cx[k]*scale + scale/2;
+		int cy = coarse->cy[k]*scale + scale/2;
+		if(cx >= input->width)
+		{
+			cx = input->width - 1;
+		}
+		if(cy >= input->height)
+		{
+			cy = input->height - 1;
+		}
+		self->cx[k] = cx;
+		self->cy[k] = cy;
+	}
+
+	// the cluster grids match so the avg/stddev are copied
+	memcpy(self->sp_avg->pixels, coarse->sp_avg->pixels,
+	       4*K*sizeof(float));
+	memcpy(self->sp_stddev->pixels, coarse->sp_stddev->pixels,
+	       4*K*sizeof(float));
+}
+
+// find the root of p with path halving where the root
+// stores the negative component size
+static int32_t texgz_slic_find(int32_t* parent, int32_t p)
+{
+	ASSERT(parent);
+
+	while(parent[p] >= 0)
+	{
+		int32_t q = parent[p];
+		if(parent[q] >= 0)
+		{
+			parent[p] = parent[q];
+		}
+		p = q;
+	}
+	return p;
+}
+
+static void
+texgz_slic_union(int32_t* parent, int32_t p, int32_t q)
+{
+	ASSERT(parent);
+
+	p = texgz_slic_find(parent, p);
+	q = texgz_slic_find(parent, q);
+	if(p == q)
+	{
+		return;
+	}
+
+	// union by size
+	if(parent[p] > parent[q])
+	{
+		int32_t t = p;
+		p = q;
+		q = t;
+	}
+	parent[p] += parent[q];
+	parent[q]  = p;
+}
+
+// resolve the target label of fragment roots from an
+// adjacent resolved component
+static int
+texgz_slic_resolve(int32_t* parent, int32_t* target,
+                   int32_t p, int32_t q)
+{
+	ASSERT(parent);
+	ASSERT(target);
+
+	p = texgz_slic_find(parent, p);
+	q = texgz_slic_find(parent, q);
+	if((target[p] < 0) && (target[q] >= 0))
+	{
+		target[p] = target[q];
+		return 1;
+	}
+	else if((target[q] < 0) && (target[p] >= 0))
+	{
+		target[q] = target[p];
+		return 1;
+	}
+	return 0;
+}
+
 /***********************************************************
 * public                                                   *
 ***********************************************************/
 
 texgz_slic_t*
 texgz_slic_new(texgz_tex_t* input, int s, float m,
-               float sdx, int n, int recenter)
+               float sdx, int n, int recenter, int levels)
 {
 	ASSERT(input);
 
@@ -279,29 +932,98 @@ texgz_slic_new(texgz_tex_t* input, int s, float m,
 		goto fail_slic_attr;
 	}
 
+	// the coarse superpixel size must be a whole number
+	// of pixels and at least 2x2
+	int scale = 1;
+	if((levels >= 0) && (levels <= 8))
+	{
+		scale = 1 << levels;
+	}
+	if((levels < 0) || (levels > 8) ||
+	   ((s%scale) != 0) || (s/scale < 2))
+	{
+		LOGE("invalid s=%i, levels=%i", s, levels);
+		goto fail_slic_attr;
+	}
+
+	// the coarse gradient neighborhood must be odd and
+	// smaller than the coarse superpixel size which
+	// clamps it to the largest odd size below s/scale
+	int cs = s/scale;
+	int cn = (n/scale) | 1;
+	if(cn >= cs)
+	{
+		cn = (cs - 2) | 1;
+	}
+
 	self->s   = s;
 	self->m   = m;
 	self->sdx = sdx;
 	self->n   = n;
 	self->kw  = input->width/s;
 	self->kh  = input->height/s;
+	self->nth = texgz_thread_count();
 	self->recenter = recenter;
 	self->input    = input;
 
-	self->clusters = (texgz_slicCluster_t*)
-	                 CALLOC(self->kw*self->kh,
-	                        sizeof(texgz_slicCluster_t));
-	if(self->clusters == NULL)
+	int K = self->kw*self->kh;
+
+	// the centers and ranges share one allocation
+	self->cx = (int*) CALLOC(2*K + 2*self->kh, sizeof(int));
+	if(self->cx == NULL)
+	{
+		goto fail_centers;
+	}
+	self->cy     = &self->cx[K];
+	self->cy_min = &self->cy[K];
+	self->cy_max = &self->cy_min[self->kh];
+
+	self->labels = (int32_t*)
+	               MALLOC(input->stride*input->height*
+	                      sizeof(int32_t));
+	if(self->labels == NULL)
+	{
+		goto fail_labels;
+	}
+
+	// the stats share one allocation with the chunk sets
+	// and the overflow flags
+	size_t nK = K + TEXGZ_SLIC_CHUNK_SIZE*K;
+	texgz_slicStats_t* stats = &self->stats;
+	stats->count = (int*)
+	               CALLOC((4*nK + self->kh)*sizeof(int) +
+	                      16*nK*sizeof(float), 1);
+	if(stats->count == NULL)
 	{
-		goto fail_clusters;
+		goto fail_stats;
+	}
+	stats->sum_x         = &stats->count[nK];
+	stats->sum_y         = &stats->sum_x[nK];
+	stats->outlier_count = &stats->sum_y[nK];
+	self->overflow       = &stats->outlier_count[nK];
+	stats->mean          = (float*) &self->overflow[self->kh];
+	stats->m2            = &stats->mean[4*nK];
+	stats->outlier_mean  = &stats->m2[4*nK];
+	stats->outlier_m2    = &stats->outlier_mean[4*nK];
+
+	self->dist = (float*)
+	             MALLOC(self->nth*s*input->width*sizeof(float));
+	if(self->dist == NULL)
+	{
+		goto fail_dist;
+	}
+
+	self->prev = (int32_t*)
+	             MALLOC(self->nth*s*input->width*sizeof(int32_t));
+	if(self->prev == NULL)
+	{
+		goto fail_prev;
 	}
 
-	self->samples = (texgz_slicSample_t*)
-	               CALLOC(input->width*input->height,
-	                      sizeof(texgz_slicSample_t));
-	if(self->samples == NULL)
+	self->changed = (int*) CALLOC(self->nth, sizeof(int));
+	if(self->changed == NULL)
 	{
-		goto fail_samples;
+		goto fail_changed;
 	}
 
 	self->sp_avg = texgz_tex_new(self->kw, self->kh,
@@ -331,21 +1053,57 @@ texgz_slic_new(texgz_tex_t* input, int s, float m,
 		goto fail_sp_outlier;
 	}
 
-	texgz_slic_reset(self);
+	if(texgz_slic_reset(self) == 0)
+	{
+		goto fail_reset;
+	}
+
+	// the coarse level solves the clusters on a downscaled
+	// input and the compactness is invariant to scale
+	if(levels)
+	{
+		self->levels = levels;
+		self->coarse_input = texgz_tex_lanczos3(input, levels);
+		if(self->coarse_input == NULL)
+		{
+			goto fail_coarse_input;
+		}
+
+		self->coarse = texgz_slic_new(self->coarse_input,
+		                              cs, m, sdx, cn,
+		                              recenter, 0);
+		if(self->coarse == NULL)
+		{
+			goto fail_coarse;
+		}
+	}
 
 	// success
 	return self;
 
 	// failure
+	fail_coarse:
+		texgz_tex_delete(&self->coarse_input);
+	fail_coarse_input:
+	fail_reset:
+		texgz_tex_delete(&self->sp_outlier);
 	fail_sp_outlier:
 		texgz_tex_delete(&self->sp_stddev);
 	fail_sp_stddev:
 		texgz_tex_delete(&self->sp_avg);
 	fail_sp_avg:
-		FREE(self->samples);
-	fail_samples:
-		FREE(self->clusters);
-	fail_clusters:
+		FREE(self->changed);
+	fail_changed:
+		FREE(self->prev);
+	fail_prev:
+		FREE(self->dist);
+	fail_dist:
+		FREE(self->stats.count);
+	fail_stats:
+		FREE(self->labels);
+	fail_labels:
+		FREE(self->cx);
+	fail_centers:
 	fail_slic_attr:
 	fail_input_attr:
 		FREE(self);
@@ -359,11 +1117,17 @@ void texgz_slic_delete(texgz_slic_t** _self)
 	texgz_slic_t* self = *_self;
 	if(self)
 	{
+		texgz_slic_delete(&self->coarse);
+		texgz_tex_delete(&self->coarse_input);
 		texgz_tex_delete(&self->sp_outlier);
 		texgz_tex_delete(&self->sp_stddev);
 		texgz_tex_delete(&self->sp_avg);
-		FREE(self->samples);
-		FREE(self->clusters);
+		FREE(self->changed);
+		FREE(self->prev);
+		FREE(self->dist);
+		FREE(self->stats.count);
+		FREE(self->labels);
+		FREE(self->cx);
 		FREE(self);
 		*_self = NULL;
 	}
@@ -375,265 +1139,594 @@ float texgz_slic_step(texgz_slic_t* self, int step)
 
 	texgz_tex_t* input = self->input;
 
-	// reset clusters and samples
-	int i;
-	int j;
-	texgz_slicCluster_t* cluster;
-	if(step)
+	texgz_slicTask_t task =
 	{
-		for(i = 0; i < self->kh; ++i)
+		.self = self,
+		.step = step,
+	};
+
+	// assign samples to clusters
+	texgz_slic_updateRange(self);
+	memset(self->changed, 0, self->nth*sizeof(int));
+	texgz_thread_parallel(input->height, &task,
+	                      texgz_slic_assignRows);
+
+	// compute the center, avg and stddev
+	texgz_slic_accumStats(self, step);
+
+	// stddev = sqrt((1/N)*SUM((x-mu)^2))
+	// https://en.wikipedia.org/wiki/Standard_deviation
+	// where N is the inlier count, mu is the inlier mean and
+	// the sum includes the outliers
+	texgz_slicStats_t* stats = &self->stats;
+
+	int    c;
+	int    k;
+	int    K      = self->kw*self->kh;
+	int    moved  = 0;
+	float* avg    = (float*) self->sp_avg->pixels;
+	float* stddev = (float*) self->sp_stddev->pixels;
+	for(k = 0; k < K; ++k)
+	{
+		int count = stats->count[k];
+		if(count == 0)
 		{
-			for(j = 0; j < self->kw; ++j)
-			{
-				cluster = texgz_slic_cluster(self, i, j);
-
-				cluster->count            = 0;
-				cluster->sum_x            = 0;
-				cluster->sum_y            = 0;
-				cluster->sum_pixel1[0]    = 0.0f;
-				cluster->sum_pixel1[1]    = 0.0f;
-				cluster->sum_pixel1[2]    = 0.0f;
-				cluster->sum_pixel1[3]    = 0.0f;
-				cluster->sum_pixel2[0]    = 0.0f;
-				cluster->sum_pixel2[1]    = 0.0f;
-				cluster->sum_pixel2[2]    = 0.0f;
-				cluster->sum_pixel2[3]    = 0.0f;
-			}
+			continue;
+		}
+
+		// optionally recenter cluster centers
+		if(self->recenter)
+		{
+			int cx = stats->sum_x[k]/count;
+			int cy = stats->sum_y[k]/count;
+			moved += abs(cx - self->cx[k]) + abs(cy - self->cy[k]);
+			self->cx[k] = cx;
+			self->cy[k] = cy;
 		}
 
-		size_t size = MEMSIZEPTR(self->samples);
-		memset(self->samples, 0, size);
+		float fo = (float) stats->outlier_count[k];
+		for(c = 0; c < 4; ++c)
+		{
+			float mu = stats->mean[c*K + k];
+			float dm = stats->outlier_mean[c*K + k] - mu;
+			float m2 = stats->m2[c*K + k] +
+			           stats->outlier_m2[c*K + k] + fo*dm*dm;
+			avg[4*k + c]    = mu;
+			stddev[4*k + c] = sqrtf(m2/count);
+		}
 	}
 
-	// assign samples to clusters
-	int x;
-	int y;
-	texgz_slicSample_t* sample;
-	float               pixel[4];
-	for(i = 0; i < self->kh; ++i)
+	// compute residual error as the fraction of samples
+	// which were reassigned plus the average L1 distance
+	// that the cluster centers moved relative to s
+	int t;
+	int changed = 0;
+	for(t = 0; t < self->nth; ++t)
+	{
+		changed += self->changed[t];
+	}
+
+	return ((float) changed)/(input->width*input->height) +
+	       ((float) moved)/(K*self->s);
+}
+
+int texgz_slic_solve(texgz_slic_t* self, int max_steps,
+                     float epsilon)
+{
+	ASSERT(self);
+
+	// solve the coarse level and finish with a small number
+	// of refinement steps at full resolution
+	int count = 0;
+	if(self->coarse)
+	{
+		count = texgz_slic_solve(self->coarse, max_steps,
+		                         epsilon);
+		texgz_slic_upsample(self);
+		if(max_steps > TEXGZ_SLIC_REFINE_STEPS)
+		{
+			max_steps = TEXGZ_SLIC_REFINE_STEPS;
+		}
+	}
+
+	// iterate until the residual error converges
+	int step = 0;
+	while(step < max_steps)
+	{
+		float e = texgz_slic_step(self, step++);
+		if(e <= epsilon)
+		{
+			break;
+		}
+	}
+
+	return count + step;
+}
+
+float texgz_slic_error(texgz_slic_t* self)
+{
+	ASSERT(self);
+
+	texgz_tex_t* input  = self->input;
+	float*       pixels = (float*) input->pixels;
+	float*       avg    = (float*) self->sp_avg->pixels;
+
+	// compute the RMS error of the superpixel reconstruction
+	int    c;
+	int    k;
+	int    x;
+	int    y;
+	int    idx;
+	int    count = 0;
+	double sum   = 0.0;
+	for(y = 0; y < input->height; ++y)
 	{
-		for(j = 0; j < self->kw; ++j)
+		for(x = 0; x < input->width; ++x)
 		{
-			cluster = texgz_slic_cluster(self, i, j);
+			idx = y*input->stride + x;
+			k   = self->labels[idx];
+			if(k < 0)
+			{
+				continue;
+			}
 
-			// compute/clamp cluster neighborhood
-			int x0 = cluster->x - self->s;
-			int y0 = cluster->y - self->s;
-			int x1 = x0 + 2*self->s;
-			int y1 = y0 + 2*self->s;
-			if(x0 < 0)
+			for(c = 0; c < 4; ++c)
 			{
-				x0 = 0;
+				float d = pixels[4*idx + c] - avg[4*k + c];
+				sum += d*d;
 			}
-			if(y0 < 0)
+			++count;
+		}
+	}
+
+	if(count == 0)
+	{
+		return 0.0f;
+	}
+
+	return (float) sqrt(sum/count);
+}
+
+texgz_tex_t* texgz_slic_output(texgz_slic_t* self,
+                               texgz_tex_t* sp)
+{
+	ASSERT(self);
+	ASSERT(sp);
+
+	texgz_tex_t* input = self->input;
+
+	texgz_tex_t* out;
+	out = texgz_tex_new(input->width, input->height,
+	                    input->width, input->height,
+	                    input->type, input->format,
+	                    NULL);
+	if(out == NULL)
+	{
+	        return NULL;
+	}
+
+	// copy pixels
+	int   k;
+	int   x;
+	int   y;
+	float pixel[4];
+	for(y = 0; y < out->height; ++y)
+	{
+		for(x = 0; x < out->width; ++x)
+		{
+			k = self->labels[y*input->stride + x];
+			if(k >= 0)
 			{
-				y0 = 0;
+				texgz_tex_getPixelF(sp, k%self->kw,
+				                    k/self->kw, pixel);
+				texgz_tex_setPixelF(out, x, y, pixel);
 			}
-			if(x1 >= input->width)
+		}
+	}
+
+	return out;
+}
+
+int texgz_slic_connect(texgz_slic_t* self, int min_size)
+{
+	ASSERT(self);
+
+	texgz_tex_t* input = self->input;
+
+	int      w = input->width;
+	int      h = input->height;
+	int      K = self->kw*self->kh;
+	int32_t* labels = self->labels;
+
+	// parent stores the union-find forest and target stores
+	// the final label of each component root
+	int32_t* parent;
+	parent = (int32_t*) MALLOC(2*w*h*sizeof(int32_t));
+	if(parent == NULL)
+	{
+		LOGE("MALLOC failed");
+		return 0;
+	}
+	int32_t* target = &parent[w*h];
+
+	int32_t* best;
+	best = (int32_t*) MALLOC(2*K*sizeof(int32_t));
+	if(best == NULL)
+	{
+		LOGE("MALLOC failed");
+		goto fail_best;
+	}
+	int32_t* best_size = &best[K];
+
+	// label connected components with 4-connectivity
+	int p;
+	int x;
+	int y;
+	int k;
+	for(p = 0; p < w*h; ++p)
+	{
+		parent[p] = -1;
+	}
+	for(y = 0; y < h; ++y)
+	{
+		for(x = 0; x < w; ++x)
+		{
+			p = y*w + x;
+			k = labels[y*input->stride + x];
+			if((x > 0) && (labels[y*input->stride + x - 1] == k))
 			{
-				x1 = input->width - 1;
+				texgz_slic_union(parent, p, p - 1);
 			}
-			if(y1 >= input->height)
+			if((y > 0) && (labels[(y - 1)*input->stride + x] == k))
 			{
-				y1 = input->height - 1;
+				texgz_slic_union(parent, p, p - w);
 			}
+		}
+	}
 
-			// assign samples in cluster neighborhood to
-			// cluster with lowest distance
-			float dist;
-			for(y = y0; y <= y1; ++y)
+	// find the largest component of each cluster
+	for(k = 0; k < K; ++k)
+	{
+		best[k]      = -1;
+		best_size[k] = 0;
+	}
+	for(y = 0; y < h; ++y)
+	{
+		for(x = 0; x < w; ++x)
+		{
+			p = y*w + x;
+			k = labels[y*input->stride + x];
+			if((parent[p] < 0) && (k >= 0) &&
+			   (-parent[p] > best_size[k]))
 			{
-				for(x = x0; x <= x1; ++x)
-				{
-					texgz_tex_getPixelF(input, x, y, pixel);
-					dist   = texgz_slic_dist(self, cluster, pixel, x, y);
-					sample = texgz_slic_sample(self, x, y);
-					if((sample->cluster == NULL) ||
-					   (sample->dist > dist))
-					{
-						sample->dist    = dist;
-						sample->cluster = cluster;
-					}
-				}
+				best[k]      = p;
+				best_size[k] = -parent[p];
 			}
 		}
 	}
 
-	// compute center and pixel sums
-	float avg[4];
-	float stddev[4];
-	float red[4]   = { 1.0f, 0.0f, 0.0f, 1.0f };
-	float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-	for(y = 0; y < input->height; ++y)
+	// keep the largest component of each cluster unless it
+	// is smaller than min_size and mark all other
+	// components as fragments
+	int kept = 0;
+	for(y = 0; y < h; ++y)
 	{
-		for(x = 0; x < input->width; ++x)
+		for(x = 0; x < w; ++x)
 		{
-			sample  = texgz_slic_sample(self, x, y);
-			cluster = sample->cluster;
-			if(cluster == NULL)
+			p = y*w + x;
+			k = labels[y*input->stride + x];
+			if(parent[p] >= 0)
 			{
 				continue;
 			}
 
-			texgz_tex_getPixelF(input, x, y, pixel);
-
-			if((step == 0) || (self->sdx == 0.0f))
+			target[p] = -1;
+			if((k >= 0) && (best[k] == p) &&
+			   (best_size[k] >= min_size))
 			{
-				++cluster->count;
-				cluster->sum_x         += x;
-				cluster->sum_y         += y;
-				cluster->sum_pixel1[0] += pixel[0];
-				cluster->sum_pixel1[1] += pixel[1];
-				cluster->sum_pixel1[2] += pixel[2];
-				cluster->sum_pixel1[3] += pixel[3];
+				target[p] = k;
+				++kept;
 			}
-			else
+		}
+	}
+
+	// merge fragments into an adjacent component where
+	// fragments which only touch other fragments are
+	// resolved by a subsequent sweep
+	int changed = kept;
+	while(changed)
+	{
+		changed = 0;
+		for(y = 0; y < h; ++y)
+		{
+			for(x = 0; x < w; ++x)
 			{
-				i = cluster->i;
-				j = cluster->j;
-				texgz_tex_getPixelF(self->sp_avg, j, i, avg);
-				texgz_tex_getPixelF(self->sp_stddev, j, i, stddev);
-
-				// discard samples which were identified as outliers
-				// in the previous iteration
-				if(texgz_slic_outlier(self, pixel, avg, stddev))
+				p = y*w + x;
+				if(x > 0)
 				{
-					texgz_tex_setPixelF(self->sp_outlier, x, y, red);
+					changed += texgz_slic_resolve(parent, target,
+					                              p, p - 1);
 				}
-				else
+				if(y > 0)
 				{
-					++cluster->count;
-					cluster->sum_x         += x;
-					cluster->sum_y         += y;
-					cluster->sum_pixel1[0] += pixel[0];
-					cluster->sum_pixel1[1] += pixel[1];
-					cluster->sum_pixel1[2] += pixel[2];
-					cluster->sum_pixel1[3] += pixel[3];
-					texgz_tex_setPixelF(self->sp_outlier, x, y, clear);
+					changed += texgz_slic_resolve(parent, target,
+					                              p, p - w);
 				}
 			}
 		}
 	}
 
-	// compute avg
-	for(i = 0; i < self->kh; ++i)
+	// relabel samples
+	int32_t r;
+	for(y = 0; y < h; ++y)
 	{
-		for(j = 0; j < self->kw; ++j)
+		for(x = 0; x < w; ++x)
 		{
-			cluster = texgz_slic_cluster(self, i, j);
-
-			if(cluster->count)
+			p = y*w + x;
+			r = texgz_slic_find(parent, p);
+			if(target[r] >= 0)
 			{
-				// optionally recenter cluster centers
-				if(self->recenter)
-				{
-					cluster->x = cluster->sum_x/cluster->count;
-					cluster->y = cluster->sum_y/cluster->count;
-				}
-
-				pixel[0] = cluster->sum_pixel1[0]/cluster->count;
-				pixel[1] = cluster->sum_pixel1[1]/cluster->count;
-				pixel[2] = cluster->sum_pixel1[2]/cluster->count;
-				pixel[3] = cluster->sum_pixel1[3]/cluster->count;
-				texgz_tex_setPixelF(self->sp_avg, j, i, pixel);
+				labels[y*input->stride + x] = target[r];
 			}
 		}
 	}
 
-	// compute stddev sums
-	float dp[4];
+	FREE(best);
+	FREE(parent);
+
+	// success
+	return 1;
+
+	// failure
+	fail_best:
+		FREE(parent);
+	return 0;
+}
+
+texgz_tex_t* texgz_slic_labels(texgz_slic_t* self)
+{
+	ASSERT(self);
+
+	texgz_tex_t* input = self->input;
+
+	// unassigned samples are stored as the max value
+	int K    = self->kw*self->kh;
+	int type = TEXGZ_UNSIGNED_INT;
+	if(K < 0xFFFF)
+	{
+		type = TEXGZ_UNSIGNED_SHORT;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(input->width, input->height,
+	                    input->width, input->height,
+	                    type, TEXGZ_LUMINANCE, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	int      x;
+	int      y;
+	int32_t* labels;
 	for(y = 0; y < input->height; ++y)
 	{
-		for(x = 0; x < input->width; ++x)
+		labels = &self->labels[y*input->stride];
+		if(type == TEXGZ_UNSIGNED_SHORT)
 		{
-			sample  = texgz_slic_sample(self, x, y);
-			cluster = sample->cluster;
-			if(cluster == NULL)
+			uint16_t* dst = (uint16_t*) tex->pixels;
+			dst = &dst[y*tex->stride];
+			for(x = 0; x < input->width; ++x)
 			{
-				continue;
+				dst[x] = (uint16_t) labels[x];
+			}
+		}
+		else
+		{
+			uint32_t* dst = (uint32_t*) tex->pixels;
+			dst = &dst[y*tex->stride];
+			for(x = 0; x < input->width; ++x)
+			{
+				dst[x] = (uint32_t) labels[x];
 			}
+		}
+	}
 
-			texgz_tex_getPixelF(input, x, y, pixel);
+	return tex;
+}
 
-			i = cluster->i;
-			j = cluster->j;
-			texgz_tex_getPixelF(self->sp_avg, j, i, avg);
+void texgz_slic_features(texgz_slic_t* self,
+                         texgz_slicFeature_t* features)
+{
+	ASSERT(self);
+	ASSERT(features);
 
-			dp[0] = pixel[0] - avg[0];
-			dp[1] = pixel[1] - avg[1];
-			dp[2] = pixel[2] - avg[2];
-			dp[3] = pixel[3] - avg[3];
+	// accumulate all samples of the current labels
+	texgz_slic_accumStats(self, 0);
 
-			cluster->sum_pixel2[0] += dp[0]*dp[0];
-			cluster->sum_pixel2[1] += dp[1]*dp[1];
-			cluster->sum_pixel2[2] += dp[2]*dp[2];
-			cluster->sum_pixel2[3] += dp[3]*dp[3];
-		}
-	}
+	texgz_slicStats_t* stats = &self->stats;
 
-	// compute stddev
-	// stddev = sqrt((1/N)*SUM((x-mu)^2))
-	// https://en.wikipedia.org/wiki/Standard_deviation
-	for(i = 0; i < self->kh; ++i)
+	int c;
+	int k;
+	int K = self->kw*self->kh;
+	memset(features, 0, K*sizeof(texgz_slicFeature_t));
+	for(k = 0; k < K; ++k)
 	{
-		for(j = 0; j < self->kw; ++j)
+		texgz_slicFeature_t* f = &features[k];
+
+		int count = stats->count[k];
+		if(count == 0)
 		{
-			cluster = texgz_slic_cluster(self, i, j);
+			continue;
+		}
 
-			if(cluster->count)
-			{
-				pixel[0] = sqrtf(cluster->sum_pixel2[0]/cluster->count);
-				pixel[1] = sqrtf(cluster->sum_pixel2[1]/cluster->count);
-				pixel[2] = sqrtf(cluster->sum_pixel2[2]/cluster->count);
-				pixel[3] = sqrtf(cluster->sum_pixel2[3]/cluster->count);
-				texgz_tex_setPixelF(self->sp_stddev, j, i, pixel);
-			}
+		f->count = count;
+		f->cx    = ((float) stats->sum_x[k])/count;
+		f->cy    = ((float) stats->sum_y[k])/count;
+		for(c = 0; c < 4; ++c)
+		{
+			f->avg[c]    = stats->mean[c*K + k];
+			f->stddev[c] = sqrtf(stats->m2[c*K + k]/count);
 		}
 	}
-
-	// TODO - compute residual error
-
-	return 0.0f;
 }
 
-texgz_tex_t* texgz_slic_output(texgz_slic_t* self,
-                               texgz_tex_t* sp)
+int texgz_slic_stream(int width, int height,
+                      int s, float m, float sdx,
+                      int n, int recenter,
+                      int max_steps, float epsilon,
+                      texgz_slicStream_readFn read_fn,
+                      void* priv, FILE* flabels,
+                      FILE* fstats)
 {
-	ASSERT(self);
-	ASSERT(sp);
+	ASSERT(read_fn);
+	ASSERT(flabels);
+	ASSERT(fstats);
 
-	texgz_tex_t* input = self->input;
+	if((width < s) || (height < s) ||
+	   ((width%s) != 0) || ((height%s) != 0))
+	{
+		LOGE("invalid s=%i, width=%i, height=%i",
+		     s, width, height);
+		return 0;
+	}
 
-	texgz_tex_t* out;
-	out = texgz_tex_new(input->width, input->height,
-	                    input->width, input->height,
-	                    input->type, input->format,
-	                    NULL);
-	if(out == NULL)
+	// the window holds the active cluster row plus a halo of
+	// one superpixel row above and below where the solved
+	// clusters of the rows which remain in the window are
+	// kept when the window slides
+	int kw = width/s;
+	int kh = height/s;
+	int wk = (kh < 3) ? kh : 3;
+
+	texgz_tex_t* window;
+	window = texgz_tex_new(width, wk*s, width, wk*s,
+	                       TEXGZ_FLOAT, TEXGZ_RGBA, NULL);
+	if(window == NULL)
 	{
-	        return NULL;
+		return 0;
 	}
 
-	// copy pixels
-	int   x;
-	int   y;
-	float pixel[4];
-	texgz_slicSample_t* sample;
-	for(y = 0; y < out->height; ++y)
+	if((*read_fn)(priv, 0, wk*s,
+	              (float*) window->pixels) == 0)
 	{
-		for(x = 0; x < out->width; ++x)
+		goto fail_read;
+	}
+
+	texgz_slic_t* slic;
+	slic = texgz_slic_new(window, s, m, sdx, n, recenter, 0);
+	if(slic == NULL)
+	{
+		goto fail_slic;
+	}
+
+	int32_t* labels;
+	labels = (int32_t*) MALLOC(s*width*sizeof(int32_t));
+	if(labels == NULL)
+	{
+		goto fail_labels;
+	}
+
+	texgz_slicRecord_t* records;
+	records = (texgz_slicRecord_t*)
+	          CALLOC(kw, sizeof(texgz_slicRecord_t));
+	if(records == NULL)
+	{
+		goto fail_records;
+	}
+
+	// t is the first cluster row of the window
+	int    i;
+	int    j;
+	int    k;
+	int    l;
+	int    t      = 0;
+	int    solved = 0;
+	size_t bytes  = 4*s*width*sizeof(float);
+	float* avg    = (float*) slic->sp_avg->pixels;
+	float* stddev = (float*) slic->sp_stddev->pixels;
+	for(i = 0; i < kh; ++i)
+	{
+		// slide the window by one superpixel row
+		if((i - 1 > t) && (t + wk < kh))
 		{
-			sample = texgz_slic_sample(self, x, y);
-			if(sample->cluster)
+			memmove(window->pixels,
+			        &window->pixels[bytes],
+			        (wk - 1)*bytes);
+			if((*read_fn)(priv, (t + wk)*s, s,
+			              (float*) &window->pixels[(wk - 1)*bytes]) == 0)
 			{
-				texgz_tex_getPixelF(sp,
-				                    sample->cluster->j,
-				                    sample->cluster->i,
-				                    pixel);
-				texgz_tex_setPixelF(out, x, y, pixel);
+				goto fail_stream;
+			}
+
+			if(texgz_slic_slide(slic) == 0)
+			{
+				goto fail_stream;
 			}
+
+			++t;
+			solved = 0;
+		}
+
+		if(solved == 0)
+		{
+			texgz_slic_solve(slic, max_steps, epsilon);
+			solved = 1;
+		}
+
+		// write the labels for the cluster row band
+		int li = i - t;
+		for(l = 0; l < s*width; ++l)
+		{
+			k = slic->labels[li*s*width + l];
+			labels[l] = (k < 0) ? -1 : t*kw + k;
+		}
+
+		if(fwrite(labels, sizeof(int32_t), s*width,
+		          flabels) != s*width)
+		{
+			LOGE("fwrite failed");
+			goto fail_stream;
+		}
+
+		// write the cluster row stats
+		for(j = 0; j < kw; ++j)
+		{
+			texgz_slicRecord_t* r = &records[j];
+
+			k = li*kw + j;
+			r->cx    = slic->cx[k];
+			r->cy    = slic->cy[k] + t*s;
+			r->count = slic->stats.count[k];
+			memcpy(r->avg,    &avg[4*k],    sizeof(r->avg));
+			memcpy(r->stddev, &stddev[4*k], sizeof(r->stddev));
+		}
+
+		if(fwrite(records, sizeof(texgz_slicRecord_t), kw,
+		          fstats) != kw)
+		{
+			LOGE("fwrite failed");
+			goto fail_stream;
 		}
 	}
 
-	return out;
+	FREE(records);
+	FREE(labels);
+	texgz_slic_delete(&slic);
+	texgz_tex_delete(&window);
+
+	// success
+	return 1;
+
+	// failure
+	fail_stream:
+		FREE(records);
+	fail_records:
+		FREE(labels);
+	fail_labels:
+		texgz_slic_delete(&slic);
+	fail_slic:
+	fail_read:
+		texgz_tex_delete(&window);
+	return 0;
 }
@@ -24,33 +24,29 @@
 #ifndef texgz_slic_H
 #define texgz_slic_H
 
-#include "texgz/texgz_tex.h"
+#include <stdint.h>
+#include <stdio.h>
 
-typedef struct
-{
-	// index
-	int i;
-	int j;
-
-	// center
-	int x;
-	int y;
-
-	// center, avg and stddev sums
-	int   count;
-	int   sum_x;
-	int   sum_y;
-	float sum_pixel1[4];
-	float sum_pixel2[4];
-} texgz_slicCluster_t;
+#include "texgz/texgz_tex.h"
 
+// cluster statistics stored as SoA arrays of kw*kh
+// clusters where the cluster index is k = i*kw + j and
+// mean/m2 are stored as 4 channel planes
+// the outlier moments are kept separately so the stddev
+// may include outliers relative to the inlier mean
 typedef struct
 {
-	float                dist;
-	texgz_slicCluster_t* cluster;
-} texgz_slicSample_t;
+	int*   count;
+	int*   sum_x;
+	int*   sum_y;
+	float* mean;
+	float* m2;
+	int*   outlier_count;
+	float* outlier_mean;
+	float* outlier_m2;
+} texgz_slicStats_t;
 
-typedef struct
+typedef struct texgz_slic_s
 {
 	int   s;   // superpixel size
 	float m;   // compactness control
@@ -63,9 +59,38 @@ typedef struct
 	// input reference
 	texgz_tex_t* input;
 
+	// optional coarse level solved on the input
+	// downscaled by 2^levels
+	int                  levels;
+	texgz_tex_t*         coarse_input;
+	struct texgz_slic_s* coarse;
+
+	// cluster centers (K)
+	int* cx;
+	int* cy;
+
+	// cluster center y range for each cluster row (kh)
+	int* cy_min;
+	int* cy_max;
+
+	// cluster label per pixel (-1 if unassigned)
+	int32_t* labels;
+
 	// step state
-	texgz_slicCluster_t* clusters;
-	texgz_slicSample_t*  samples;
+	// stats: cluster statistics followed by kh chunk sets
+	//        of the cluster rows near each cluster row of
+	//        samples (see texgz_slic_chunkStats)
+	// overflow: kh flags of chunks with samples outside
+	//           the chunk sets
+	// dist: nth buffers of s rows of sample distances
+	// prev: nth buffers of s rows of previous labels
+	// changed: nth counts of reassigned samples
+	int               nth;
+	texgz_slicStats_t stats;
+	int*              overflow;
+	float*            dist;
+	int32_t*          prev;
+	int*              changed;
 
 	// superpixel features
 	texgz_tex_t* sp_avg;     // kwxkh
@@ -73,13 +98,56 @@ typedef struct
 	texgz_tex_t* sp_outlier; // wxh
 } texgz_slic_t;
 
+// streaming cluster record written for each cluster in
+// row-major order
+typedef struct
+{
+	int32_t cx;
+	int32_t cy;
+	int32_t count;
+	float   avg[4];
+	float   stddev[4];
+} texgz_slicRecord_t;
+
+// superpixel features computed from the label map
+typedef struct
+{
+	int32_t count;
+	float   cx;
+	float   cy;
+	float   avg[4];
+	float   stddev[4];
+} texgz_slicFeature_t;
+
+// read rows [y, y + rows) of the input as FLOAT RGBA
+typedef int (*texgz_slicStream_readFn)(void* priv,
+                                       int y, int rows,
+                                       float* pixels);
+
 texgz_slic_t* texgz_slic_new(texgz_tex_t* input,
                              int s, float m, float sdx,
-                             int n, int recenter);
+                             int n, int recenter,
+                             int levels);
 void          texgz_slic_delete(texgz_slic_t** _self);
 float         texgz_slic_step(texgz_slic_t* self,
                               int step);
+int           texgz_slic_solve(texgz_slic_t* self,
+                               int max_steps,
+                               float epsilon);
+float         texgz_slic_error(texgz_slic_t* self);
+int           texgz_slic_connect(texgz_slic_t* self,
+                                 int min_size);
+texgz_tex_t*  texgz_slic_labels(texgz_slic_t* self);
+void          texgz_slic_features(texgz_slic_t* self,
+                                  texgz_slicFeature_t* features);
 texgz_tex_t*  texgz_slic_output(texgz_slic_t* self,
                                 texgz_tex_t* sp);
+int           texgz_slic_stream(int width, int height,
+                                int s, float m, float sdx,
+                                int n, int recenter,
+                                int max_steps, float epsilon,
+                                texgz_slicStream_readFn read_fn,
+                                void* priv, FILE* flabels,
+                                FILE* fstats);
 
 #endif
@@ -0,0 +1,816 @@
+/*
+ * Copyright (c) 2023 Jeff Boody
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
+#define LOG_TAG "texgz"
+#include "../libcc/math/cc_float.h"
+#include "../libcc/cc_log.h"
+#include "texgz_inlier.h"
+#include "texgz_thread.h"
+
+// the 32-bit vector lanes accumulate at most this many
+// samples per channel before they are added to the 64-bit
+// block sums so that the sum of squares cannot overflow
+#define TEXGZ_INLIER_FLUSH 65536
+
+// the RGBA8 threshold is tested on the integer moments
+// for blocks up to this many samples (4096x4096)
+#define TEXGZ_INLIER_EXACT 16777216
+
+typedef struct
+{
+	texgz_tex_t* src;
+	texgz_tex_t* dst;
+	int          sx;
+	int          sy;
+	float        sdx;
+
+	// optional block moments (see texgz_tex_inlierMoments)
+	double* moments;
+	int     valid;
+} texgz_inlier_t;
+
+/***********************************************************
+* private                                                  *
+***********************************************************/
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+// compute the block sum and sum of squares of RGBA8 in a
+// single pass where RGBA is kept in the 4 lanes of a
+// 32-bit vector and the main loop reads four pixels at a
+// time
+static void
+texgz_inlier_sum8(texgz_inlier_t* self, const uint8_t* block,
+                  uint64_t* sum, uint64_t* sum2)
+{
+	ASSERT(self);
+	ASSERT(block);
+	ASSERT(sum);
+	ASSERT(sum2);
+
+	int sx     = self->sx;
+	int sy     = self->sy;
+	int stride = 4*self->src->stride;
+
+	int c;
+	int i;
+	int j;
+
+	int rows = TEXGZ_INLIER_FLUSH/sx;
+	if(rows < 1)
+	{
+		rows = 1;
+	}
+
+	int      i0;
+	uint32_t s[4];
+	uint32_t s2[4];
+	for(i0 = 0; i0 < sy; i0 += rows)
+	{
+		int i1 = i0 + rows;
+		if(i1 > sy)
+		{
+			i1 = sy;
+		}
+
+		#if defined(__SSE2__)
+		__m128i z  = _mm_setzero_si128();
+		__m128i vs  = _mm_setzero_si128();
+		__m128i vs2 = _mm_setzero_si128();
+		for(i = i0; i < i1; ++i)
+		{
+			const uint8_t* row = &block[i*stride];
+			for(j = 0; j + 4 <= sx; j += 4)
+			{
+				__m128i v;
+				v = _mm_loadu_si128((const __m128i*) &row[4*j]);
+
+				__m128i pl = _mm_unpacklo_epi8(v, z);
+				__m128i ph = _mm_unpackhi_epi8(v, z);
+				__m128i p  = _mm_add_epi16(pl, ph);
+				__m128i ql = _mm_mullo_epi16(pl, pl);
+				__m128i qh = _mm_mullo_epi16(ph, ph);
+				vs  = _mm_add_epi32(vs, _mm_unpacklo_epi16(p, z));
+				vs  = _mm_add_epi32(vs, _mm_unpackhi_epi16(p, z));
+				vs2 = _mm_add_epi32(vs2, _mm_unpacklo_epi16(ql, z));
+				vs2 = _mm_add_epi32(vs2, _mm_unpackhi_epi16(ql, z));
+				vs2 = _mm_add_epi32(vs2, _mm_unpacklo_epi16(qh, z));
+				vs2 = _mm_add_epi32(vs2, _mm_unpackhi_epi16(qh, z));
+			}
+
+			for(; j < sx; ++j)
+			{
+				int32_t t;
+				memcpy(&t, &row[4*j], 4);
+
+				__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(t), z);
+				__m128i q = _mm_mullo_epi16(p, p);
+				vs  = _mm_add_epi32(vs, _mm_unpacklo_epi16(p, z));
+				vs2 = _mm_add_epi32(vs2, _mm_unpacklo_epi16(q, z));
+			}
+		}
+		_mm_storeu_si128((__m128i*) s, vs);
+		_mm_storeu_si128((__m128i*) s2, vs2);
+		#else
+		uint32x4_t vs  = vdupq_n_u32(0);
+		uint32x4_t vs2 = vdupq_n_u32(0);
+		for(i = i0; i < i1; ++i)
+		{
+			const uint8_t* row = &block[i*stride];
+			for(j = 0; j + 4 <= sx; j += 4)
+			{
+				uint8x16_t v  = vld1q_u8(&row[4*j]);
+				uint8x8_t  vl = vget_low_u8(v);
+				uint8x8_t  vh = vget_high_u8(v);
+				uint16x8_t p  = vaddl_u8(vl, vh);
+				uint16x8_t ql = vmull_u8(vl, vl);
+				uint16x8_t qh = vmull_u8(vh, vh);
+				vs  = vaddq_u32(vs, vaddl_u16(vget_low_u16(p),
+				                              vget_high_u16(p)));
+				vs2 = vaddq_u32(vs2, vaddl_u16(vget_low_u16(ql),
+				                               vget_high_u16(ql)));
+				vs2 = vaddq_u32(vs2, vaddl_u16(vget_low_u16(qh),
+				                               vget_high_u16(qh)));
+			}
+
+			for(; j < sx; ++j)
+			{
+				uint32_t t;
+				memcpy(&t, &row[4*j], 4);
+
+				uint8x8_t v = vreinterpret_u8_u32(vdup_n_u32(t));
+				vs  = vaddw_u16(vs, vget_low_u16(vmovl_u8(v)));
+				vs2 = vaddw_u16(vs2, vget_low_u16(vmull_u8(v, v)));
+			}
+		}
+		vst1q_u32(s, vs);
+		vst1q_u32(s2, vs2);
+		#endif
+
+		for(c = 0; c < 4; ++c)
+		{
+			sum[c]  += s[c];
+			sum2[c] += s2[c];
+		}
+	}
+}
+
+// compute the block sum and count of RGBA8 samples in the
+// range lo <= p <= lo + d where the unsigned range check
+// is (p - lo) <= d
+static void
+texgz_inlier_in8(texgz_inlier_t* self, const uint8_t* block,
+                 const int32_t* lo, const int32_t* d,
+                 uint64_t* in, uint32_t* count)
+{
+	ASSERT(self);
+	ASSERT(block);
+	ASSERT(lo);
+	ASSERT(d);
+	ASSERT(in);
+	ASSERT(count);
+
+	int sx     = self->sx;
+	int sy     = self->sy;
+	int stride = 4*self->src->stride;
+
+	int c;
+	int i;
+	int j;
+
+	int rows = TEXGZ_INLIER_FLUSH/sx;
+	if(rows < 1)
+	{
+		rows = 1;
+	}
+
+	int      i0;
+	uint32_t s[4];
+	uint32_t n[4];
+	for(i0 = 0; i0 < sy; i0 += rows)
+	{
+		int i1 = i0 + rows;
+		if(i1 > sy)
+		{
+			i1 = sy;
+		}
+
+		#if defined(__SSE2__)
+		// the range check is (p - lo) saturating minus d
+		// equal to zero since SSE2 lacks an unsigned 16-bit
+		// compare
+		__m128i z  = _mm_setzero_si128();
+		__m128i vl = _mm_setr_epi16(lo[0], lo[1], lo[2], lo[3],
+		                            lo[0], lo[1], lo[2], lo[3]);
+		__m128i vd = _mm_setr_epi16(d[0], d[1], d[2], d[3],
+		                            d[0], d[1], d[2], d[3]);
+		__m128i vs = _mm_setzero_si128();
+		__m128i vn = _mm_setzero_si128();
+		for(i = i0; i < i1; ++i)
+		{
+			const uint8_t* row = &block[i*stride];
+			for(j = 0; j + 4 <= sx; j += 4)
+			{
+				__m128i v;
+				v = _mm_loadu_si128((const __m128i*) &row[4*j]);
+
+				__m128i pl = _mm_unpacklo_epi8(v, z);
+				__m128i ph = _mm_unpackhi_epi8(v, z);
+				__m128i ml = _mm_sub_epi16(pl, vl);
+				__m128i mh = _mm_sub_epi16(ph, vl);
+				ml = _mm_cmpeq_epi16(_mm_subs_epu16(ml, vd), z);
+				mh = _mm_cmpeq_epi16(_mm_subs_epu16(mh, vd), z);
+
+				__m128i p = _mm_add_epi16(_mm_and_si128(pl, ml),
+				                          _mm_and_si128(ph, mh));
+				__m128i k = _mm_sub_epi16(_mm_sub_epi16(z, ml), mh);
+				vs = _mm_add_epi32(vs, _mm_unpacklo_epi16(p, z));
+				vs = _mm_add_epi32(vs, _mm_unpackhi_epi16(p, z));
+				vn = _mm_add_epi32(vn, _mm_unpacklo_epi16(k, z));
+				vn = _mm_add_epi32(vn, _mm_unpackhi_epi16(k, z));
+			}
+
+			for(; j < sx; ++j)
+			{
+				int32_t t;
+				memcpy(&t, &row[4*j], 4);
+
+				__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(t), z);
+				__m128i m = _mm_sub_epi16(p, vl);
+				m  = _mm_cmpeq_epi16(_mm_subs_epu16(m, vd), z);
+				vs = _mm_add_epi32(vs,
+				                   _mm_unpacklo_epi16(_mm_and_si128(p, m), z));
+				vn = _mm_add_epi32(vn,
+				                   _mm_unpacklo_epi16(_mm_sub_epi16(z, m), z));
+			}
+		}
+		_mm_storeu_si128((__m128i*) s, vs);
+		_mm_storeu_si128((__m128i*) n, vn);
+		#else
+		uint16_t lo8[8] =
+		{
+			(uint16_t) lo[0], (uint16_t) lo[1],
+			(uint16_t) lo[2], (uint16_t) lo[3],
+			(uint16_t) lo[0], (uint16_t) lo[1],
+			(uint16_t) lo[2], (uint16_t) lo[3],
+		};
+		uint16_t d8[8] =
+		{
+			(uint16_t) d[0], (uint16_t) d[1],
+			(uint16_t) d[2], (uint16_t) d[3],
+			(uint16_t) d[0], (uint16_t) d[1],
+			(uint16_t) d[2], (uint16_t) d[3],
+		};
+		uint16x8_t vl = vld1q_u16(lo8);
+		uint16x8_t vd = vld1q_u16(d8);
+		uint32x4_t vs = vdupq_n_u32(0);
+		uint32x4_t vn = vdupq_n_u32(0);
+		for(i = i0; i < i1; ++i)
+		{
+			const uint8_t* row = &block[i*stride];
+			for(j = 0; j + 4 <= sx; j += 4)
+			{
+				uint8x16_t v  = vld1q_u8(&row[4*j]);
+				uint16x8_t pl = vmovl_u8(vget_low_u8(v));
+				uint16x8_t ph = vmovl_u8(vget_high_u8(v));
+				uint16x8_t ml = vcleq_u16(vsubq_u16(pl, vl), vd);
+				uint16x8_t mh = vcleq_u16(vsubq_u16(ph, vl), vd);
+				uint16x8_t p  = vaddq_u16(vandq_u16(pl, ml),
+				                          vandq_u16(ph, mh));
+				uint16x8_t k  = vaddq_u16(vshrq_n_u16(ml, 15),
+				                          vshrq_n_u16(mh, 15));
+				vs = vaddq_u32(vs, vaddl_u16(vget_low_u16(p),
+				                             vget_high_u16(p)));
+				vn = vaddq_u32(vn, vaddl_u16(vget_low_u16(k),
+				                             vget_high_u16(k)));
+			}
+
+			for(; j < sx; ++j)
+			{
+				uint32_t t;
+				memcpy(&t, &row[4*j], 4);
+
+				uint8x8_t  v = vreinterpret_u8_u32(vdup_n_u32(t));
+				uint16x4_t p = vget_low_u16(vmovl_u8(v));
+				uint16x4_t m = vcle_u16(vsub_u16(p, vget_low_u16(vl)),
+				                        vget_low_u16(vd));
+				vs = vaddw_u16(vs, vand_u16(p, m));
+				vn = vaddw_u16(vn, vshr_n_u16(m, 15));
+			}
+		}
+		vst1q_u32(s, vs);
+		vst1q_u32(n, vn);
+		#endif
+
+		for(c = 0; c < 4; ++c)
+		{
+			in[c]    += s[c];
+			count[c] += n[c];
+		}
+	}
+}
+
+#endif
+
+// compute the integer bounds lo <= p <= lo + d of the
+// samples where |p - avg| <= sdx*sd which is evaluated on
+// the integer moments as |n*p - sum| <= r where r is the
+// integer square root of sdx^2*(n*sum2 - sum*sum) so that
+// samples on the threshold remain inliers
+static void
+texgz_inlier_range8(int n, uint64_t sum, uint64_t sum2,
+                    float sdx, int32_t* _lo, int32_t* _d)
+{
+	ASSERT(_lo);
+	ASSERT(_d);
+
+	int64_t lo;
+	int64_t hi;
+	double  sdx2 = ((double) sdx)*((double) sdx);
+	if(n <= TEXGZ_INLIER_EXACT)
+	{
+		// n*sum2 - sum*sum is n^2*var which cannot overflow
+		// and the threshold accepts every sample once it
+		// reaches (255*n)^2
+		uint64_t nvar = (uint64_t) n*sum2 - sum*sum;
+		double   rr   = sdx2*((double) nvar);
+		double   nn   = (double) n;
+		if(rr >= 65025.0*nn*nn)
+		{
+			lo = 0;
+			hi = 255;
+		}
+		else
+		{
+			uint64_t q = (uint64_t) rr;
+			uint64_t r = (uint64_t) sqrt((double) q);
+			while(r*r > q)
+			{
+				--r;
+			}
+			while((r + 1)*(r + 1) <= q)
+			{
+				++r;
+			}
+
+			int64_t s0 = (int64_t) sum - (int64_t) r;
+			int64_t s1 = (int64_t) sum + (int64_t) r;
+			lo = (s0 > 0) ? (s0 + n - 1)/n : 0;
+			hi = s1/n;
+		}
+	}
+	else
+	{
+		double nvar = ((double) n)*((double) sum2) -
+		              ((double) sum)*((double) sum);
+		double r    = (nvar > 0.0) ? sqrt(sdx2*nvar) : 0.0;
+		lo = (int64_t) cc_clamp(ceil((sum - r)/n), 0.0, 255.0);
+		hi = (int64_t) cc_clamp(floor((sum + r)/n), 0.0, 255.0);
+	}
+
+	if(hi > 255)
+	{
+		hi = 255;
+	}
+	if(hi < lo)
+	{
+		// empty range which rejects all samples
+		lo = 256;
+		hi = 256;
+	}
+
+	*_lo = (int32_t) lo;
+	*_d  = (int32_t) (hi - lo);
+}
+
+static void
+texgz_inlier_block8(texgz_inlier_t* self, int x, int y)
+{
+	ASSERT(self);
+
+	texgz_tex_t* src = self->src;
+
+	int      c;
+	int      sx     = self->sx;
+	int      sy     = self->sy;
+	int      n      = sx*sy;
+	uint8_t* block  = &src->pixels[4*(sy*y*src->stride + sx*x)];
+	uint8_t* dst    = &self->dst->pixels[4*(y*self->dst->stride + x)];
+
+	#if !defined(__SSE2__) && !defined(__ARM_NEON)
+	int i;
+	int j;
+	int stride = 4*src->stride;
+	#endif
+
+	// the moments are integers so the doubles are exact
+	uint64_t sum[4]  = { 0 };
+	uint64_t sum2[4] = { 0 };
+	double*  m       = NULL;
+	if(self->moments)
+	{
+		m = &self->moments[8*(y*self->dst->width + x)];
+	}
+	if(m && self->valid)
+	{
+		for(c = 0; c < 4; ++c)
+		{
+			sum[c]  = (uint64_t) m[c];
+			sum2[c] = (uint64_t) m[c + 4];
+		}
+	}
+	else
+	{
+		#if defined(__SSE2__) || defined(__ARM_NEON)
+		texgz_inlier_sum8(self, block, sum, sum2);
+		#else
+		// compute the block sum and sum of squares in a
+		// single pass where the channels are unrolled to
+		// keep the row accumulators in registers
+		for(i = 0; i < sy; ++i)
+		{
+			uint8_t* row = &block[i*stride];
+
+			uint32_t r0  = 0;
+			uint32_t r1  = 0;
+			uint32_t r2  = 0;
+			uint32_t r3  = 0;
+			uint32_t rr0 = 0;
+			uint32_t rr1 = 0;
+			uint32_t rr2 = 0;
+			uint32_t rr3 = 0;
+			for(j = 0; j < 4*sx; j += 4)
+			{
+				uint32_t p0 = row[j];
+				uint32_t p1 = row[j + 1];
+				uint32_t p2 = row[j + 2];
+				uint32_t p3 = row[j + 3];
+				r0  += p0;
+				r1  += p1;
+				r2  += p2;
+				r3  += p3;
+				rr0 += p0*p0;
+				rr1 += p1*p1;
+				rr2 += p2*p2;
+				rr3 += p3*p3;
+			}
+
+			sum[0]  += r0;
+			sum[1]  += r1;
+			sum[2]  += r2;
+			sum[3]  += r3;
+			sum2[0] += rr0;
+			sum2[1] += rr1;
+			sum2[2] += rr2;
+			sum2[3] += rr3;
+		}
+		#endif
+
+		if(m)
+		{
+			for(c = 0; c < 4; ++c)
+			{
+				m[c]     = (double) sum[c];
+				m[c + 4] = (double) sum2[c];
+			}
+		}
+	}
+
+	// check if stddev threshold disabled
+	// e.g. downsampling with box filter
+	if(self->sdx == 0.0f)
+	{
+		for(c = 0; c < 4; ++c)
+		{
+			dst[c] = (uint8_t) (sum[c]/n);
+		}
+		return;
+	}
+
+	// convert the stddev threshold to integer bounds
+	// clamped to the byte range
+	int32_t lo[4];
+	int32_t d[4];
+	for(c = 0; c < 4; ++c)
+	{
+		texgz_inlier_range8(n, sum[c], sum2[c], self->sdx,
+		                    &lo[c], &d[c]);
+	}
+
+	// average inlier samples below sdx threshold while the
+	// block is still resident in the cache
+	uint64_t in[4]    = { 0 };
+	uint32_t count[4] = { 0 };
+	#if defined(__SSE2__) || defined(__ARM_NEON)
+	texgz_inlier_in8(self, block, lo, d, in, count);
+	#else
+	uint32_t lo0 = (uint32_t) lo[0];
+	uint32_t lo1 = (uint32_t) lo[1];
+	uint32_t lo2 = (uint32_t) lo[2];
+	uint32_t lo3 = (uint32_t) lo[3];
+	uint32_t d0  = (uint32_t) d[0];
+	uint32_t d1  = (uint32_t) d[1];
+	uint32_t d2  = (uint32_t) d[2];
+	uint32_t d3  = (uint32_t) d[3];
+	for(i = 0; i < sy; ++i)
+	{
+		uint8_t* row = &block[i*stride];
+
+		uint32_t in0 = 0;
+		uint32_t in1 = 0;
+		uint32_t in2 = 0;
+		uint32_t in3 = 0;
+		uint32_t c0  = 0;
+		uint32_t c1  = 0;
+		uint32_t c2  = 0;
+		uint32_t c3  = 0;
+		for(j = 0; j < 4*sx; j += 4)
+		{
+			uint32_t p0 = row[j];
+			uint32_t p1 = row[j + 1];
+			uint32_t p2 = row[j + 2];
+			uint32_t p3 = row[j + 3];
+			uint32_t m0 = 0 - (uint32_t) ((p0 - lo0) <= d0);
+			uint32_t m1 = 0 - (uint32_t) ((p1 - lo1) <= d1);
+			uint32_t m2 = 0 - (uint32_t) ((p2 - lo2) <= d2);
+			uint32_t m3 = 0 - (uint32_t) ((p3 - lo3) <= d3);
+			in0 += p0 & m0;
+			in1 += p1 & m1;
+			in2 += p2 & m2;
+			in3 += p3 & m3;
+			c0  -= m0;
+			c1  -= m1;
+			c2  -= m2;
+			c3  -= m3;
+		}
+
+		in[0]    += in0;
+		in[1]    += in1;
+		in[2]    += in2;
+		in[3]    += in3;
+		count[0] += c0;
+		count[1] += c1;
+		count[2] += c2;
+		count[3] += c3;
+	}
+	#endif
+
+	for(c = 0; c < 4; ++c)
+	{
+		dst[c] = count[c] ? (uint8_t) (in[c]/count[c]) : 0;
+	}
+}
+
+static void
+texgz_inlier_blockF(texgz_inlier_t* self, int x, int y)
+{
+	ASSERT(self);
+
+	texgz_tex_t* src = self->src;
+
+	int    sx     = self->sx;
+	int    sy     = self->sy;
+	int    n      = sx*sy;
+	int    stride = 4*src->stride;
+	float* block  = (float*) src->pixels;
+	block = &block[4*(sy*y*src->stride + sx*x)];
+
+	int     c;
+	int     i;
+	int     j;
+	double  sum[4]  = { 0.0 };
+	double  sum2[4] = { 0.0 };
+	double* m       = NULL;
+	if(self->moments)
+	{
+		m = &self->moments[8*(y*self->dst->width + x)];
+	}
+	if(m && self->valid)
+	{
+		for(c = 0; c < 4; ++c)
+		{
+			sum[c]  = m[c];
+			sum2[c] = m[c + 4];
+		}
+	}
+	else
+	{
+		// compute the block sum and sum of squares in a
+		// single pass
+		for(i = 0; i < sy; ++i)
+		{
+			float* row = &block[i*stride];
+			for(j = 0; j < sx; ++j)
+			{
+				for(c = 0; c < 4; ++c)
+				{
+					double p = row[4*j + c];
+					sum[c]  += p;
+					sum2[c] += p*p;
+				}
+			}
+		}
+
+		if(m)
+		{
+			for(c = 0; c < 4; ++c)
+			{
+				m[c]     = sum[c];
+				m[c + 4] = sum2[c];
+			}
+		}
+	}
+
+	float avg[4];
+	float lo[4];
+	float hi[4];
+	for(c = 0; c < 4; ++c)
+	{
+		double mean = sum[c]/n;
+		double var  = sum2[c]/n - mean*mean;
+		float  sd   = (var > 0.0) ? (float) sqrt(var) : 0.0f;
+		avg[c] = (float) mean;
+		lo[c]  = avg[c] - self->sdx*sd;
+		hi[c]  = avg[c] + self->sdx*sd;
+	}
+
+	// average inlier samples below sdx threshold
+	if(self->sdx != 0.0f)
+	{
+		float in[4]    = { 0.0f };
+		int   count[4] = { 0 };
+		for(i = 0; i < sy; ++i)
+		{
+			float* row = &block[i*stride];
+			for(j = 0; j < sx; ++j)
+			{
+				for(c = 0; c < 4; ++c)
+				{
+					float p      = row[4*j + c];
+					int   inlier = (p >= lo[c]) & (p <= hi[c]);
+					in[c]    += inlier ? p : 0.0f;
+					count[c] += inlier;
+				}
+			}
+		}
+
+		for(c = 0; c < 4; ++c)
+		{
+			avg[c] = count[c] ? in[c]/count[c] : 0.0f;
+		}
+	}
+
+	if(self->dst->type == TEXGZ_FLOAT)
+	{
+		texgz_tex_setPixelF(self->dst, x, y, avg);
+		return;
+	}
+
+	unsigned char pixel[4];
+	for(c = 0; c < 4; ++c)
+	{
+		pixel[c] = (unsigned char)
+		           cc_clamp(255.0f*avg[c], 0.0f, 255.0f);
+	}
+	texgz_tex_setPixel(self->dst, x, y, pixel);
+}
+
+static void
+texgz_inlier_rows(void* priv, int tid, int y0, int y1)
+{
+	ASSERT(priv);
+
+	texgz_inlier_t* self = (texgz_inlier_t*) priv;
+
+	int x;
+	int y;
+	for(y = y0; y < y1; ++y)
+	{
+		for(x = 0; x < self->dst->width; ++x)
+		{
+			if(self->src->type == TEXGZ_UNSIGNED_BYTE)
+			{
+				texgz_inlier_block8(self, x, y);
+			}
+			else
+			{
+				texgz_inlier_blockF(self, x, y);
+			}
+		}
+	}
+}
+
+/***********************************************************
+* public                                                   *
+***********************************************************/
+
+texgz_tex_t* texgz_tex_inlier(texgz_tex_t* tex,
+                              int s, float sdx)
+{
+	ASSERT(tex);
+
+	return texgz_tex_inlierxy(tex, s, s, sdx);
+}
+
+texgz_tex_t* texgz_tex_inlierxy(texgz_tex_t* tex,
+                                int sx, int sy, float sdx)
+{
+	ASSERT(tex);
+
+	return texgz_tex_inlierMoments(tex, sx, sy, sdx,
+	                               TEXGZ_UNSIGNED_BYTE,
+	                               NULL, 0);
+}
+
+texgz_tex_t*
+texgz_tex_inlierMoments(texgz_tex_t* tex,
+                        int sx, int sy, float sdx,
+                        int type, double* moments,
+                        int valid)
+{
+	ASSERT(tex);
+
+	// check the size
+	if((sx <= 0) || (sy <= 0) ||
+	   (tex->width%sx != 0) || (tex->height%sy != 0))
+	{
+		LOGE("invalid width=%i, height=%i, sx=%i, sy=%i",
+		     tex->width, tex->height, sx, sy);
+		return NULL;
+	}
+
+	// check the type/format
+	// the RGBA8 blocks are output as RGBA8 since they are
+	// processed in the byte domain
+	if(((tex->type != TEXGZ_FLOAT) &&
+	    (tex->type != TEXGZ_UNSIGNED_BYTE)) ||
+	   (tex->format != TEXGZ_RGBA) ||
+	   ((type != TEXGZ_FLOAT) &&
+	    (type != TEXGZ_UNSIGNED_BYTE)) ||
+	   ((tex->type == TEXGZ_UNSIGNED_BYTE) &&
+	    (type == TEXGZ_FLOAT)))
+	{
+		LOGE("invalid type=0x%X, format=0x%X, output=0x%X",
+		     tex->type, tex->format, type);
+		return NULL;
+	}
+
+	int w = tex->width/sx;
+	int h = tex->height/sy;
+
+	// create inlier output
+	texgz_tex_t* tex_in;
+	tex_in = texgz_tex_new(w, h, w, h, type,
+	                       TEXGZ_RGBA, NULL);
+	if(tex_in == NULL)
+	{
+		return NULL;
+	}
+
+	// compute inliers for bands of block rows where
+	// RGBA8 blocks are processed in the byte domain
+	texgz_inlier_t self =
+	{
+		.src     = tex,
+		.dst     = tex_in,
+		.sx      = sx,
+		.sy      = sy,
+		.sdx     = sdx,
+		.moments = moments,
+		.valid   = valid,
+	};
+	texgz_thread_parallel(h, &self, texgz_inlier_rows);
+
+	return tex_in;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023 Jeff Boody
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef texgz_inlier_H
+#define texgz_inlier_H
+
+#include "texgz_tex.h"
+
+// decimate RGBA8 or FLOAT RGBA by sxs (or sx x sy) blocks
+// to RGBA8 by averaging the samples within sdx stddevs of
+// the block mean (e.g. sdx=0 is a box filter)
+texgz_tex_t* texgz_tex_inlier(texgz_tex_t* tex,
+                              int s, float sdx);
+texgz_tex_t* texgz_tex_inlierxy(texgz_tex_t* tex,
+                                int sx, int sy, float sdx);
+
+// the output type may be FLOAT for FLOAT inputs and the
+// optional block moments store sum[4] and sum2[4] (of
+// samples in the input type) for each output pixel which
+// are computed when valid is 0 or reused when valid is 1
+// e.g. to sum the moments of 2x2 blocks for a larger
+// block size rather than revisit the samples
+texgz_tex_t* texgz_tex_inlierMoments(texgz_tex_t* tex,
+                                     int sx, int sy,
+                                     float sdx, int type,
+                                     double* moments,
+                                     int valid);
+
+#endif
@@ -21,28 +21,208 @@
  *
  */
 
+#include <setjmp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #if defined(ANDROID) || defined(__APPLE__)
 	#include "../jpeg/jpeglib.h"
+	#include "../jpeg/jerror.h"
 #else
 	#include <jpeglib.h>
+	#include <jerror.h>
 #endif
 
 #define LOG_TAG "texgz"
 #include "../libcc/cc_log.h"
+#include "../libcc/cc_memory.h"
 #include "texgz_jpeg.h"
 
+#define TEXGZ_JPEG_SCANLINES 16
+
+// libjpeg-turbo 1.5 added partial decompression
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && \
+    (LIBJPEG_TURBO_VERSION_NUMBER >= 1005000)
+	#define TEXGZ_JPEG_CROP
+#endif
+
+typedef struct
+{
+	int format;
+
+	// libjpeg IDCT scaling
+	int scale_num;
+	int scale_denom;
+
+	// optional resize (0 for none)
+	int width;
+	int height;
+
+	// optional region (0 for none)
+	int region_x;
+	int region_y;
+	int region_w;
+	int region_h;
+
+	// optional destination (NULL to create)
+	texgz_tex_t* dst;
+
+	// partial decode returns the scanlines decoded before
+	// an error or the end of data (rows)
+	int partial;
+	int rows;
+} texgz_jpegParam_t;
+
+// error manager which returns to the setjmp in the
+// importj/exportj functions rather than calling exit
+typedef struct
+{
+	struct jpeg_error_mgr pub;
+
+	// jmp is only valid once set by importj/exportj
+	jmp_buf jmp;
+	int     jmp_valid;
+
+	// default error_exit and emit_message
+	void (*error_exit)(j_common_ptr cinfo);
+	void (*emit_message)(j_common_ptr cinfo, int msg_level);
+
+	// scanline of the premature end of data (or -1)
+	int eof;
+} texgz_jpegError_t;
+
+// growable destination manager for a caller-provided
+// output buffer
+typedef struct
+{
+	struct jpeg_destination_mgr pub;
+
+	// the buffer is allocated by C malloc when cmalloc is
+	// set (e.g. texgz_jpeg_compress) and otherwise MALLOC
+	int             cmalloc;
+	unsigned char** _data;
+	size_t*         _capacity;
+	size_t          size;
+} texgz_jpegDest_t;
+
+struct texgz_jpegDecoder_s
+{
+	struct jpeg_decompress_struct cinfo;
+	texgz_jpegError_t             jerr;
+};
+
+struct texgz_jpegEncoder_s
+{
+	struct jpeg_compress_struct cinfo;
+	texgz_jpegError_t           jerr;
+	texgz_jpegDest_t            dest;
+};
+
 /***********************************************************
 * private                                                  *
 ***********************************************************/
 
+static void texgz_jpegError_exit(j_common_ptr cinfo)
+{
+	ASSERT(cinfo);
+
+	texgz_jpegError_t* err = (texgz_jpegError_t*) cinfo->err;
+
+	// errors outside of importj/exportj (e.g. the
+	// jpeg_create functions) use the default error_exit
+	if(err->jmp_valid == 0)
+	{
+		(*err->error_exit)(cinfo);
+		return;
+	}
+
+	char msg[JMSG_LENGTH_MAX];
+	(*err->pub.format_message)(cinfo, msg);
+	LOGE("%s", msg);
+
+	longjmp(err->jmp, 1);
+}
+
+static void texgz_jpegError_output(j_common_ptr cinfo)
+{
+	ASSERT(cinfo);
+
+	texgz_jpegError_t* err = (texgz_jpegError_t*) cinfo->err;
+
+	char msg[JMSG_LENGTH_MAX];
+	(*err->pub.format_message)(cinfo, msg);
+	LOGW("%s", msg);
+}
+
+static void
+texgz_jpegError_emit(j_common_ptr cinfo, int msg_level)
+{
+	ASSERT(cinfo);
+
+	texgz_jpegError_t* err = (texgz_jpegError_t*) cinfo->err;
+
+	// the source manager inserts a fake EOI marker for
+	// truncated files so the remaining scanlines are gray
+	if((msg_level < 0) && (err->eof < 0) &&
+	   (err->pub.msg_code == JWRN_JPEG_EOF) &&
+	   cinfo->is_decompressor)
+	{
+		j_decompress_ptr dinfo = (j_decompress_ptr) cinfo;
+		err->eof = (int) dinfo->output_scanline;
+	}
+
+	(*err->emit_message)(cinfo, msg_level);
+}
+
+static struct jpeg_error_mgr*
+texgz_jpegError_init(texgz_jpegError_t* err)
+{
+	ASSERT(err);
+
+	jpeg_std_error(&err->pub);
+	err->jmp_valid          = 0;
+	err->error_exit         = err->pub.error_exit;
+	err->emit_message       = err->pub.emit_message;
+	err->eof                = -1;
+	err->pub.error_exit     = texgz_jpegError_exit;
+	err->pub.output_message = texgz_jpegError_output;
+	err->pub.emit_message   = texgz_jpegError_emit;
+
+	return &err->pub;
+}
+
+static int
+texgz_jpeg_memSrc(struct jpeg_decompress_struct* cinfo,
+                  size_t size, const void* data)
+{
+	ASSERT(cinfo);
+	ASSERT(data);
+
+	// jpeg_mem_src fails for empty buffers
+	if(size == 0)
+	{
+		LOGE("invalid size=0");
+		return 0;
+	}
+
+	jpeg_mem_src(cinfo, (const unsigned char*) data,
+	             (unsigned long) size);
+
+	return 1;
+}
+
 static void texgz_jpeg_rgb2rgba(texgz_tex_t* self)
 {
 	ASSERT(self);
+	ASSERT((self->format == TEXGZ_RGBA) ||
+	       (self->format == TEXGZ_BGRA));
 
 	unsigned char* pixels = self->pixels;
 
+	// RGBA or BGRA
+	int r = (self->format == TEXGZ_RGBA) ? 0 : 2;
+	int b = 2 - r;
+
 	int i;
 	int j;
 	int width  = self->width;
@@ -52,193 +232,1052 @@ static void texgz_jpeg_rgb2rgba(texgz_tex_t* self)
 	{
 		for(j = width - 1; j >= 0; --j)
 		{
+			unsigned char rr = pixels[3*j];
+			unsigned char bb = pixels[3*j + 2];
 			pixels[4*j + 3] = 0xFF;
-			pixels[4*j + 2] = pixels[3*j + 2];
+			pixels[4*j + b] = bb;
 			pixels[4*j + 1] = pixels[3*j + 1];
-			pixels[4*j]     = pixels[3*j];
+			pixels[4*j + r] = rr;
 		}
 
 		pixels += stride;
 	}
 }
 
+static int texgz_jpeg_isPow2(int x)
+{
+	return (x > 0) && ((x & (x - 1)) == 0);
+}
+
+static texgz_tex_t*
+texgz_jpeg_resample(texgz_tex_t* self, int format,
+                    int width, int height)
+{
+	ASSERT(self);
+
+	// the resamplers require RGBA
+	texgz_tex_t* src = self;
+	if(self->format != TEXGZ_RGBA)
+	{
+		src = texgz_tex_convertcopy(self, TEXGZ_UNSIGNED_BYTE,
+		                            TEXGZ_RGBA);
+		if(src == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	// use the lanczos3 filter for power-of-two decimation
+	// and otherwise fall back to the bilinear resize
+	texgz_tex_t* tex;
+	int scalex = src->width/width;
+	int scaley = src->height/height;
+	if((src->width  == scalex*width)  &&
+	   (src->height == scaley*height) &&
+	   (scalex == scaley) && texgz_jpeg_isPow2(scalex))
+	{
+		int level = 0;
+		while((1 << level) < scalex)
+		{
+			++level;
+		}
+
+		tex = texgz_tex_lanczos3(src, level);
+	}
+	else
+	{
+		tex = texgz_tex_resize(src, width, height);
+	}
+
+	if(src != self)
+	{
+		texgz_tex_delete(&src);
+	}
+
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	if(texgz_tex_convert(tex, TEXGZ_UNSIGNED_BYTE,
+	                     format) == 0)
+	{
+		texgz_tex_delete(&tex);
+		return NULL;
+	}
+
+	return tex;
+}
+
+static int
+texgz_jpeg_readImage(struct jpeg_decompress_struct* cinfo,
+                     texgz_tex_t* tex)
+{
+	ASSERT(cinfo);
+	ASSERT(tex);
+
+	// read up to TEXGZ_JPEG_SCANLINES per call
+	// note that libjpeg returns at most rec_outbuf_height
+	// scanlines per call
+	int i;
+	int n;
+	int bpp    = texgz_tex_bpp(tex);
+	int stride = bpp*tex->stride;
+	JSAMPROW rows[TEXGZ_JPEG_SCANLINES];
+	while(cinfo->output_scanline < cinfo->output_height)
+	{
+		n = cinfo->output_height - cinfo->output_scanline;
+		if(n > TEXGZ_JPEG_SCANLINES)
+		{
+			n = TEXGZ_JPEG_SCANLINES;
+		}
+
+		for(i = 0; i < n; ++i)
+		{
+			rows[i] = &tex->pixels[(cinfo->output_scanline + i)*
+			                       stride];
+		}
+
+		if(jpeg_read_scanlines(cinfo, rows, n) == 0)
+		{
+			LOGE("jpeg_read_scanlines failed");
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static void
+texgz_jpeg_copyRow(texgz_tex_t* tex, int y,
+                   int comps, unsigned char* src)
+{
+	ASSERT(tex);
+	ASSERT(src);
+
+	int bpp = texgz_tex_bpp(tex);
+	unsigned char* dst = &tex->pixels[bpp*y*tex->stride];
+	if(comps == bpp)
+	{
+		memcpy(dst, src, bpp*tex->width);
+		return;
+	}
+
+	// expand RGB to RGBA or BGRA
+	ASSERT(comps == 3);
+	ASSERT(bpp   == 4);
+
+	int r = (tex->format == TEXGZ_RGBA) ? 0 : 2;
+	int b = 2 - r;
+
+	int j;
+	for(j = 0; j < tex->width; ++j)
+	{
+		dst[4*j + r] = src[3*j];
+		dst[4*j + 1] = src[3*j + 1];
+		dst[4*j + b] = src[3*j + 2];
+		dst[4*j + 3] = 0xFF;
+	}
+}
+
+static int
+texgz_jpeg_readRegion(struct jpeg_decompress_struct* cinfo,
+                      texgz_tex_t* tex, int x, int y)
+{
+	ASSERT(cinfo);
+	ASSERT(tex);
+
+	// decode only the iMCU columns which overlap the region
+	// and skip the rows above the region when supported
+	// (the skipped rows are still entropy decoded but the
+	// IDCT and color conversion are avoided) otherwise the
+	// full rows are decoded and discarded
+	JDIMENSION x0 = 0;
+	#ifdef TEXGZ_JPEG_CROP
+	// include a one pixel border (when available) since the
+	// fancy upsampling replicates the chroma at the edges
+	// of the cropped scanlines
+	int l = (x > 0) ? 1 : 0;
+	int r = (x + tex->width < cinfo->output_width) ? 1 : 0;
+	JDIMENSION w0 = (JDIMENSION) (tex->width + l + r);
+	x0 = (JDIMENSION) (x - l);
+	jpeg_crop_scanline(cinfo, &x0, &w0);
+
+	if(jpeg_skip_scanlines(cinfo, y) != (JDIMENSION) y)
+	{
+		LOGE("jpeg_skip_scanlines failed");
+		return 0;
+	}
+	#endif
+
+	int comps  = cinfo->output_components;
+	int offset = comps*(x - (int) x0);
+
+	// the scanlines are allocated from the image pool so
+	// they are freed by libjpeg on abort or error
+	JSAMPARRAY rows;
+	rows = (*cinfo->mem->alloc_sarray)((j_common_ptr) cinfo,
+	                                   JPOOL_IMAGE,
+	                                   comps*cinfo->output_width,
+	                                   TEXGZ_JPEG_SCANLINES);
+
+	int i;
+	int n;
+	int y0;
+	int y1 = y + tex->height;
+	while(cinfo->output_scanline < y1)
+	{
+		y0 = cinfo->output_scanline;
+		n  = y1 - y0;
+		if(n > TEXGZ_JPEG_SCANLINES)
+		{
+			n = TEXGZ_JPEG_SCANLINES;
+		}
+
+		n = jpeg_read_scanlines(cinfo, rows, n);
+		if(n == 0)
+		{
+			LOGE("jpeg_read_scanlines failed");
+			return 0;
+		}
+
+		for(i = 0; i < n; ++i)
+		{
+			if(y0 + i >= y)
+			{
+				texgz_jpeg_copyRow(tex, y0 + i - y, comps,
+				                   &rows[i][offset]);
+			}
+		}
+	}
+
+	return 1;
+}
+
 static texgz_tex_t*
 texgz_jpeg_importj(struct jpeg_decompress_struct* cinfo,
-                   int format)
+                   texgz_jpegParam_t* param)
 {
 	ASSERT(cinfo);
-	ASSERT((format == TEXGZ_RGB) ||
-	       (format == TEXGZ_RGBA));
+	ASSERT(param);
+
+	int format = param->format;
+	ASSERT((format == TEXGZ_RGB)  ||
+	       (format == TEXGZ_RGBA) ||
+	       (format == TEXGZ_BGRA) ||
+	       (format == TEXGZ_LUMINANCE));
+
+	// libjpeg errors return here (see texgz_jpegError_exit)
+	// and jmp_valid must be cleared on every return since
+	// the jmp is invalid once this function returns
+	texgz_jpegError_t*    err = (texgz_jpegError_t*) cinfo->err;
+	texgz_tex_t* volatile tex = NULL;
+	err->eof = -1;
+	err->jmp_valid = 1;
+	if(setjmp(err->jmp))
+	{
+		if(param->partial && tex &&
+		   (cinfo->output_scanline > 0))
+		{
+			goto partial;
+		}
+		goto fail_jpeg;
+	}
 
 	// start decompressing the jpeg
 	if(jpeg_read_header(cinfo, TRUE) != JPEG_HEADER_OK)
 	{
 		LOGE("jpeg_read_header failed");
+		jpeg_abort_decompress(cinfo);
+		err->jmp_valid = 0;
 		return NULL;
 	}
-	jpeg_start_decompress(cinfo);
+
+	// select the smallest 1/2^n IDCT scale which is not
+	// smaller than the requested size since the IDCT
+	// scaling skips most of the decoding work and the
+	// remainder is resampled
+	int iw = (int) cinfo->image_width;
+	int ih = (int) cinfo->image_height;
+	int resize = (param->width > 0) && (param->height > 0);
+	if(resize)
+	{
+		int denom = 8;
+		while((denom > 1) &&
+		      (((iw + denom - 1)/denom < param->width) ||
+		       ((ih + denom - 1)/denom < param->height)))
+		{
+			denom /= 2;
+		}
+		cinfo->scale_num   = 1;
+		cinfo->scale_denom = denom;
+	}
+	else
+	{
+		cinfo->scale_num   = param->scale_num;
+		cinfo->scale_denom = param->scale_denom;
+	}
 
 	// check for errors
-	if((cinfo->num_components == 3) &&
-	   (cinfo->image_width == cinfo->output_width) &&
-	   (cinfo->image_height == cinfo->output_height))
+	if((cinfo->num_components == 1) ||
+	   (cinfo->num_components == 3))
 	{
 		// ok
 	}
 	else
 	{
-		LOGE("invalid num_components=%i, image=%ix%i, output=%ix%i",
+		LOGE("invalid num_components=%i, image=%ix%i",
 		     cinfo->num_components,
-		     cinfo->image_width, cinfo->image_height,
-		     cinfo->output_width, cinfo->output_height);
+		     cinfo->image_width, cinfo->image_height);
 		goto fail_format;
 	}
 
-	// create the texgz tex
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(cinfo->image_width, cinfo->image_height,
-	                    cinfo->image_width, cinfo->image_height,
-	                    TEXGZ_UNSIGNED_BYTE, format,
-	                    NULL);
-	if(tex == NULL)
+	// select the output color space such that libjpeg
+	// writes the requested format directly (libjpeg-turbo)
+	// or otherwise expand RGB to RGBA/BGRA in place
+	int expand = 0;
+	if(format == TEXGZ_LUMINANCE)
 	{
-		goto fail_tex;
+		cinfo->out_color_space = JCS_GRAYSCALE;
+	}
+	else if(format == TEXGZ_RGBA)
+	{
+		#ifdef JCS_ALPHA_EXTENSIONS
+		cinfo->out_color_space = JCS_EXT_RGBA;
+		#else
+		cinfo->out_color_space = JCS_RGB;
+		expand = 1;
+		#endif
+	}
+	else if(format == TEXGZ_BGRA)
+	{
+		#ifdef JCS_ALPHA_EXTENSIONS
+		cinfo->out_color_space = JCS_EXT_BGRA;
+		#else
+		cinfo->out_color_space = JCS_RGB;
+		expand = 1;
+		#endif
+	}
+	else
+	{
+		cinfo->out_color_space = JCS_RGB;
 	}
+	jpeg_start_decompress(cinfo);
 
-	unsigned char* pixels = tex->pixels;
-	int stride_bytes3 = 3*cinfo->image_width;
-	int stride_bytes4 = 4*cinfo->image_width;
-	while(cinfo->output_scanline < cinfo->image_height)
+	// check the region
+	int w      = (int) cinfo->output_width;
+	int h      = (int) cinfo->output_height;
+	int region = (param->region_w > 0) && (param->region_h > 0);
+	if(region)
 	{
-		if(jpeg_read_scanlines(cinfo, &pixels, 1) != 1)
+		if((param->region_x < 0) || (param->region_y < 0) ||
+		   (param->region_x + param->region_w > w) ||
+		   (param->region_y + param->region_h > h))
+		{
+			LOGE("invalid region=%i,%i,%i,%i, output=%ix%i",
+			     param->region_x, param->region_y,
+			     param->region_w, param->region_h,
+			     w, h);
+			goto fail_region;
+		}
+
+		w = param->region_w;
+		h = param->region_h;
+	}
+
+	// create the texgz tex or decode to the dst
+	tex = param->dst;
+	if(tex)
+	{
+		if((tex->width != w) || (tex->height != h))
+		{
+			LOGE("invalid dst=%ix%i, output=%ix%i",
+			     tex->width, tex->height, w, h);
+			goto fail_tex;
+		}
+	}
+	else
+	{
+		tex = texgz_tex_new(w, h, w, h,
+		                    TEXGZ_UNSIGNED_BYTE, format,
+		                    NULL);
+		if(tex == NULL)
+		{
+			goto fail_tex;
+		}
+	}
+
+	if(region)
+	{
+		if(texgz_jpeg_readRegion(cinfo, tex,
+		                         param->region_x,
+		                         param->region_y) == 0)
+		{
+			goto fail_scanline;
+		}
+
+		// the scanlines below the region are not decoded
+		jpeg_abort_decompress(cinfo);
+	}
+	else
+	{
+		if(texgz_jpeg_readImage(cinfo, tex) == 0)
 		{
-			LOGE("jpeg_read_scanlines failed");
 			goto fail_scanline;
 		}
 
-		if(format == TEXGZ_RGBA)
+		param->rows = (err->eof < 0) ? h : err->eof;
+		jpeg_finish_decompress(cinfo);
+
+		// adjust pixels for RGBA/BGRA
+		if(expand)
+		{
+			texgz_jpeg_rgb2rgba(tex);
+		}
+	}
+
+	// the remaining work does not call libjpeg
+	err->jmp_valid = 0;
+
+	// resample the remainder of the resize
+	if(resize &&
+	   ((tex->width  != param->width) ||
+	    (tex->height != param->height)))
+	{
+		texgz_tex_t* tmp;
+		texgz_tex_t* src = tex;
+		tmp = texgz_jpeg_resample(src, format,
+		                          param->width,
+		                          param->height);
+		texgz_tex_delete(&src);
+		return tmp;
+	}
+
+	// success
+	return tex;
+
+	// partial success
+	partial:
+	{
+		// keep the scanlines decoded before the error and
+		// adjust pixels for RGBA/BGRA
+		param->rows = (int) cinfo->output_scanline;
+		if((err->eof >= 0) && (err->eof < param->rows))
+		{
+			param->rows = err->eof;
+		}
+		LOGW("partial rows=%i", param->rows);
+
+		if((cinfo->output_components == 3) &&
+		   (texgz_tex_bpp(tex) == 4))
 		{
-			pixels += stride_bytes4;
+			texgz_jpeg_rgb2rgba(tex);
 		}
-		else
+		jpeg_abort_decompress(cinfo);
+		err->jmp_valid = 0;
+		return tex;
+	}
+
+	// failure
+	fail_jpeg:
+	fail_scanline:
+		if(tex != param->dst)
 		{
-			pixels += stride_bytes3;
+			texgz_tex_t* tmp = tex;
+			texgz_tex_delete(&tmp);
 		}
+	fail_tex:
+	fail_region:
+	fail_format:
+		jpeg_abort_decompress(cinfo);
+		err->jmp_valid = 0;
+	return NULL;
+}
+
+static texgz_tex_t*
+texgz_jpeg_importfp(FILE* f, texgz_jpegParam_t* param)
+{
+	ASSERT(f);
+	ASSERT(param);
+
+	// create file decompressor
+	struct jpeg_decompress_struct cinfo;
+	texgz_jpegError_t jerr;
+	cinfo.err = texgz_jpegError_init(&jerr);
+	jpeg_create_decompress(&cinfo);
+	jpeg_stdio_src(&cinfo, f);
+
+	texgz_tex_t* self;
+	self = texgz_jpeg_importj(&cinfo, param);
+	if(self == NULL)
+	{
+		goto fail_import;
 	}
 
-	jpeg_finish_decompress(cinfo);
+	jpeg_destroy_decompress(&cinfo);
+
+	// success
+	return self;
+
+	// failure
+	fail_import:
+		jpeg_destroy_decompress(&cinfo);
+	return NULL;
+}
+
+static texgz_tex_t*
+texgz_jpeg_importfnp(const char* fname,
+                     texgz_jpegParam_t* param)
+{
+	ASSERT(fname);
+	ASSERT(param);
+
+	FILE *f = fopen(fname, "r");
+	if(f == NULL)
+	{
+		LOGE("fopen failed for %s", fname);
+		return NULL;
+	}
+
+	texgz_tex_t* tex = texgz_jpeg_importfp(f, param);
+	if(tex == NULL)
+	{
+		goto fail_tex;
+	}
+
+	fclose(f);
+
+	// success
+	return tex;
+
+	// failure
+	fail_tex:
+		fclose(f);
+	return NULL;
+}
+
+static texgz_tex_t*
+texgz_jpeg_importdp(size_t size, const void* data,
+                    texgz_jpegParam_t* param)
+{
+	ASSERT(data);
+	ASSERT(param);
+
+	// create memory decompressor
+	struct jpeg_decompress_struct cinfo;
+	texgz_jpegError_t jerr;
+	cinfo.err = texgz_jpegError_init(&jerr);
+	jpeg_create_decompress(&cinfo);
+	if(texgz_jpeg_memSrc(&cinfo, size, data) == 0)
+	{
+		goto fail_import;
+	}
+
+	texgz_tex_t* self;
+	self = texgz_jpeg_importj(&cinfo, param);
+	if(self == NULL)
+	{
+		goto fail_import;
+	}
+
+	jpeg_destroy_decompress(&cinfo);
+
+	// success
+	return self;
+
+	// failure
+	fail_import:
+		jpeg_destroy_decompress(&cinfo);
+	return NULL;
+}
+
+static int
+texgz_jpeg_checkScale(int scale_num, int scale_denom)
+{
+	if((scale_num <= 0) || (scale_denom <= 0))
+	{
+		LOGE("invalid scale_num=%i, scale_denom=%i",
+		     scale_num, scale_denom);
+		return 0;
+	}
+
+	return 1;
+}
+
+static int
+texgz_jpeg_checkSize(int width, int height)
+{
+	if((width <= 0) || (height <= 0))
+	{
+		LOGE("invalid width=%i, height=%i",
+		     width, height);
+		return 0;
+	}
+
+	return 1;
+}
+
+static void texgz_jpegDest_init(j_compress_ptr cinfo)
+{
+	ASSERT(cinfo);
+
+	texgz_jpegDest_t* dest = (texgz_jpegDest_t*) cinfo->dest;
+
+	dest->pub.next_output_byte = *(dest->_data);
+	dest->pub.free_in_buffer   = *(dest->_capacity);
+	dest->size                 = 0;
+}
+
+static boolean texgz_jpegDest_empty(j_compress_ptr cinfo)
+{
+	ASSERT(cinfo);
+
+	texgz_jpegDest_t* dest = (texgz_jpegDest_t*) cinfo->dest;
+
+	// the buffer is full so double the capacity
+	size_t capacity = *(dest->_capacity);
+	size_t resize   = 2*capacity;
+
+	unsigned char* data;
+	if(dest->cmalloc)
+	{
+		data = (unsigned char*) realloc(*(dest->_data), resize);
+	}
+	else
+	{
+		data = (unsigned char*) REALLOC(*(dest->_data), resize);
+	}
+	if(data == NULL)
+	{
+		LOGE("REALLOC failed");
+		ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+		return FALSE;
+	}
+
+	*(dest->_data)     = data;
+	*(dest->_capacity) = resize;
+
+	dest->pub.next_output_byte = &data[capacity];
+	dest->pub.free_in_buffer   = resize - capacity;
+
+	return TRUE;
+}
+
+static void texgz_jpegDest_term(j_compress_ptr cinfo)
+{
+	ASSERT(cinfo);
+
+	texgz_jpegDest_t* dest = (texgz_jpegDest_t*) cinfo->dest;
+
+	dest->size = *(dest->_capacity) - dest->pub.free_in_buffer;
+}
+
+static int
+texgz_jpeg_checkOptions(const texgz_jpegOptions_t* opt)
+{
+	ASSERT(opt);
+
+	if((opt->quality < 1) || (opt->quality > 100) ||
+	   ((opt->subsample != TEXGZ_JPEG_SUBSAMPLE_420) &&
+	    (opt->subsample != TEXGZ_JPEG_SUBSAMPLE_444)) ||
+	   ((opt->dct != TEXGZ_JPEG_DCT_ISLOW) &&
+	    (opt->dct != TEXGZ_JPEG_DCT_IFAST)))
+	{
+		LOGE("invalid quality=%i, subsample=%i, dct=%i",
+		     opt->quality, opt->subsample, opt->dct);
+		return 0;
+	}
+
+	return 1;
+}
+
+static int texgz_jpeg_colorSpace(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	if(self->type != TEXGZ_UNSIGNED_BYTE)
+	{
+		return JCS_UNKNOWN;
+	}
+
+	// the alpha channel is ignored by JCS_EXT_RGBX/BGRX
+	if(self->format == TEXGZ_RGB)
+	{
+		return JCS_RGB;
+	}
+	else if(self->format == TEXGZ_LUMINANCE)
+	{
+		return JCS_GRAYSCALE;
+	}
+	#ifdef JCS_EXTENSIONS
+	else if(self->format == TEXGZ_RGBA)
+	{
+		return JCS_EXT_RGBX;
+	}
+	else if(self->format == TEXGZ_BGRA)
+	{
+		return JCS_EXT_BGRX;
+	}
+	#endif
+
+	return JCS_UNKNOWN;
+}
+
+static texgz_tex_t* texgz_jpeg_exportTex(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	// RGB888, LUMINANCE and RGBA8888/BGRA8888 (libjpeg-turbo)
+	// are compressed directly and otherwise convert to RGB888
+	if(texgz_jpeg_colorSpace(self) != JCS_UNKNOWN)
+	{
+		return self;
+	}
+
+	return texgz_tex_convertcopy(self, TEXGZ_UNSIGNED_BYTE,
+	                             TEXGZ_RGB);
+}
+
+static int
+texgz_jpeg_exportj(struct jpeg_compress_struct* cinfo,
+                   texgz_tex_t* tex,
+                   const texgz_jpegOptions_t* opt)
+{
+	ASSERT(cinfo);
+	ASSERT(tex);
+	ASSERT(opt);
+
+	// libjpeg errors return here (see texgz_jpegError_exit)
+	// and jmp_valid must be cleared on every return since
+	// the jmp is invalid once this function returns
+	texgz_jpegError_t* err = (texgz_jpegError_t*) cinfo->err;
+	err->jmp_valid = 1;
+	if(setjmp(err->jmp))
+	{
+		goto fail_jpeg;
+	}
+
+	int bpp = texgz_tex_bpp(tex);
+
+	cinfo->image_width      = tex->width;
+	cinfo->image_height     = tex->height;
+	cinfo->input_components = bpp;
+	cinfo->in_color_space   = texgz_jpeg_colorSpace(tex);
+	jpeg_set_defaults(cinfo);
+	jpeg_set_quality(cinfo, opt->quality, TRUE);
+
+	// jpeg_set_defaults selects 4:2:0 for color images
+	if((opt->subsample == TEXGZ_JPEG_SUBSAMPLE_444) &&
+	   (cinfo->num_components == 3))
+	{
+		cinfo->comp_info[0].h_samp_factor = 1;
+		cinfo->comp_info[0].v_samp_factor = 1;
+	}
+
+	if(opt->dct == TEXGZ_JPEG_DCT_IFAST)
+	{
+		cinfo->dct_method = JDCT_IFAST;
+	}
+	else
+	{
+		cinfo->dct_method = JDCT_ISLOW;
+	}
+
+	cinfo->optimize_coding = opt->optimize ? TRUE : FALSE;
+	if(opt->progressive)
+	{
+		jpeg_simple_progression(cinfo);
+	}
+
+	jpeg_start_compress(cinfo, TRUE);
+
+	// write up to TEXGZ_JPEG_SCANLINES per call
+	int i;
+	int n;
+	int stride = bpp*tex->stride;
+	JSAMPROW rows[TEXGZ_JPEG_SCANLINES];
+	while(cinfo->next_scanline < cinfo->image_height)
+	{
+		n = cinfo->image_height - cinfo->next_scanline;
+		if(n > TEXGZ_JPEG_SCANLINES)
+		{
+			n = TEXGZ_JPEG_SCANLINES;
+		}
+
+		for(i = 0; i < n; ++i)
+		{
+			rows[i] = &tex->pixels[(cinfo->next_scanline + i)*
+			                       stride];
+		}
+
+		if(jpeg_write_scanlines(cinfo, rows, n) == 0)
+		{
+			LOGE("jpeg_write_scanlines failed");
+			goto fail_scanline;
+		}
+	}
+	jpeg_finish_compress(cinfo);
+	err->jmp_valid = 0;
+
+	// success
+	return 1;
+
+	// failure
+	fail_jpeg:
+	fail_scanline:
+		jpeg_abort_compress(cinfo);
+		err->jmp_valid = 0;
+	return 0;
+}
+
+/***********************************************************
+* public                                                   *
+***********************************************************/
+
+texgz_tex_t*
+texgz_jpeg_import(const char* fname, int format)
+{
+	ASSERT(fname);
+
+	return texgz_jpeg_importScaled(fname, format, 1, 1);
+}
+
+texgz_tex_t* texgz_jpeg_importf(FILE* f, int format)
+{
+	ASSERT(f);
+
+	return texgz_jpeg_importScaledf(f, format, 1, 1);
+}
+
+texgz_tex_t*
+texgz_jpeg_importd(size_t size, const void* data,
+                   int format)
+{
+	ASSERT(data);
+
+	return texgz_jpeg_importScaledd(size, data, format, 1, 1);
+}
+
+texgz_tex_t*
+texgz_jpeg_importPartial(const char* fname, int format,
+                         int* _rows)
+{
+	ASSERT(fname);
+	ASSERT(_rows);
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+		.partial     = 1,
+	};
+
+	*_rows = 0;
+
+	texgz_tex_t* tex = texgz_jpeg_importfnp(fname, &param);
+	if(tex)
+	{
+		*_rows = param.rows;
+	}
+
+	return tex;
+}
+
+texgz_tex_t*
+texgz_jpeg_importPartiald(size_t size, const void* data,
+                          int format, int* _rows)
+{
+	ASSERT(data);
+	ASSERT(_rows);
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+		.partial     = 1,
+	};
+
+	*_rows = 0;
+
+	texgz_tex_t* tex = texgz_jpeg_importdp(size, data, &param);
+	if(tex)
+	{
+		*_rows = param.rows;
+	}
+
+	return tex;
+}
+
+texgz_tex_t*
+texgz_jpeg_importScaled(const char* fname, int format,
+                        int scale_num, int scale_denom)
+{
+	ASSERT(fname);
+
+	if(texgz_jpeg_checkScale(scale_num, scale_denom) == 0)
+	{
+		return NULL;
+	}
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = scale_num,
+		.scale_denom = scale_denom,
+	};
+
+	return texgz_jpeg_importfnp(fname, &param);
+}
+
+texgz_tex_t*
+texgz_jpeg_importScaledf(FILE* f, int format,
+                         int scale_num, int scale_denom)
+{
+	ASSERT(f);
+
+	if(texgz_jpeg_checkScale(scale_num, scale_denom) == 0)
+	{
+		return NULL;
+	}
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = scale_num,
+		.scale_denom = scale_denom,
+	};
+
+	return texgz_jpeg_importfp(f, &param);
+}
+
+texgz_tex_t*
+texgz_jpeg_importScaledd(size_t size, const void* data,
+                         int format,
+                         int scale_num, int scale_denom)
+{
+	ASSERT(data);
+
+	if(texgz_jpeg_checkScale(scale_num, scale_denom) == 0)
+	{
+		return NULL;
+	}
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = scale_num,
+		.scale_denom = scale_denom,
+	};
+
+	return texgz_jpeg_importdp(size, data, &param);
+}
+
+texgz_tex_t*
+texgz_jpeg_importRegion(const char* fname, int format,
+                        int x, int y, int w, int h)
+{
+	ASSERT(fname);
 
-	// adjust pixels for RGBA
-	if(format == TEXGZ_RGBA)
+	if(texgz_jpeg_checkSize(w, h) == 0)
 	{
-		texgz_jpeg_rgb2rgba(tex);
+		return NULL;
 	}
 
-	// success
-	return tex;
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+		.region_x    = x,
+		.region_y    = y,
+		.region_w    = w,
+		.region_h    = h,
+	};
 
-	// failure
-	fail_scanline:
-		texgz_tex_delete(&tex);
-	fail_tex:
-	fail_format:
-		jpeg_finish_decompress(cinfo);
-	return NULL;
+	return texgz_jpeg_importfnp(fname, &param);
 }
 
-/***********************************************************
-* public                                                   *
-***********************************************************/
-
 texgz_tex_t*
-texgz_jpeg_import(const char* fname, int format)
+texgz_jpeg_importRegiond(size_t size, const void* data,
+                         int format,
+                         int x, int y, int w, int h)
 {
-	ASSERT(fname);
-	ASSERT((format == TEXGZ_RGB) ||
-	       (format == TEXGZ_RGBA));
+	ASSERT(data);
 
-	FILE *f = fopen(fname, "r");
-	if(f == NULL)
+	if(texgz_jpeg_checkSize(w, h) == 0)
 	{
-		LOGE("fopen failed for %s", fname);
 		return NULL;
 	}
 
-	texgz_tex_t* tex = texgz_jpeg_importf(f, format);
-	if(tex == NULL)
+	texgz_jpegParam_t param =
 	{
-		goto fail_tex;
-	}
-
-	fclose(f);
-
-	// success
-	return tex;
+		.format      = format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+		.region_x    = x,
+		.region_y    = y,
+		.region_w    = w,
+		.region_h    = h,
+	};
 
-	// failure
-	fail_tex:
-		fclose(f);
-	return NULL;
+	return texgz_jpeg_importdp(size, data, &param);
 }
 
-texgz_tex_t* texgz_jpeg_importf(FILE* f, int format)
+texgz_tex_t*
+texgz_jpeg_importResized(const char* fname, int format,
+                         int width, int height)
 {
-	ASSERT(f);
-
-	// create file decompressor
-	struct jpeg_decompress_struct cinfo;
-	struct jpeg_error_mgr jerr;
-	cinfo.err = jpeg_std_error(&jerr);
-	jpeg_create_decompress(&cinfo);
-	jpeg_stdio_src(&cinfo, f);
+	ASSERT(fname);
 
-	texgz_tex_t* self;
-	self = texgz_jpeg_importj(&cinfo, format);
-	if(self == NULL)
+	if(texgz_jpeg_checkSize(width, height) == 0)
 	{
-		goto fail_import;
+		return NULL;
 	}
 
-	jpeg_destroy_decompress(&cinfo);
-
-	// success
-	return self;
+	texgz_jpegParam_t param =
+	{
+		.format = format,
+		.width  = width,
+		.height = height,
+	};
 
-	// failure
-	fail_import:
-		jpeg_destroy_decompress(&cinfo);
-	return NULL;
+	return texgz_jpeg_importfnp(fname, &param);
 }
 
 texgz_tex_t*
-texgz_jpeg_importd(size_t size, const void* data,
-                   int format)
+texgz_jpeg_importResizedd(size_t size, const void* data,
+                          int format,
+                          int width, int height)
 {
 	ASSERT(data);
 
-	// create memory decompressor
-	struct jpeg_decompress_struct cinfo;
-	struct jpeg_error_mgr jerr;
-	cinfo.err = jpeg_std_error(&jerr);
-	jpeg_create_decompress(&cinfo);
-	jpeg_mem_src(&cinfo, data, size);
-
-	texgz_tex_t* self;
-	self = texgz_jpeg_importj(&cinfo, format);
-	if(self == NULL)
+	if(texgz_jpeg_checkSize(width, height) == 0)
 	{
-		goto fail_import;
+		return NULL;
 	}
 
-	jpeg_destroy_decompress(&cinfo);
+	texgz_jpegParam_t param =
+	{
+		.format = format,
+		.width  = width,
+		.height = height,
+	};
 
-	// success
-	return self;
+	return texgz_jpeg_importdp(size, data, &param);
+}
 
-	// failure
-	fail_import:
-		jpeg_destroy_decompress(&cinfo);
-	return NULL;
+void texgz_jpeg_defaultOptions(texgz_jpegOptions_t* opt)
+{
+	ASSERT(opt);
+
+	// matches jpeg_set_defaults
+	opt->quality     = 75;
+	opt->subsample   = TEXGZ_JPEG_SUBSAMPLE_420;
+	opt->dct         = TEXGZ_JPEG_DCT_ISLOW;
+	opt->optimize    = 0;
+	opt->progressive = 0;
 }
 
 int texgz_jpeg_export(texgz_tex_t* self, const char* fname)
@@ -246,27 +1285,32 @@ int texgz_jpeg_export(texgz_tex_t* self, const char* fname)
 	ASSERT(self);
 	ASSERT(fname);
 
-	// convert to RGB888 and crop
-	int delete_tex = 0;
-	texgz_tex_t* tex = self;
-	if((tex->type   != TEXGZ_UNSIGNED_BYTE) ||
-	   (tex->format != TEXGZ_RGB)           ||
-	   (tex->width  != tex->stride)         ||
-	   (tex->height != tex->vstride))
+	return texgz_jpeg_exportOptions(self, fname, NULL);
+}
+
+int texgz_jpeg_exportOptions(texgz_tex_t* self,
+                             const char* fname,
+                             const texgz_jpegOptions_t* opt)
+{
+	ASSERT(self);
+	ASSERT(fname);
+
+	texgz_jpegOptions_t defaults;
+	if(opt == NULL)
 	{
-		tex = texgz_tex_convertcopy(self, TEXGZ_UNSIGNED_BYTE,
-		                            TEXGZ_RGB);
-		if(tex == NULL)
-		{
-			return 0;
-		}
-		delete_tex = 1;
+		texgz_jpeg_defaultOptions(&defaults);
+		opt = &defaults;
+	}
 
-		if(texgz_tex_crop(tex, 0, 0, tex->height - 1,
-		                  tex->width - 1) == 0)
-		{
-			goto fail_tex;
-		}
+	if(texgz_jpeg_checkOptions(opt) == 0)
+	{
+		return 0;
+	}
+
+	texgz_tex_t* tex = texgz_jpeg_exportTex(self);
+	if(tex == NULL)
+	{
+		return 0;
 	}
 
 	FILE* f = fopen(fname, "w");
@@ -277,33 +1321,19 @@ int texgz_jpeg_export(texgz_tex_t* self, const char* fname)
 	}
 
 	struct jpeg_compress_struct cinfo;
-	struct jpeg_error_mgr jerr;
-	cinfo.err = jpeg_std_error(&jerr);
+	texgz_jpegError_t jerr;
+	cinfo.err = texgz_jpegError_init(&jerr);
 	jpeg_create_compress(&cinfo);
 	jpeg_stdio_dest(&cinfo, f);
 
-	cinfo.image_width      = tex->width;
-	cinfo.image_height     = tex->height;
-	cinfo.input_components = 3;
-	cinfo.in_color_space   = JCS_RGB;
-	jpeg_set_defaults(&cinfo);
-	jpeg_start_compress(&cinfo, TRUE);
-
-	unsigned char* pixels = tex->pixels;
-	int stride_bytes = cinfo.image_width*cinfo.num_components;
-	while(cinfo.next_scanline < cinfo.image_height)
+	if(texgz_jpeg_exportj(&cinfo, tex, opt) == 0)
 	{
-		if(jpeg_write_scanlines(&cinfo, &pixels, 1) != 1)
-		{
-			LOGE("jpeg_write_scanlines failed");
-			goto fail_scanline;
-		}
-		pixels += stride_bytes;
+		goto fail_export;
 	}
-	jpeg_finish_compress(&cinfo);
+
 	jpeg_destroy_compress(&cinfo);
 	fclose(f);
-	if(delete_tex)
+	if(tex != self)
 	{
 		texgz_tex_delete(&tex);
 	}
@@ -312,13 +1342,11 @@ int texgz_jpeg_export(texgz_tex_t* self, const char* fname)
 	return 1;
 
 	// failure
-	fail_scanline:
-		jpeg_finish_compress(&cinfo);
+	fail_export:
 		jpeg_destroy_compress(&cinfo);
 		fclose(f);
 	fail_open:
-	fail_tex:
-		if(delete_tex)
+		if(tex != self)
 		{
 			texgz_tex_delete(&tex);
 		}
@@ -332,77 +1360,333 @@ int texgz_jpeg_compress(texgz_tex_t* self,
 	ASSERT(_data);
 	ASSERT(_size);
 
-	// convert to RGB888 and crop
-	int delete_tex = 0;
-	texgz_tex_t* tex = self;
-	if((tex->type   != TEXGZ_UNSIGNED_BYTE) ||
-	   (tex->format != TEXGZ_RGB)           ||
-	   (tex->width  != tex->stride)         ||
-	   (tex->height != tex->vstride))
+	return texgz_jpeg_compressOptions(self, _data, _size, NULL);
+}
+
+int texgz_jpeg_compressOptions(texgz_tex_t* self,
+                               void** _data, size_t* _size,
+                               const texgz_jpegOptions_t* opt)
+{
+	ASSERT(self);
+	ASSERT(_data);
+	ASSERT(_size);
+
+	texgz_jpegOptions_t defaults;
+	if(opt == NULL)
 	{
-		tex = texgz_tex_convertcopy(self, TEXGZ_UNSIGNED_BYTE,
-		                            TEXGZ_RGB);
-		if(tex == NULL)
-		{
-			return 0;
-		}
-		delete_tex = 1;
+		texgz_jpeg_defaultOptions(&defaults);
+		opt = &defaults;
+	}
 
-		if(texgz_tex_crop(tex, 0, 0, tex->height - 1,
-		                  tex->width - 1) == 0)
-		{
-			goto fail_tex;
-		}
+	if(texgz_jpeg_checkOptions(opt) == 0)
+	{
+		return 0;
 	}
 
-	unsigned char* data = NULL;
-	size_t         size = 0;
-	struct jpeg_compress_struct cinfo;
-	struct jpeg_error_mgr jerr;
-	cinfo.err = jpeg_std_error(&jerr);
-	jpeg_create_compress(&cinfo);
-	jpeg_mem_dest(&cinfo, &data, &size);
+	texgz_tex_t* tex = texgz_jpeg_exportTex(self);
+	if(tex == NULL)
+	{
+		return 0;
+	}
 
-	cinfo.image_width      = tex->width;
-	cinfo.image_height     = tex->height;
-	cinfo.input_components = 3;
-	cinfo.in_color_space   = JCS_RGB;
-	jpeg_set_defaults(&cinfo);
-	jpeg_start_compress(&cinfo, TRUE);
+	// the output buffer is grown by texgz_jpegDest_t rather
+	// than jpeg_mem_dest since libjpeg does not free the
+	// buffers allocated by jpeg_mem_dest after an error
+	// _data is allocated by C malloc as for jpeg_mem_dest
+	size_t         capacity = 4096 + tex->width*tex->height/4;
+	unsigned char* data;
+	data = (unsigned char*) malloc(capacity);
+	if(data == NULL)
+	{
+		LOGE("malloc failed");
+		goto fail_data;
+	}
 
-	unsigned char* pixels = tex->pixels;
-	int stride_bytes = cinfo.image_width*cinfo.num_components;
-	while(cinfo.next_scanline < cinfo.image_height)
+	struct jpeg_compress_struct cinfo;
+	texgz_jpegError_t jerr;
+	texgz_jpegDest_t  dest =
 	{
-		if(jpeg_write_scanlines(&cinfo, &pixels, 1) != 1)
+		.pub =
 		{
-			LOGE("jpeg_write_scanlines failed");
-			goto fail_scanline;
-		}
-		pixels += stride_bytes;
+			.init_destination    = texgz_jpegDest_init,
+			.empty_output_buffer = texgz_jpegDest_empty,
+			.term_destination    = texgz_jpegDest_term,
+		},
+		.cmalloc   = 1,
+		._data     = &data,
+		._capacity = &capacity,
+	};
+	cinfo.err = texgz_jpegError_init(&jerr);
+	jpeg_create_compress(&cinfo);
+	cinfo.dest = &dest.pub;
+
+	if(texgz_jpeg_exportj(&cinfo, tex, opt) == 0)
+	{
+		goto fail_export;
 	}
-	jpeg_finish_compress(&cinfo);
+
+	// the destination manager is not owned by libjpeg
+	cinfo.dest = NULL;
 	jpeg_destroy_compress(&cinfo);
-	if(delete_tex)
+	if(tex != self)
 	{
 		texgz_tex_delete(&tex);
 	}
 
 	*_data = (void*) data;
-	*_size = size;
+	*_size = dest.size;
 
 	// sucess
 	return 1;
 
 	// failure
-	fail_scanline:
-		jpeg_finish_compress(&cinfo);
+	fail_export:
+		cinfo.dest = NULL;
 		jpeg_destroy_compress(&cinfo);
 		free(data);
-	fail_tex:
-		if(delete_tex)
+	fail_data:
+		if(tex != self)
 		{
 			texgz_tex_delete(&tex);
 		}
 	return 0;
 }
+
+texgz_jpegDecoder_t* texgz_jpegDecoder_new(void)
+{
+	texgz_jpegDecoder_t* self;
+	self = (texgz_jpegDecoder_t*)
+	       CALLOC(1, sizeof(texgz_jpegDecoder_t));
+	if(self == NULL)
+	{
+		LOGE("CALLOC failed");
+		return NULL;
+	}
+
+	self->cinfo.err = texgz_jpegError_init(&self->jerr);
+	jpeg_create_decompress(&self->cinfo);
+
+	return self;
+}
+
+void texgz_jpegDecoder_delete(texgz_jpegDecoder_t** _self)
+{
+	ASSERT(_self);
+
+	texgz_jpegDecoder_t* self = *_self;
+	if(self)
+	{
+		jpeg_destroy_decompress(&self->cinfo);
+		FREE(self);
+		*_self = NULL;
+	}
+}
+
+texgz_tex_t*
+texgz_jpegDecoder_importd(texgz_jpegDecoder_t* self,
+                          size_t size, const void* data,
+                          int format)
+{
+	ASSERT(self);
+	ASSERT(data);
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+	};
+
+	// the memory source manager is reused
+	if(texgz_jpeg_memSrc(&self->cinfo, size, data) == 0)
+	{
+		return NULL;
+	}
+
+	return texgz_jpeg_importj(&self->cinfo, &param);
+}
+
+int texgz_jpegDecoder_decoded(texgz_jpegDecoder_t* self,
+                              size_t size, const void* data,
+                              texgz_tex_t* dst)
+{
+	ASSERT(self);
+	ASSERT(data);
+	ASSERT(dst);
+
+	if((dst->type != TEXGZ_UNSIGNED_BYTE) ||
+	   ((dst->format != TEXGZ_RGB)  &&
+	    (dst->format != TEXGZ_RGBA) &&
+	    (dst->format != TEXGZ_BGRA) &&
+	    (dst->format != TEXGZ_LUMINANCE)))
+	{
+		LOGE("invalid type=0x%X, format=0x%X",
+		     dst->type, dst->format);
+		return 0;
+	}
+
+	texgz_jpegParam_t param =
+	{
+		.format      = dst->format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+		.dst         = dst,
+	};
+
+	if(texgz_jpeg_memSrc(&self->cinfo, size, data) == 0)
+	{
+		return 0;
+	}
+
+	if(texgz_jpeg_importj(&self->cinfo, &param) == NULL)
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+texgz_tex_t*
+texgz_jpegDecoder_importRegiond(texgz_jpegDecoder_t* self,
+                                size_t size,
+                                const void* data,
+                                int format,
+                                int x, int y,
+                                int w, int h)
+{
+	ASSERT(self);
+	ASSERT(data);
+
+	if(texgz_jpeg_checkSize(w, h) == 0)
+	{
+		return NULL;
+	}
+
+	texgz_jpegParam_t param =
+	{
+		.format      = format,
+		.scale_num   = 1,
+		.scale_denom = 1,
+		.region_x    = x,
+		.region_y    = y,
+		.region_w    = w,
+		.region_h    = h,
+	};
+
+	if(texgz_jpeg_memSrc(&self->cinfo, size, data) == 0)
+	{
+		return NULL;
+	}
+
+	return texgz_jpeg_importj(&self->cinfo, &param);
+}
+
+texgz_jpegEncoder_t* texgz_jpegEncoder_new(void)
+{
+	texgz_jpegEncoder_t* self;
+	self = (texgz_jpegEncoder_t*)
+	       CALLOC(1, sizeof(texgz_jpegEncoder_t));
+	if(self == NULL)
+	{
+		LOGE("CALLOC failed");
+		return NULL;
+	}
+
+	self->cinfo.err = texgz_jpegError_init(&self->jerr);
+	jpeg_create_compress(&self->cinfo);
+
+	self->dest.pub.init_destination    = texgz_jpegDest_init;
+	self->dest.pub.empty_output_buffer = texgz_jpegDest_empty;
+	self->dest.pub.term_destination    = texgz_jpegDest_term;
+	self->cinfo.dest = &self->dest.pub;
+
+	return self;
+}
+
+void texgz_jpegEncoder_delete(texgz_jpegEncoder_t** _self)
+{
+	ASSERT(_self);
+
+	texgz_jpegEncoder_t* self = *_self;
+	if(self)
+	{
+		// the destination manager is not owned by libjpeg
+		self->cinfo.dest = NULL;
+		jpeg_destroy_compress(&self->cinfo);
+		FREE(self);
+		*_self = NULL;
+	}
+}
+
+int texgz_jpegEncoder_compress(texgz_jpegEncoder_t* self,
+                               texgz_tex_t* tex,
+                               const texgz_jpegOptions_t* opt,
+                               void** _data,
+                               size_t* _capacity,
+                               size_t* _size)
+{
+	ASSERT(self);
+	ASSERT(tex);
+	ASSERT(_data);
+	ASSERT(_capacity);
+	ASSERT(_size);
+
+	texgz_jpegOptions_t defaults;
+	if(opt == NULL)
+	{
+		texgz_jpeg_defaultOptions(&defaults);
+		opt = &defaults;
+	}
+
+	if(texgz_jpeg_checkOptions(opt) == 0)
+	{
+		return 0;
+	}
+
+	// allocate the output buffer when not provided
+	if((*_data == NULL) || (*_capacity == 0))
+	{
+		size_t capacity = 4096 + tex->width*tex->height/4;
+
+		void* data = REALLOC(*_data, capacity);
+		if(data == NULL)
+		{
+			LOGE("REALLOC failed");
+			return 0;
+		}
+
+		*_data     = data;
+		*_capacity = capacity;
+	}
+
+	texgz_tex_t* src = texgz_jpeg_exportTex(tex);
+	if(src == NULL)
+	{
+		return 0;
+	}
+
+	self->dest._data     = (unsigned char**) _data;
+	self->dest._capacity = _capacity;
+	if(texgz_jpeg_exportj(&self->cinfo, src, opt) == 0)
+	{
+		goto fail_export;
+	}
+
+	if(src != tex)
+	{
+		texgz_tex_delete(&src);
+	}
+
+	*_size = self->dest.size;
+
+	// success
+	return 1;
+
+	// failure
+	fail_export:
+		if(src != tex)
+		{
+			texgz_tex_delete(&src);
+		}
+	return 0;
+}
@@ -27,16 +27,144 @@
 #include "texgz_tex.h"
 #include <stdio.h>
 
+// encoder chroma subsampling
+#define TEXGZ_JPEG_SUBSAMPLE_420 0
+#define TEXGZ_JPEG_SUBSAMPLE_444 1
+
+// encoder DCT method
+// IFAST is faster but less accurate than ISLOW
+#define TEXGZ_JPEG_DCT_ISLOW 0
+#define TEXGZ_JPEG_DCT_IFAST 1
+
+// encoder options
+// quality: 1 to 100
+// optimize: optimized Huffman tables (smaller but slower)
+// progressive: progressive mode (implies optimize)
+typedef struct
+{
+	int quality;
+	int subsample;
+	int dct;
+	int optimize;
+	int progressive;
+} texgz_jpegOptions_t;
+
+// the format may be RGB, RGBA, BGRA or LUMINANCE where
+// grayscale and color jpegs are converted by libjpeg
+// and libjpeg errors are logged and return NULL/0
 texgz_tex_t* texgz_jpeg_import(const char* fname,
                                int format);
 texgz_tex_t* texgz_jpeg_importf(FILE* f, int format);
 texgz_tex_t* texgz_jpeg_importd(size_t size,
                                 const void* data,
                                 int format);
+
+// decode as much as possible of a truncated or corrupt
+// jpeg where rows is the number of scanlines decoded
+// before the error or end of data (the remaining
+// scanlines are undefined)
+texgz_tex_t* texgz_jpeg_importPartial(const char* fname,
+                                      int format,
+                                      int* _rows);
+texgz_tex_t* texgz_jpeg_importPartiald(size_t size,
+                                       const void* data,
+                                       int format,
+                                       int* _rows);
+
+// decode using the libjpeg IDCT scaling where the output
+// size is ceil(image_size*scale_num/scale_denom) and the
+// scale is rounded up to a supported scale by libjpeg
+// (e.g. 1/2, 1/4 and 1/8 skip most of the decoding work)
+texgz_tex_t* texgz_jpeg_importScaled(const char* fname,
+                                     int format,
+                                     int scale_num,
+                                     int scale_denom);
+texgz_tex_t* texgz_jpeg_importScaledf(FILE* f, int format,
+                                      int scale_num,
+                                      int scale_denom);
+texgz_tex_t* texgz_jpeg_importScaledd(size_t size,
+                                      const void* data,
+                                      int format,
+                                      int scale_num,
+                                      int scale_denom);
+
+// decode the w x h region at (x,y) where only the iMCU
+// columns/rows which overlap the region are fully decoded
+// when supported by libjpeg-turbo
+texgz_tex_t* texgz_jpeg_importRegion(const char* fname,
+                                     int format,
+                                     int x, int y,
+                                     int w, int h);
+texgz_tex_t* texgz_jpeg_importRegiond(size_t size,
+                                      const void* data,
+                                      int format,
+                                      int x, int y,
+                                      int w, int h);
+
+// decode to width x height using the smallest IDCT scale
+// which covers the requested size and resample the
+// remainder (lanczos3 for power-of-two decimation and
+// otherwise bilinear)
+texgz_tex_t* texgz_jpeg_importResized(const char* fname,
+                                      int format,
+                                      int width, int height);
+texgz_tex_t* texgz_jpeg_importResizedd(size_t size,
+                                       const void* data,
+                                       int format,
+                                       int width, int height);
+
+// RGB, LUMINANCE and RGBA/BGRA (libjpeg-turbo) textures are
+// compressed directly and otherwise converted to RGB where
+// opt may be NULL for the defaults and the compressed data
+// is allocated by C malloc and must be freed with free
+void         texgz_jpeg_defaultOptions(texgz_jpegOptions_t* opt);
 int          texgz_jpeg_export(texgz_tex_t* self,
                                const char* fname);
+int          texgz_jpeg_exportOptions(texgz_tex_t* self,
+                                      const char* fname,
+                                      const texgz_jpegOptions_t* opt);
 int          texgz_jpeg_compress(texgz_tex_t* self,
                                  void** _data,
                                  size_t* _size);
+int          texgz_jpeg_compressOptions(texgz_tex_t* self,
+                                        void** _data,
+                                        size_t* _size,
+                                        const texgz_jpegOptions_t* opt);
+
+// reusable decoder/encoder which avoid creating the libjpeg
+// state for each image (e.g. to decode/encode many tiles)
+// where decoded reuses a dst texture whose size must match
+// the image and whose format selects the output format
+typedef struct texgz_jpegDecoder_s texgz_jpegDecoder_t;
+typedef struct texgz_jpegEncoder_s texgz_jpegEncoder_t;
+
+texgz_jpegDecoder_t* texgz_jpegDecoder_new(void);
+void                 texgz_jpegDecoder_delete(texgz_jpegDecoder_t** _self);
+texgz_tex_t*         texgz_jpegDecoder_importd(texgz_jpegDecoder_t* self,
+                                               size_t size,
+                                               const void* data,
+                                               int format);
+int                  texgz_jpegDecoder_decoded(texgz_jpegDecoder_t* self,
+                                               size_t size,
+                                               const void* data,
+                                               texgz_tex_t* dst);
+texgz_tex_t*         texgz_jpegDecoder_importRegiond(texgz_jpegDecoder_t* self,
+                                                     size_t size,
+                                                     const void* data,
+                                                     int format,
+                                                     int x, int y,
+                                                     int w, int h);
+
+// the output buffer (data, capacity) is provided by the
+// caller and grown as required where the data may be NULL
+// and must be freed with FREE
+texgz_jpegEncoder_t* texgz_jpegEncoder_new(void);
+void                 texgz_jpegEncoder_delete(texgz_jpegEncoder_t** _self);
+int                  texgz_jpegEncoder_compress(texgz_jpegEncoder_t* self,
+                                                texgz_tex_t* tex,
+                                                const texgz_jpegOptions_t* opt,
+                                                void** _data,
+                                                size_t* _capacity,
+                                                size_t* _size);
 
 #endif
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2026 Jeff Boody
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_TAG "texgz"
+#include "../libcc/cc_log.h"
+#include "../libcc/cc_memory.h"
+#include "texgz_sat.h"
+
+/***********************************************************
+* private                                                  *
+***********************************************************/
+
+static void
+texgz_sat_row(texgz_tex_t* tex, int y, double* row)
+{
+	ASSERT(tex);
+	ASSERT(row);
+
+	// convert the row to doubles in the range 0.0 to 1.0
+	// where the offsets are size_t for large textures
+	int    x;
+	int    n   = 4*tex->width;
+	size_t idx = 4*((size_t) y)*((size_t) tex->stride);
+	if(tex->type == TEXGZ_FLOAT)
+	{
+		float* pixels = (float*) tex->pixels;
+		float* src    = &pixels[idx];
+		for(x = 0; x < n; ++x)
+		{
+			row[x] = (double) src[x];
+		}
+	}
+	else
+	{
+		unsigned char* src = &tex->pixels[idx];
+		for(x = 0; x < n; ++x)
+		{
+			row[x] = ((double) src[x])/255.0;
+		}
+	}
+}
+
+/***********************************************************
+* public                                                   *
+***********************************************************/
+
+texgz_sat_t* texgz_sat_new(texgz_tex_t* tex)
+{
+	ASSERT(tex);
+
+	if(((tex->type == TEXGZ_FLOAT) ||
+	    (tex->type == TEXGZ_UNSIGNED_BYTE)) &&
+	   (tex->format == TEXGZ_RGBA))
+	{
+		// ok
+	}
+	else
+	{
+		LOGE("invalid type=0x%X, format=0x%X",
+		     tex->type, tex->format);
+		return NULL;
+	}
+
+	texgz_sat_t* self;
+	self = (texgz_sat_t*) CALLOC(1, sizeof(texgz_sat_t));
+	if(self == NULL)
+	{
+		LOGE("CALLOC failed");
+		return NULL;
+	}
+
+	self->width  = tex->width;
+	self->height = tex->height;
+
+	int    w1    = tex->width + 1;
+	int    h1    = tex->height + 1;
+	size_t count = 4*((size_t) w1)*((size_t) h1);
+	self->sum1 = (double*) CALLOC(count, sizeof(double));
+	if(self->sum1 == NULL)
+	{
+		LOGE("CALLOC failed");
+		goto fail_sum1;
+	}
+
+	self->sum2 = (double*) CALLOC(count, sizeof(double));
+	if(self->sum2 == NULL)
+	{
+		LOGE("CALLOC failed");
+		goto fail_sum2;
+	}
+
+	double* row;
+	row = (double*) CALLOC(4*tex->width, sizeof(double));
+	if(row == NULL)
+	{
+		LOGE("CALLOC failed");
+		goto fail_row;
+	}
+
+	// sat(x, y) = row(x, y) + sat(x, y - 1)
+	// where row(x, y) is the running sum of the row and the
+	// indices are size_t since 4*w1*h1 may exceed INT_MAX
+	int       x;
+	int       y;
+	int       c;
+	size_t    i;
+	ptrdiff_t up = -4*((ptrdiff_t) w1);
+	double    r1[4];
+	double    r2[4];
+	double*   p;
+	double*   s1;
+	double*   s2;
+	for(y = 0; y < tex->height; ++y)
+	{
+		texgz_sat_row(tex, y, row);
+
+		r1[0] = 0.0;
+		r1[1] = 0.0;
+		r1[2] = 0.0;
+		r1[3] = 0.0;
+		r2[0] = 0.0;
+		r2[1] = 0.0;
+		r2[2] = 0.0;
+		r2[3] = 0.0;
+		for(x = 0; x < tex->width; ++x)
+		{
+			i  = 4*(((size_t) (y + 1))*((size_t) w1) + x + 1);
+			p  = &row[4*x];
+			s1 = &self->sum1[i];
+			s2 = &self->sum2[i];
+			for(c = 0; c < 4; ++c)
+			{
+				r1[c] += p[c];
+				r2[c] += p[c]*p[c];
+				s1[c]  = r1[c] + s1[up + c];
+				s2[c]  = r2[c] + s2[up + c];
+			}
+		}
+	}
+
+	FREE(row);
+
+	// success
+	return self;
+
+	// failure
+	fail_row:
+		FREE(self->sum2);
+	fail_sum2:
+		FREE(self->sum1);
+	fail_sum1:
+		FREE(self);
+	return NULL;
+}
+
+void texgz_sat_delete(texgz_sat_t** _self)
+{
+	ASSERT(_self);
+
+	texgz_sat_t* self = *_self;
+	if(self)
+	{
+		FREE(self->sum2);
+		FREE(self->sum1);
+		FREE(self);
+		*_self = NULL;
+	}
+}
+
+int texgz_sat_sum(texgz_sat_t* self,
+                  int x, int y, int w, int h,
+                  double* sum1, double* sum2)
+{
+	ASSERT(self);
+	ASSERT(sum1);
+
+	// sum2 is optional
+
+	// clip the box to the image
+	int x0 = x;
+	int y0 = y;
+	int x1 = x + w;
+	int y1 = y + h;
+	if(x0 < 0)
+	{
+		x0 = 0;
+	}
+	if(y0 < 0)
+	{
+		y0 = 0;
+	}
+	if(x1 > self->width)
+	{
+		x1 = self->width;
+	}
+	if(y1 > self->height)
+	{
+		y1 = self->height;
+	}
+
+	int c;
+	if((x0 >= x1) || (y0 >= y1))
+	{
+		for(c = 0; c < 4; ++c)
+		{
+			sum1[c] = 0.0;
+			if(sum2)
+			{
+				sum2[c] = 0.0;
+			}
+		}
+		return 0;
+	}
+
+	// sum = D - B - C + A
+	// A--B
+	// |  |
+	// C--D
+	// the corners are size_t since 4*w1*h1 may exceed
+	// INT_MAX
+	size_t w1 = self->width + 1;
+	size_t a  = 4*(((size_t) y0)*w1 + x0);
+	size_t b  = 4*(((size_t) y0)*w1 + x1);
+	size_t cc = 4*(((size_t) y1)*w1 + x0);
+	size_t d  = 4*(((size_t) y1)*w1 + x1);
+	for(c = 0; c < 4; ++c)
+	{
+		sum1[c] = self->sum1[d + c] - self->sum1[b + c] -
+		          self->sum1[cc + c] + self->sum1[a + c];
+		if(sum2)
+		{
+			sum2[c] = self->sum2[d + c] - self->sum2[b + c] -
+			          self->sum2[cc + c] + self->sum2[a + c];
+		}
+	}
+
+	// return the number of samples
+	return (x1 - x0)*(y1 - y0);
+}
+
+void texgz_sat_mean(texgz_sat_t* self,
+                    int x, int y, int w, int h,
+                    float* mean)
+{
+	ASSERT(self);
+	ASSERT(mean);
+
+	double sum1[4];
+	int    n = texgz_sat_sum(self, x, y, w, h, sum1, NULL);
+
+	int c;
+	for(c = 0; c < 4; ++c)
+	{
+		mean[c] = n ? (float) (sum1[c]/n) : 0.0f;
+	}
+}
+
+void texgz_sat_stddev(texgz_sat_t* self,
+                      int x, int y, int w, int h,
+                      float* mean, float* stddev)
+{
+	ASSERT(self);
+	ASSERT(mean);
+	ASSERT(stddev);
+
+	double sum1[4];
+	double sum2[4];
+	int    n = texgz_sat_sum(self, x, y, w, h, sum1, sum2);
+
+	// stddev = sqrt(E[x^2] - E[x]^2)
+	// https://en.wikipedia.org/wiki/Standard_deviation
+	int    c;
+	double mu;
+	double var;
+	for(c = 0; c < 4; ++c)
+	{
+		if(n == 0)
+		{
+			mean[c]   = 0.0f;
+			stddev[c] = 0.0f;
+			continue;
+		}
+
+		mu  = sum1[c]/n;
+		var = sum2[c]/n - mu*mu;
+		if(var < 0.0)
+		{
+			// round-off error
+			var = 0.0;
+		}
+
+		mean[c]   = (float) mu;
+		stddev[c] = (float) sqrt(var);
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Jeff Boody
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef texgz_sat_H
+#define texgz_sat_H
+
+#include "texgz_tex.h"
+
+// summed-area table (integral image)
+// the sums of x and x^2 are stored for each RGBA channel
+// with an extra zero row/column so that box sums
+// may be evaluated in O(1) with four lookups
+// the sums are stored as doubles to preserve precision
+// for large images (64 bytes per pixel)
+typedef struct
+{
+	int width;
+	int height;
+
+	// (width + 1)x(height + 1)x4
+	double* sum1;
+	double* sum2;
+} texgz_sat_t;
+
+texgz_sat_t* texgz_sat_new(texgz_tex_t* tex);
+void         texgz_sat_delete(texgz_sat_t** _self);
+int          texgz_sat_sum(texgz_sat_t* self,
+                           int x, int y, int w, int h,
+                           double* sum1, double* sum2);
+void         texgz_sat_mean(texgz_sat_t* self,
+                            int x, int y, int w, int h,
+                            float* mean);
+void         texgz_sat_stddev(texgz_sat_t* self,
+                              int x, int y, int w, int h,
+                              float* mean, float* stddev);
+
+#endif
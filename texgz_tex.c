@@ -22,11 +22,19 @@
  */
 
 #include <math.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <zlib.h>
 
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
 #define LOG_TAG "texgz"
 #include "../libcc/math/cc_float.h"
 #include "../libcc/math/cc_pow2n.h"
@@ -34,10 +42,24 @@
 #include "../libcc/cc_memory.h"
 #include "../libcc/math/cc_float.h"
 #include "pil_lanczos.h"
+#include "texgz_inlier.h"
+#include "texgz_sat.h"
 #include "texgz_tex.h"
+#include "texgz_thread.h"
 
 #define TEXGZ_LANCZOS3_MAXSIZE 257
 
+// batch sampling block size and maximum filter taps
+#define TEXGZ_SAMPLE_BLOCK 64
+#define TEXGZ_SAMPLE_TAPS  6
+
+// lanczos3 weights for subpixel phases in the range
+// [0, TEXGZ_SAMPLE_PHASES]
+#define TEXGZ_SAMPLE_PHASES 256
+
+// remap tile size
+#define TEXGZ_REMAP_TILE 32
+
 /*
  * private - optimizations
  */
@@ -104,17 +126,40 @@ float TEXGZ_TEX_OUTLINE11[121] =
 	0.00f, 0.00f, 0.13f, 0.63f, 0.88f, 1.00f, 0.88f, 0.63f, 0.13f, 0.00f, 0.00f,
 };
 
-static void
-texgz_tex_sampleOutline(texgz_tex_t* self, int i, int j,
-                        float* mask, int size)
+#define TEXGZ_OUTLINE_TILE 64
+
+typedef struct
+{
+	int          width;
+	int          height;
+	int          size;
+	const float* mask;
+
+	// lum: padded 1-byte luminance plane (width x height)
+	// dst: LA texture which receives the alpha
+	const unsigned char* lum;
+	texgz_tex_t*         dst;
+
+	// sampled region (h2 x w2)
+	int w2;
+	int h2;
+} texgz_tex_outline_t;
+
+static unsigned char
+texgz_tex_sampleOutline(texgz_tex_outline_t* self,
+                        int i, int j)
 {
 	ASSERT(self);
-	ASSERT(mask);
+
+	const float*         mask = self->mask;
+	const unsigned char* lum  = self->lum;
 
 	// sample state
-	int           off = size/2;
-	float         max = 0.0f;
-	unsigned char val = 0;
+	int           size = self->size;
+	int           w    = self->width;
+	int           off  = size/2;
+	float         max  = 0.0f;
+	unsigned char val  = 0;
 	float         o;
 	float         f;
 	unsigned char v;
@@ -144,14 +189,16 @@ texgz_tex_sampleOutline(texgz_tex_t* self, int i, int j,
 	}
 
 	// determine the max sample
-	int idx;
+	// the sample order must be preserved since ties keep
+	// the first sample
 	int m;
 	for(m = m0 + 1; m < m1; ++m)
 	{
+		const unsigned char* row = &lum[(i + m - off)*w + j - off];
+
 		// left edge
-		idx = 2*((i + m - off)*self->stride + (j + n0 - off));
 		o = mask[m*size + n0];
-		v = self->pixels[idx];
+		v = row[n0];
 		f = o*((float) v);
 		if(f > max)
 		{
@@ -160,9 +207,8 @@ texgz_tex_sampleOutline(texgz_tex_t* self, int i, int j,
 		}
 
 		// right edge
-		idx = 2*((i + m - off)*self->stride + (j + n1 - off));
 		o = mask[m*size + n1];
-		v = self->pixels[idx];
+		v = row[n1];
 		f = o*((float) v);
 		if(f > max)
 		{
@@ -172,12 +218,13 @@ texgz_tex_sampleOutline(texgz_tex_t* self, int i, int j,
 	}
 
 	int n;
+	const unsigned char* top = &lum[(i + m0 - off)*w + j - off];
+	const unsigned char* bot = &lum[(i + m1 - off)*w + j - off];
 	for(n = n0; n <= n1; ++n)
 	{
 		// top edge
-		idx = 2*((i + m0 - off)*self->stride + (j + n - off));
 		o = mask[m0*size + n];
-		v = self->pixels[idx];
+		v = top[n];
 		f = o*((float) v);
 		if(f > max)
 		{
@@ -186,9 +233,8 @@ texgz_tex_sampleOutline(texgz_tex_t* self, int i, int j,
 		}
 
 		// bottom edge
-		idx = 2*((i + m1 - off)*self->stride + (j + n - off));
 		o = mask[m1*size + n];
-		v = self->pixels[idx];
+		v = bot[n];
 		f = o*((float) v);
 		if(f > max)
 		{
@@ -197,9 +243,52 @@ texgz_tex_sampleOutline(texgz_tex_t* self, int i, int j,
 		}
 	}
 
-	// store the outline sample
-	idx = 2*(i*self->stride + j);
-	self->pixels[idx + 1] = val;
+	return val;
+}
+
+static void
+texgz_tex_outlineTiles(void* priv, int tid, int t0, int t1)
+{
+	ASSERT(priv);
+
+	texgz_tex_outline_t* self = (texgz_tex_outline_t*) priv;
+
+	// tiles read the shared luminance plane which
+	// includes the off halo and write disjoint alpha
+	// samples
+	int            i;
+	int            j;
+	int            ti;
+	int            tj;
+	texgz_tex_t*   dst    = self->dst;
+	unsigned char* pixels = dst->pixels;
+	for(ti = t0*TEXGZ_OUTLINE_TILE; ti < t1*TEXGZ_OUTLINE_TILE;
+	    ti += TEXGZ_OUTLINE_TILE)
+	{
+		int i1 = ti + TEXGZ_OUTLINE_TILE;
+		if(i1 > self->h2)
+		{
+			i1 = self->h2;
+		}
+
+		for(tj = 0; tj < self->w2; tj += TEXGZ_OUTLINE_TILE)
+		{
+			int j1 = tj + TEXGZ_OUTLINE_TILE;
+			if(j1 > self->w2)
+			{
+				j1 = self->w2;
+			}
+
+			for(i = ti; i < i1; ++i)
+			{
+				unsigned char* row = &pixels[2*i*dst->stride];
+				for(j = tj; j < j1; ++j)
+				{
+					row[2*j + 1] = texgz_tex_sampleOutline(self, i, j);
+				}
+			}
+		}
+	}
 }
 
 /*
@@ -922,6 +1011,349 @@ static texgz_tex_t* texgz_tex_8888toL(texgz_tex_t* self)
 	return tex;
 }
 
+// LAB conversion modes
+#define TEXGZ_LAB_MODE_LABL   0
+#define TEXGZ_LAB_MODE_PLANAR 1
+#define TEXGZ_LAB_MODE_RGBA   2
+
+// the vector LAB conversion requires a float divide
+// which is not available on 32-bit ARM NEON
+#if defined(__SSE2__) || \
+    (defined(__ARM_NEON) && defined(__aarch64__))
+	#define TEXGZ_LAB_SIMD
+#endif
+
+typedef struct
+{
+	int          mode;
+	int          channels;
+	texgz_tex_t* src;
+
+	// TEXGZ_LAB_MODE_LABL/RGBA: dst[0]
+	// TEXGZ_LAB_MODE_PLANAR: dst[0-2] (L,a,b)
+	texgz_tex_t* dst[3];
+
+	// scratch: 3*width floats per thread
+	float* scratch;
+} texgz_tex_lab_t;
+
+static float          texgz_tex_srgbLut[256];
+static pthread_once_t texgz_tex_srgbOnce = PTHREAD_ONCE_INIT;
+
+static void texgz_tex_srgbLutInit(void)
+{
+	int i;
+	for(i = 0; i < 256; ++i)
+	{
+		float c = ((float) i)/255.0f;
+		texgz_tex_srgbLut[i] = (c > 0.04045f) ?
+		                       powf((c + 0.055f)/1.055f, 2.4f) :
+		                       c/12.92f;
+	}
+}
+
+// fast cube root for the LAB range of [0.008856, 1.1]
+// a bit hack estimate refined by two Newton iterations
+// has a max relative error of 1.8e-6 (2.2e-4 for L)
+static float texgz_tex_cbrtf(float x)
+{
+	union
+	{
+		float    f;
+		uint32_t i;
+	} u = { .f = x };
+
+	u.i = u.i/3 + 709921077;
+
+	float y = u.f;
+	y = (2.0f*y + x/(y*y))*(1.0f/3.0f);
+	y = (2.0f*y + x/(y*y))*(1.0f/3.0f);
+	return y;
+}
+
+static float texgz_tex_labf(float t)
+{
+	// evaluate both sides to keep the loops branch free
+	float c = texgz_tex_cbrtf((t > 0.008856f) ? t : 0.008856f);
+	float l = 7.787f*t + 16.0f/116.0f;
+	return (t > 0.008856f) ? c : l;
+}
+
+#ifdef TEXGZ_LAB_SIMD
+
+#if defined(__SSE2__)
+typedef __m128 texgz_tex_vec4f_t;
+#else
+typedef float32x4_t texgz_tex_vec4f_t;
+#endif
+
+// texgz_tex_cbrtf for 4 lanes where the integer divide by 3
+// is a multiply by 0xAAAAAAAB and a shift by 33
+static inline texgz_tex_vec4f_t
+texgz_tex_cbrtf4(texgz_tex_vec4f_t x)
+{
+	#if defined(__SSE2__)
+	__m128i i = _mm_castps_si128(x);
+	__m128i m = _mm_set1_epi32((int) 0xAAAAAAAB);
+	__m128i e = _mm_mul_epu32(i, m);
+	__m128i o = _mm_mul_epu32(_mm_srli_epi64(i, 32), m);
+	e = _mm_srli_epi64(e, 33);
+	o = _mm_srli_epi64(o, 33);
+	i = _mm_or_si128(e, _mm_slli_epi64(o, 32));
+	i = _mm_add_epi32(i, _mm_set1_epi32(709921077));
+
+	__m128 y  = _mm_castsi128_ps(i);
+	__m128 k2 = _mm_set1_ps(2.0f);
+	__m128 k3 = _mm_set1_ps(1.0f/3.0f);
+	y = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(k2, y),
+	                          _mm_div_ps(x, _mm_mul_ps(y, y))), k3);
+	y = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(k2, y),
+	                          _mm_div_ps(x, _mm_mul_ps(y, y))), k3);
+	return y;
+	#else
+	uint32x4_t i = vreinterpretq_u32_f32(x);
+	uint32x2_t m = vdup_n_u32(0xAAAAAAAB);
+	uint64x2_t e = vmull_u32(vget_low_u32(i), m);
+	uint64x2_t o = vmull_u32(vget_high_u32(i), m);
+	i = vcombine_u32(vmovn_u64(vshrq_n_u64(e, 33)),
+	                 vmovn_u64(vshrq_n_u64(o, 33)));
+	i = vaddq_u32(i, vdupq_n_u32(709921077));
+
+	float32x4_t y  = vreinterpretq_f32_u32(i);
+	float32x4_t k2 = vdupq_n_f32(2.0f);
+	float32x4_t k3 = vdupq_n_f32(1.0f/3.0f);
+	y = vmulq_f32(vaddq_f32(vmulq_f32(k2, y),
+	                        vdivq_f32(x, vmulq_f32(y, y))), k3);
+	y = vmulq_f32(vaddq_f32(vmulq_f32(k2, y),
+	                        vdivq_f32(x, vmulq_f32(y, y))), k3);
+	return y;
+	#endif
+}
+
+// texgz_tex_labf for 4 lanes
+static inline texgz_tex_vec4f_t
+texgz_tex_labf4(texgz_tex_vec4f_t t)
+{
+	#if defined(__SSE2__)
+	__m128 e = _mm_set1_ps(0.008856f);
+	__m128 m = _mm_cmpgt_ps(t, e);
+	__m128 c = texgz_tex_cbrtf4(_mm_or_ps(_mm_and_ps(m, t),
+	                                      _mm_andnot_ps(m, e)));
+	__m128 l = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(7.787f), t),
+	                      _mm_set1_ps(16.0f/116.0f));
+	return _mm_or_ps(_mm_and_ps(m, c), _mm_andnot_ps(m, l));
+	#else
+	float32x4_t e = vdupq_n_f32(0.008856f);
+	uint32x4_t  m = vcgtq_f32(t, e);
+	float32x4_t c = texgz_tex_cbrtf4(vbslq_f32(m, t, e));
+	float32x4_t l = vaddq_f32(vmulq_f32(vdupq_n_f32(7.787f), t),
+	                          vdupq_n_f32(16.0f/116.0f));
+	return vbslq_f32(m, c, l);
+	#endif
+}
+
+// convert 4 linear RGB pixels in place to LAB with the
+// same operations as the scalar loop
+static void
+texgz_tex_lab4(float* ll, float* la, float* lb)
+{
+	ASSERT(ll);
+	ASSERT(la);
+	ASSERT(lb);
+
+	#if defined(__SSE2__)
+	__m128 r  = _mm_loadu_ps(ll);
+	__m128 g  = _mm_loadu_ps(la);
+	__m128 b  = _mm_loadu_ps(lb);
+	__m128 xx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.4124f)),
+	                                  _mm_mul_ps(g, _mm_set1_ps(0.3576f))),
+	                       _mm_mul_ps(b, _mm_set1_ps(0.1805f)));
+	__m128 yy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.2126f)),
+	                                  _mm_mul_ps(g, _mm_set1_ps(0.7152f))),
+	                       _mm_mul_ps(b, _mm_set1_ps(0.0722f)));
+	__m128 zz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.0193f)),
+	                                  _mm_mul_ps(g, _mm_set1_ps(0.1192f))),
+	                       _mm_mul_ps(b, _mm_set1_ps(0.9505f)));
+	xx = texgz_tex_labf4(_mm_div_ps(xx, _mm_set1_ps(0.95047f)));
+	yy = texgz_tex_labf4(yy);
+	zz = texgz_tex_labf4(_mm_div_ps(zz, _mm_set1_ps(1.08883f)));
+
+	_mm_storeu_ps(ll, _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(116.0f), yy),
+	                             _mm_set1_ps(16.0f)));
+	_mm_storeu_ps(la, _mm_mul_ps(_mm_set1_ps(500.0f),
+	                             _mm_sub_ps(xx, yy)));
+	_mm_storeu_ps(lb, _mm_mul_ps(_mm_set1_ps(200.0f),
+	                             _mm_sub_ps(yy, zz)));
+	#else
+	float32x4_t r  = vld1q_f32(ll);
+	float32x4_t g  = vld1q_f32(la);
+	float32x4_t b  = vld1q_f32(lb);
+	float32x4_t xx = vaddq_f32(vaddq_f32(vmulq_f32(r, vdupq_n_f32(0.4124f)),
+	                                     vmulq_f32(g, vdupq_n_f32(0.3576f))),
+	                           vmulq_f32(b, vdupq_n_f32(0.1805f)));
+	float32x4_t yy = vaddq_f32(vaddq_f32(vmulq_f32(r, vdupq_n_f32(0.2126f)),
+	                                     vmulq_f32(g, vdupq_n_f32(0.7152f))),
+	                           vmulq_f32(b, vdupq_n_f32(0.0722f)));
+	float32x4_t zz = vaddq_f32(vaddq_f32(vmulq_f32(r, vdupq_n_f32(0.0193f)),
+	                                     vmulq_f32(g, vdupq_n_f32(0.1192f))),
+	                           vmulq_f32(b, vdupq_n_f32(0.9505f)));
+	xx = texgz_tex_labf4(vdivq_f32(xx, vdupq_n_f32(0.95047f)));
+	yy = texgz_tex_labf4(yy);
+	zz = texgz_tex_labf4(vdivq_f32(zz, vdupq_n_f32(1.08883f)));
+
+	vst1q_f32(ll, vsubq_f32(vmulq_f32(vdupq_n_f32(116.0f), yy),
+	                        vdupq_n_f32(16.0f)));
+	vst1q_f32(la, vmulq_f32(vdupq_n_f32(500.0f),
+	                        vsubq_f32(xx, yy)));
+	vst1q_f32(lb, vmulq_f32(vdupq_n_f32(200.0f),
+	                        vsubq_f32(yy, zz)));
+	#endif
+}
+
+#endif
+
+static void
+texgz_tex_labRows(void* priv, int tid, int y0, int y1)
+{
+	ASSERT(priv);
+
+	texgz_tex_lab_t* self = (texgz_tex_lab_t*) priv;
+
+	// See rgb2lab
+	// https://github.com/antimatter15/rgb-lab/blob/master/color.js
+	texgz_tex_t* src = self->src;
+
+	int    x;
+	int    y;
+	int    w  = src->width;
+	int    ch = self->channels;
+	float* ll = &self->scratch[3*w*tid];
+	float* la = &ll[w];
+	float* lb = &la[w];
+	for(y = y0; y < y1; ++y)
+	{
+		unsigned char* ps = &src->pixels[ch*y*src->stride];
+
+		// the table lookups are split from the arithmetic
+		// which is converted 4 pixels at a time
+		for(x = 0; x < w; ++x)
+		{
+			ll[x] = texgz_tex_srgbLut[ps[ch*x]];
+			la[x] = texgz_tex_srgbLut[ps[ch*x + 1]];
+			lb[x] = texgz_tex_srgbLut[ps[ch*x + 2]];
+		}
+
+		x = 0;
+		#ifdef TEXGZ_LAB_SIMD
+		for(; x + 4 <= w; x += 4)
+		{
+			texgz_tex_lab4(&ll[x], &la[x], &lb[x]);
+		}
+		#endif
+
+		for(; x < w; ++x)
+		{
+			float r  = ll[x];
+			float g  = la[x];
+			float b  = lb[x];
+			float xx = (r*0.4124f + g*0.3576f + b*0.1805f)/0.95047f;
+			float yy = (r*0.2126f + g*0.7152f + b*0.0722f)/1.00000f;
+			float zz = (r*0.0193f + g*0.1192f + b*0.9505f)/1.08883f;
+
+			xx = texgz_tex_labf(xx);
+			yy = texgz_tex_labf(yy);
+			zz = texgz_tex_labf(zz);
+
+			ll[x] = 116.0f*yy - 16.0f;
+			la[x] = 500.0f*(xx - yy);
+			lb[x] = 200.0f*(yy - zz);
+		}
+
+		if(self->mode == TEXGZ_LAB_MODE_LABL)
+		{
+			texgz_tex_t*   dst = self->dst[0];
+			unsigned char* pd  = &dst->pixels[y*dst->stride];
+			for(x = 0; x < w; ++x)
+			{
+				pd[x] = (unsigned char)
+				        cc_clamp((255.0f/100.0f)*ll[x],
+				                 0.0f, 255.0f);
+			}
+		}
+		else if(self->mode == TEXGZ_LAB_MODE_PLANAR)
+		{
+			int c;
+			for(c = 0; c < 3; ++c)
+			{
+				texgz_tex_t* dst = self->dst[c];
+				float*       pd  = (float*) dst->pixels;
+				memcpy(&pd[y*dst->stride], &ll[c*w],
+				       w*sizeof(float));
+			}
+		}
+		else
+		{
+			texgz_tex_t* dst = self->dst[0];
+			float*       pd  = (float*) dst->pixels;
+			pd = &pd[4*y*dst->stride];
+			for(x = 0; x < w; ++x)
+			{
+				pd[4*x]     = ll[x];
+				pd[4*x + 1] = la[x];
+				pd[4*x + 2] = lb[x];
+				pd[4*x + 3] = (ch == 4) ?
+				              ((float) ps[4*x + 3])/255.0f :
+				              1.0f;
+			}
+		}
+	}
+}
+
+static int texgz_tex_lab(texgz_tex_lab_t* self)
+{
+	ASSERT(self);
+
+	texgz_tex_t* src = self->src;
+
+	// check for supported type/format
+	self->channels = 0;
+	if(src->type == TEXGZ_UNSIGNED_BYTE)
+	{
+		if(src->format == TEXGZ_RGBA)
+		{
+			self->channels = 4;
+		}
+		else if(src->format == TEXGZ_RGB)
+		{
+			self->channels = 3;
+		}
+	}
+
+	if(self->channels == 0)
+	{
+		LOGE("invalid type=0x%X, format=0x%X",
+		     src->type, src->format);
+		return 0;
+	}
+
+	pthread_once(&texgz_tex_srgbOnce, texgz_tex_srgbLutInit);
+
+	size_t nth = (size_t) texgz_thread_count();
+	self->scratch = (float*)
+	                MALLOC(3*nth*src->width*sizeof(float));
+	if(self->scratch == NULL)
+	{
+		return 0;
+	}
+
+	texgz_thread_parallel(src->height, self,
+	                      texgz_tex_labRows);
+
+	FREE(self->scratch);
+
+	return 1;
+}
+
 static texgz_tex_t* texgz_tex_8888toLABL(texgz_tex_t* self)
 {
 	ASSERT(self);
@@ -942,45 +1374,17 @@ static texgz_tex_t* texgz_tex_8888toLABL(texgz_tex_t* self)
 	if(tex == NULL)
 		return NULL;
 
-	// See rgb2lab
-	// https://github.com/antimatter15/rgb-lab/blob/master/color.js
-	float r;
-	float g;
-	float b;
-	float yy;
-	float labl;
-	int x, y, idx;
-	for(y = 0; y < tex->height; ++y)
+	texgz_tex_lab_t lab =
 	{
-		for(x = 0; x < tex->width; ++x)
-		{
-			idx = y*tex->stride + x;
-			unsigned char* src = &self->pixels[4*idx];
-			unsigned char* dst = &tex->pixels[idx];
-
-			r = ((float) src[0])/255.0f;
-			g = ((float) src[1])/255.0f;
-			b = ((float) src[2])/255.0f;
+		.mode = TEXGZ_LAB_MODE_LABL,
+		.src  = self,
+		.dst  = { tex, NULL, NULL },
+	};
 
-			r = (r > 0.04045f) ? powf((r + 0.055f)/1.055f, 2.4f) : r/12.92f;
-			g = (g > 0.04045f) ? powf((g + 0.055f)/1.055f, 2.4f) : g/12.92f;
-			b = (b > 0.04045f) ? powf((b + 0.055f)/1.055f, 2.4f) : b/12.92f;
-
-			yy = (r*0.2126f + g*0.7152f + b*0.0722f)/1.00000f;
-			yy = (yy > 0.008856f) ? powf(yy, 0.333333f) : (7.787f*yy) + 16.0f/116.0f;
-
-			labl = (255.0f/100.0f)*(116.0f*yy - 16.0f);
-
-			if(labl > 255.0f)
-			{
-				labl = 255.0f;
-			}
-			else if(labl < 0.0f)
-			{
-				labl = 0.0f;
-			}
-			dst[0] = (unsigned char) labl;
-		}
+	if(texgz_tex_lab(&lab) == 0)
+	{
+		texgz_tex_delete(&tex);
+		return NULL;
 	}
 
 	return tex;
@@ -1982,1863 +2386,2593 @@ texgz_tex_gaussianCoef(float sigma, float mu,
 	return 1;
 }
 
-static int texgz_clampi(int v, int min, int max)
+// gaussian kernels larger than this radius are
+// approximated by repeated box filters
+#define TEXGZ_GAUSSIAN_EXACT_RADIUS 8
+
+typedef struct
 {
-	ASSERT(min < max);
+	texgz_tex_t* src;
+	texgz_tex_t* dst;
+	int          bpp;
+	int          channels;
+
+	// separable kernel (exact)
+	int          size;
+	const float* mask;
+
+	// box sizes (approximate)
+	int box[3];
+
+	// working buffers
+	// buf/tmp: width*height*channels
+	// scratch: scratch_size floats per thread
+	float* buf;
+	float* tmp;
+	float* scratch;
+	int    scratch_size;
+} texgz_tex_filter_t;
+
+static int texgz_tex_filterChannels(texgz_tex_t* self)
+{
+	ASSERT(self);
 
-	if(v < min)
+	if(self->type == TEXGZ_UNSIGNED_BYTE)
 	{
-		v = min;
+		if((self->format == TEXGZ_RGBA) ||
+		   (self->format == TEXGZ_BGRA))
+		{
+			return 4;
+		}
+		else if(self->format == TEXGZ_RGB)
+		{
+			return 3;
+		}
+		else if(self->format == TEXGZ_LUMINANCE_ALPHA)
+		{
+			return 2;
+		}
+		else if((self->format == TEXGZ_LUMINANCE) ||
+		        (self->format == TEXGZ_ALPHA)     ||
+		        (self->format == TEXGZ_LABL))
+		{
+			return 1;
+		}
 	}
-	else if(v > max)
+	else if((self->type   == TEXGZ_SHORT) &&
+	        (self->format == TEXGZ_LUMINANCE))
 	{
-		v = max;
+		return 1;
+	}
+	else if(self->type == TEXGZ_FLOAT)
+	{
+		if(self->format == TEXGZ_RGBA)
+		{
+			return 4;
+		}
+		else if(self->format == TEXGZ_LUMINANCE_ALPHA)
+		{
+			return 2;
+		}
+		else if(self->format == TEXGZ_LUMINANCE)
+		{
+			return 1;
+		}
 	}
-	return v;
-}
 
-/*
- * public
- */
+	// packed types are filtered as RGBA-8888
+	return 0;
+}
 
-texgz_tex_t*
-texgz_tex_new(int width, int height,
-              int stride, int vstride,
-              int type, int format,
-              unsigned char* pixels)
+static void
+texgz_tex_filterLoad(texgz_tex_filter_t* self, int y,
+                     float* row)
 {
-	// pixels can be NULL
+	ASSERT(self);
+	ASSERT(row);
 
-	if((stride <= 0) || (width > stride))
+	texgz_tex_t* src = self->src;
+
+	int i;
+	int n = self->channels*src->width;
+	unsigned char* pixels = &src->pixels[self->bpp*y*src->stride];
+	if(src->type == TEXGZ_FLOAT)
 	{
-		LOGE("invalid width=%i, stride=%i",
-		     width, stride);
-		return NULL;
+		memcpy(row, pixels, n*sizeof(float));
 	}
-
-	if((vstride <= 0) || (height > vstride))
+	else if(src->type == TEXGZ_SHORT)
 	{
-		LOGE("invalid height=%i, vstride=%i",
-		     height, vstride);
-		return NULL;
+		short* p = (short*) pixels;
+		for(i = 0; i < n; ++i)
+		{
+			row[i] = (float) p[i];
+		}
 	}
-
-	if((type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) &&
-	   (format == TEXGZ_RGBA))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_SHORT_5_5_5_1) &&
-	        (format == TEXGZ_RGBA))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_SHORT_5_6_5) &&
-	        (format == TEXGZ_RGB))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_RGBA))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_RGB))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_LUMINANCE))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_LABL))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_ALPHA))
-		; // ok
-	else if((type == TEXGZ_SHORT) &&
-	        (format == TEXGZ_LUMINANCE))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_LUMINANCE_ALPHA))
-		; // ok
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_BGRA))
-		; // ok
-	else if((type == TEXGZ_FLOAT) &&
-	        (format == TEXGZ_LUMINANCE))
-		; // ok
-	else if((type == TEXGZ_FLOAT) &&
-	        (format == TEXGZ_RGBA))
-		; // ok
 	else
 	{
-		LOGE("invalid type=0x%X, format=0x%X",
-		     type, format);
-		return NULL;
+		for(i = 0; i < n; ++i)
+		{
+			row[i] = (float) pixels[i];
+		}
 	}
+}
 
-	texgz_tex_t* self;
-	self = (texgz_tex_t*) MALLOC(sizeof(texgz_tex_t));
-	if(self == NULL)
-	{
-		LOGE("MALLOC failed");
-		return NULL;
-	}
+static void
+texgz_tex_filterStore(texgz_tex_filter_t* self, int y,
+                      const float* row)
+{
+	ASSERT(self);
+	ASSERT(row);
 
-	self->width   = width;
-	self->height  = height;
-	self->stride  = stride;
-	self->vstride = vstride;
-	self->type    = type;
-	self->format  = format;
+	texgz_tex_t* dst = self->dst;
 
-	int size = texgz_tex_size(self);
-	if(size == 0)
+	int i;
+	int n = self->channels*dst->width;
+	unsigned char* pixels = &dst->pixels[self->bpp*y*dst->stride];
+	if(dst->type == TEXGZ_FLOAT)
 	{
-		LOGE("invalid type=%i, format=%i", type, format);
-		goto fail_bpp;
+		memcpy(pixels, row, n*sizeof(float));
 	}
-
-	self->pixels = (unsigned char*) MALLOC((size_t) size);
-	if(self->pixels == NULL)
+	else if(dst->type == TEXGZ_SHORT)
 	{
-		LOGE("MALLOC failed");
-		goto fail_pixels;
+		short* p = (short*) pixels;
+		for(i = 0; i < n; ++i)
+		{
+			p[i] = (short) floorf(cc_clamp(row[i] + 0.5f,
+			                               -32768.0f,
+			                               32767.0f));
+		}
 	}
-
-	if(pixels == NULL)
-		memset(self->pixels, 0, size);
 	else
-		memcpy(self->pixels, pixels, size);
-
-	// success
-	return self;
-
-	// failure
-	fail_pixels:
-	fail_bpp:
-		FREE(self);
-	return NULL;
+	{
+		for(i = 0; i < n; ++i)
+		{
+			pixels[i] = (unsigned char)
+			            cc_clamp(row[i] + 0.5f, 0.0f, 255.0f);
+		}
+	}
 }
 
-void texgz_tex_delete(texgz_tex_t** _self)
+// running sum box filter of size 2*r + 1 with clamped
+// edges where src/dst are n samples separated by step
+// floats and count interleaved values are filtered
+static void
+texgz_tex_filterBox(const float* src, float* dst,
+                    int n, int step, int count, int r,
+                    float* sum)
 {
-	ASSERT(_self);
+	ASSERT(src);
+	ASSERT(dst);
+	ASSERT(sum);
 
-	texgz_tex_t* self = *_self;
-	if(self)
+	int   i;
+	int   k;
+	float s = 1.0f/((float) (2*r + 1));
+
+	for(i = 0; i < count; ++i)
 	{
-		FREE(self->pixels);
-		FREE(self);
-		*_self = NULL;
+		sum[i] = ((float) (r + 1))*src[i];
 	}
-}
 
-texgz_tex_t* texgz_tex_copy(texgz_tex_t* self)
-{
-	ASSERT(self);
+	for(k = 1; k <= r; ++k)
+	{
+		const float* a = &src[step*((k < n) ? k : n - 1)];
+		for(i = 0; i < count; ++i)
+		{
+			sum[i] += a[i];
+		}
+	}
 
-	return texgz_tex_new(self->width, self->height,
-                         self->stride, self->vstride,
-                         self->type, self->format,
-                         self->pixels);
+	for(k = 0; k < n; ++k)
+	{
+		int ka = k + r + 1;
+		int kb = k - r;
+		const float* a = &src[step*((ka < n) ? ka : n - 1)];
+		const float* b = &src[step*((kb > 0) ? kb : 0)];
+		float*       d = &dst[step*k];
+		for(i = 0; i < count; ++i)
+		{
+			d[i]    = s*sum[i];
+			sum[i] += a[i] - b[i];
+		}
+	}
 }
 
-texgz_tex_t* texgz_tex_downscale(texgz_tex_t* self)
+static void
+texgz_tex_filterRows(void* priv, int tid, int y0, int y1)
 {
-	ASSERT(self);
+	ASSERT(priv);
 
-	// only support even/one w/h textures
-	int w = self->width;
-	int h = self->height;
-	if(((w == 1) || (w%2 == 0)) &&
-	   ((h == 1) || (h%2 == 0)))
-	{
-		// continue
-	}
-	else
+	texgz_tex_filter_t* self = (texgz_tex_filter_t*) priv;
+
+	int    c       = self->channels;
+	int    w       = self->src->width;
+	int    wc      = w*c;
+	float* scratch = &self->scratch[self->scratch_size*tid];
+
+	// horizontal pass from src to buf
+	int i;
+	int k;
+	int y;
+	for(y = y0; y < y1; ++y)
 	{
-		LOGE("invalid w=%i, h=%i", w, h);
-		return NULL;
+		float* out = &self->buf[y*wc];
+		if(self->mask)
+		{
+			// load the row padded with clamped edges
+			int    r   = self->size/2;
+			float* row = &scratch[r*c];
+			texgz_tex_filterLoad(self, y, row);
+			for(k = 0; k < r; ++k)
+			{
+				for(i = 0; i < c; ++i)
+				{
+					scratch[k*c + i]   = row[i];
+					row[(w + k)*c + i] = row[(w - 1)*c + i];
+				}
+			}
+
+			memset(out, 0, wc*sizeof(float));
+			for(k = 0; k < self->size; ++k)
+			{
+				float        m  = self->mask[k];
+				const float* in = &scratch[k*c];
+				for(i = 0; i < wc; ++i)
+				{
+					out[i] += m*in[i];
+				}
+			}
+		}
+		else
+		{
+			float* a   = scratch;
+			float* b   = &scratch[wc];
+			float* sum = &scratch[2*wc];
+			texgz_tex_filterLoad(self, y, a);
+			texgz_tex_filterBox(a, b, w, c, c,
+			                    self->box[0]/2, sum);
+			texgz_tex_filterBox(b, a, w, c, c,
+			                    self->box[1]/2, sum);
+			texgz_tex_filterBox(a, out, w, c, c,
+			                    self->box[2]/2, sum);
+		}
 	}
+}
 
-	// handle 1x1 special case
-	if((w == 1) && (h == 1))
+static void
+texgz_tex_filterVert(void* priv, int tid, int y0, int y1)
+{
+	ASSERT(priv);
+
+	texgz_tex_filter_t* self = (texgz_tex_filter_t*) priv;
+
+	int    c   = self->channels;
+	int    h   = self->src->height;
+	int    wc  = c*self->src->width;
+	int    r   = self->size/2;
+	float* out = &self->scratch[self->scratch_size*tid];
+
+	// vertical pass from buf to dst
+	int i;
+	int k;
+	int y;
+	for(y = y0; y < y1; ++y)
 	{
-		return texgz_tex_copy(self);
+		memset(out, 0, wc*sizeof(float));
+		for(k = 0; k < self->size; ++k)
+		{
+			int yk = y + k - r;
+			if(yk < 0)
+			{
+				yk = 0;
+			}
+			else if(yk >= h)
+			{
+				yk = h - 1;
+			}
+
+			float        m  = self->mask[k];
+			const float* in = &self->buf[yk*wc];
+			for(i = 0; i < wc; ++i)
+			{
+				out[i] += m*in[i];
+			}
+		}
+
+		texgz_tex_filterStore(self, y, out);
 	}
+}
 
-	// convert to unsigned bytes
-	int type = self->type;
-	texgz_tex_t* src;
-	if(type == TEXGZ_UNSIGNED_BYTE)
+static void
+texgz_tex_filterCols(void* priv, int tid, int x0, int x1)
+{
+	ASSERT(priv);
+
+	texgz_tex_filter_t* self = (texgz_tex_filter_t*) priv;
+
+	// vertical box passes over a band of columns
+	// buf to tmp to buf to tmp
+	int    c     = self->channels;
+	int    h     = self->src->height;
+	int    wc    = c*self->src->width;
+	int    count = c*(x1 - x0);
+	float* a     = &self->buf[c*x0];
+	float* b     = &self->tmp[c*x0];
+	float* sum   = &self->scratch[self->scratch_size*tid];
+	texgz_tex_filterBox(a, b, h, wc, count,
+	                    self->box[0]/2, sum);
+	texgz_tex_filterBox(b, a, h, wc, count,
+	                    self->box[1]/2, sum);
+	texgz_tex_filterBox(a, b, h, wc, count,
+	                    self->box[2]/2, sum);
+}
+
+static void
+texgz_tex_filterStoreRows(void* priv, int tid,
+                          int y0, int y1)
+{
+	ASSERT(priv);
+
+	texgz_tex_filter_t* self = (texgz_tex_filter_t*) priv;
+
+	int y;
+	int wc = self->channels*self->src->width;
+	for(y = y0; y < y1; ++y)
 	{
-		src = self;
+		texgz_tex_filterStore(self, y, &self->tmp[y*wc]);
 	}
-	else if((type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) ||
-	        (type == TEXGZ_UNSIGNED_SHORT_5_5_5_1))
+}
+
+// apply either the separable mask or the box filters
+// to any type/format
+static texgz_tex_t*
+texgz_tex_filtercopy(texgz_tex_t* self, int size,
+                     const float* mask, const int* box)
+{
+	ASSERT(self);
+
+	int channels = texgz_tex_filterChannels(self);
+	if(channels == 0)
 	{
-		src = texgz_tex_convertcopy(self,
+		// filter packed types as 8888
+		texgz_tex_t* tmp;
+		tmp = texgz_tex_convertcopy(self,
 		                            TEXGZ_UNSIGNED_BYTE,
 		                            TEXGZ_RGBA);
+		if(tmp == NULL)
+		{
+			return NULL;
+		}
+
+		texgz_tex_t* tex;
+		tex = texgz_tex_filtercopy(tmp, size, mask, box);
+		texgz_tex_delete(&tmp);
+		if(tex == NULL)
+		{
+			return NULL;
+		}
+
+		if(texgz_tex_convert(tex, self->type,
+		                     self->format) == 0)
+		{
+			texgz_tex_delete(&tex);
+			return NULL;
+		}
+
+		return tex;
 	}
-	else if(type == TEXGZ_UNSIGNED_SHORT_5_6_5)
+
+	texgz_tex_filter_t filter =
 	{
-		src = texgz_tex_convertcopy(self,
-		                            TEXGZ_UNSIGNED_BYTE,
-		                            TEXGZ_RGB);
+		.src      = self,
+		.bpp      = texgz_tex_bpp(self),
+		.channels = channels,
+		.size     = size,
+		.mask     = mask,
+	};
+
+	if(box)
+	{
+		filter.box[0] = box[0];
+		filter.box[1] = box[1];
+		filter.box[2] = box[2];
 	}
-	else
+
+	filter.dst = texgz_tex_new(self->width, self->height,
+	                           self->stride, self->vstride,
+	                           self->type, self->format,
+	                           NULL);
+	if(filter.dst == NULL)
 	{
-		LOGE("invalid type=0x%X", type);
 		return NULL;
 	}
 
-	// check the conversion (if needed)
-	if(src == NULL)
+	int wc = channels*self->width;
+	int r  = size/2;
+
+	// the padded row requires (w + 2*r)*c floats
+	filter.scratch_size = 3*wc;
+	if(wc + 2*r*channels > filter.scratch_size)
 	{
-		return NULL;
+		filter.scratch_size = wc + 2*r*channels;
 	}
 
-	// create downscale texture
-	w = (w == 1) ? 1 : w/2;
-	h = (h == 1) ? 1 : h/2;
-	texgz_tex_t* down;
-	down = texgz_tex_new(w, h, w, h, src->type, src->format,
-	                     NULL);
-	if(down == NULL)
+	size_t nth = (size_t) texgz_thread_count();
+	filter.scratch = (float*)
+	                 MALLOC(nth*filter.scratch_size*
+	                        sizeof(float));
+	if(filter.scratch == NULL)
 	{
-		goto fail_new;
+		goto fail_scratch;
 	}
 
-	// downscale with box filter
-	int   i;
-	int   x;
-	int   y;
-	float p00;
-	float p01;
-	float p10;
-	float p11;
-	float avg;
-	int   bpp        = texgz_tex_bpp(src);
-	int   bpp2       = 2*bpp;
-	int   src_step   = bpp*src->stride;
-	int   dst_step   = bpp*down->stride;
-	int   src_offset00;
-	int   src_offset01;
-	int   src_offset10;
-	int   src_offset11;
-	int   dst_offset;
-	unsigned char* src_pixels = src->pixels;
-	unsigned char* dst_pixels = down->pixels;
-	if(src->width == 1)
+	size_t count = ((size_t) wc)*self->height;
+	filter.buf = (float*) MALLOC(count*sizeof(float));
+	if(filter.buf == NULL)
 	{
-		for(y = 0; y < src->height; y += 2)
-		{
-			src_offset00 = y*src_step;
-			src_offset10 = src_offset00 + src_step;
-			dst_offset   = (y/2)*dst_step;
-			for(i = 0; i < bpp; ++i)
-			{
-				p00 = (float) src_pixels[src_offset00 + i];
-				p10 = (float) src_pixels[src_offset10 + i];
-				avg = (p00 + p10)/2.0f;
-				dst_pixels[dst_offset + i] = (unsigned char) avg;
-			}
-		}
+		goto fail_buf;
 	}
-	else if(src->height == 1)
+
+	if(mask)
 	{
-		src_offset00 = 0;
-		src_offset01 = bpp;
-		dst_offset   = 0;
-		for(x = 0; x < src->width; x += 2)
-		{
-			for(i = 0; i < bpp; ++i)
-			{
-				p00 = (float) src_pixels[src_offset00 + i];
-				p01 = (float) src_pixels[src_offset01 + i];
-				avg = (p00 + p01)/2.0f;
-				dst_pixels[dst_offset + i] = (unsigned char) avg;
-			}
-			src_offset00 += bpp2;
-			src_offset01 += bpp2;
-			dst_offset   += bpp;
-		}
+		texgz_thread_parallel(self->height, &filter,
+		                      texgz_tex_filterRows);
+		texgz_thread_parallel(self->height, &filter,
+		                      texgz_tex_filterVert);
 	}
 	else
 	{
-		for(y = 0; y < src->height; y += 2)
+		filter.tmp = (float*) MALLOC(count*sizeof(float));
+		if(filter.tmp == NULL)
 		{
-			src_offset00 = y*src_step;
-			src_offset01 = src_offset00 + bpp;
-			src_offset10 = src_offset00 + src_step;
-			src_offset11 = src_offset10 + bpp;
-			dst_offset   = (y/2)*dst_step;
-			for(x = 0; x < src->width; x += 2)
-			{
-				for(i = 0; i < bpp; ++i)
-				{
-					p00 = (float) src_pixels[src_offset00 + i];
-					p01 = (float) src_pixels[src_offset01 + i];
-					p10 = (float) src_pixels[src_offset10 + i];
-					p11 = (float) src_pixels[src_offset11 + i];
-					avg = (p00 + p01 + p10 + p11)/4.0f;
-					dst_pixels[dst_offset + i] = (unsigned char) avg;
-				}
-				src_offset00 += bpp2;
-				src_offset01 += bpp2;
-				src_offset10 += bpp2;
-				src_offset11 += bpp2;
-				dst_offset   += bpp;
-			}
+			goto fail_tmp;
 		}
+
+		texgz_thread_parallel(self->height, &filter,
+		                      texgz_tex_filterRows);
+		texgz_thread_parallel(self->width, &filter,
+		                      texgz_tex_filterCols);
+		texgz_thread_parallel(self->height, &filter,
+		                      texgz_tex_filterStoreRows);
+		FREE(filter.tmp);
 	}
 
-	// convert to input type
-	if(type == TEXGZ_UNSIGNED_SHORT_4_4_4_4)
-	{
-		if(texgz_tex_convert(down,
-		                     TEXGZ_UNSIGNED_SHORT_4_4_4_4,
-		                     TEXGZ_RGBA) == 0)
-		{
-			goto fail_convert;
-		}
-	}
-	else if(type == TEXGZ_UNSIGNED_SHORT_5_5_5_1)
-	{
-		if(texgz_tex_convert(down,
-		                     TEXGZ_UNSIGNED_SHORT_5_5_5_1,
-		                     TEXGZ_RGBA) == 0)
-		{
-			goto fail_convert;
-		}
-	}
-	else if(type == TEXGZ_UNSIGNED_SHORT_5_6_5)
-	{
-		if(texgz_tex_convert(down,
-		                     TEXGZ_UNSIGNED_SHORT_5_6_5,
-		                     TEXGZ_RGB) == 0)
-		{
-			goto fail_convert;
-		}
-	}
-
-	// delete the temporary texture
-	if(type != TEXGZ_UNSIGNED_BYTE)
-	{
-		texgz_tex_delete(&src);
-	}
+	FREE(filter.buf);
+	FREE(filter.scratch);
 
 	// success
-	return down;
+	return filter.dst;
 
 	// failure
-	fail_convert:
-		texgz_tex_delete(&down);
-	fail_new:
-		if(type != TEXGZ_UNSIGNED_BYTE)
-		{
-			texgz_tex_delete(&src);
-		}
+	fail_tmp:
+		FREE(filter.buf);
+	fail_buf:
+		FREE(filter.scratch);
+	fail_scratch:
+		texgz_tex_delete(&filter.dst);
 	return NULL;
 }
 
-texgz_tex_t*
-texgz_tex_lanczos3(texgz_tex_t* self, int level)
+// compute the sizes of 3 box filters which approximate
+// a gaussian of the given sigma (Kovesi, "Fast Almost-
+// Gaussian Filtering")
+static void texgz_tex_gaussianBox(float sigma, int* box)
 {
-	ASSERT(self);
+	ASSERT(box);
 
-	// https://github.com/jeffboody/Lanczos
+	float n  = 3.0f;
+	float wi = sqrtf(12.0f*sigma*sigma/n + 1.0f);
+	int   wl = (int) floorf(wi);
+	if(wl%2 == 0)
+	{
+		--wl;
+	}
+	int wu = wl + 2;
 
-	int src_width  = self->width;
-	int src_height = self->height;
-	int dst_width  = src_width/cc_pow2n(level);
-	int dst_height = src_height/cc_pow2n(level);
+	float mi = (12.0f*sigma*sigma - n*wl*wl - 4.0f*n*wl -
+	            3.0f*n)/(-4.0f*wl - 4.0f);
+	int   m  = (int) roundf(mi);
 
-	if((src_width%dst_width) || (src_height%dst_height))
+	int i;
+	for(i = 0; i < 3; ++i)
 	{
-		LOGE("invalid width=%i:%i, height=%i:%i",
-		     src_width,  dst_width,
-		     src_height, dst_height);
-		return NULL;
+		box[i] = (i < m) ? wl : wu;
 	}
+}
+
+#define TEXGZ_ROTATE_TILE 16
 
+typedef struct
+{
 	texgz_tex_t* src;
-	src = texgz_tex_convertFcopy(self, 0.0f, 1.0f,
-	                             TEXGZ_FLOAT, TEXGZ_RGBA);
-	if(src == NULL)
+	texgz_tex_t* dst;
+	int          bpp;
+
+	// the src pixel (x,y) is copied to the dst pixel
+	// offset + x*ix + y*iy
+	ptrdiff_t offset;
+	ptrdiff_t ix;
+	ptrdiff_t iy;
+} texgz_tex_rotate_t;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+#if defined(__SSE2__)
+typedef __m128i texgz_tex_vec_t;
+#else
+typedef uint8x16_t texgz_tex_vec_t;
+#endif
+
+static inline texgz_tex_vec_t
+texgz_tex_vecLoad(const unsigned char* p)
+{
+	#if defined(__SSE2__)
+	return _mm_loadu_si128((const __m128i*) p);
+	#else
+	return vld1q_u8(p);
+	#endif
+}
+
+static inline void
+texgz_tex_vecStore(unsigned char* p, texgz_tex_vec_t v)
+{
+	#if defined(__SSE2__)
+	_mm_storeu_si128((__m128i*) p, v);
+	#else
+	vst1q_u8(p, v);
+	#endif
+}
+
+// interleave the low and high halves of a and b in
+// elements of size bytes
+static inline void
+texgz_tex_vecUnpack(texgz_tex_vec_t a, texgz_tex_vec_t b,
+                    int size, texgz_tex_vec_t* lo,
+                    texgz_tex_vec_t* hi)
+{
+	#if defined(__SSE2__)
+	if(size == 1)
 	{
-		return NULL;
+		*lo = _mm_unpacklo_epi8(a, b);
+		*hi = _mm_unpackhi_epi8(a, b);
 	}
-
-	texgz_tex_t* conv;
-	conv = texgz_tex_new(dst_width, src_height,
-	                     dst_width, src_height,
-	                     TEXGZ_FLOAT, TEXGZ_RGBA,
-	                     NULL);
-	if(conv == NULL)
+	else if(size == 2)
 	{
-		goto fail_conv;
+		*lo = _mm_unpacklo_epi16(a, b);
+		*hi = _mm_unpackhi_epi16(a, b);
 	}
-
-	texgz_tex_t* dst;
-	dst = texgz_tex_new(dst_width, dst_height,
-	                    dst_width, dst_height,
-	                    TEXGZ_FLOAT, TEXGZ_RGBA,
-	                    NULL);
-	if(dst == NULL)
+	else if(size == 4)
 	{
-		goto fail_dst;
+		*lo = _mm_unpacklo_epi32(a, b);
+		*hi = _mm_unpackhi_epi32(a, b);
 	}
-
-	// determine filter size
-	int fs   = cc_pow2n(level);
-	int a    = 3;
-	int size = 2*fs*a;
-	if(size >= TEXGZ_LANCZOS3_MAXSIZE)
+	else
 	{
-		LOGE("invalid level=%i", level);
-		goto fail_size;
+		*lo = _mm_unpacklo_epi64(a, b);
+		*hi = _mm_unpackhi_epi64(a, b);
 	}
-
-	// generate masks and compute filter weight
-	float fsf  = (float) fs;
-	float step = (float) fs;
-	float x0   = 0.5f*step - 0.5f;
-	int   i;
-	int   m = 0;
-	float w = 0.0f;
-	float mask[TEXGZ_LANCZOS3_MAXSIZE];
-	for(i = -(fs*a) + 1; i <= (fs*a); ++i)
+	#else
+	if(size == 1)
 	{
-		mask[m] = pil_lanczos3_filter((i - x0 + floorf(x0))/fsf);
-		w += mask[m];
-		m++;
+		uint8x16x2_t z = vzipq_u8(a, b);
+		*lo = z.val[0];
+		*hi = z.val[1];
 	}
-
-	// apply filter weight
-	for(m = 0; m < size; ++m)
+	else if(size == 2)
 	{
-		mask[m] /= w;
+		uint16x8x2_t z = vzipq_u16(vreinterpretq_u16_u8(a),
+		                           vreinterpretq_u16_u8(b));
+		*lo = vreinterpretq_u8_u16(z.val[0]);
+		*hi = vreinterpretq_u8_u16(z.val[1]);
 	}
-
-	// apply filter and decimate
-	int stride = fs;
-	texgz_tex_convolveF(src,  conv,
-	                    size, 1, stride, 1, mask);
-	texgz_tex_convolveF(conv, dst,
-	                    1, size, 1, stride, mask);
-
-	if(texgz_tex_convertF(dst, 0.0f, 1.0f,
-	                      TEXGZ_UNSIGNED_BYTE,
-	                      TEXGZ_RGBA) == 0)
+	else if(size == 4)
 	{
-		goto fail_convert;
+		uint32x4x2_t z = vzipq_u32(vreinterpretq_u32_u8(a),
+		                           vreinterpretq_u32_u8(b));
+		*lo = vreinterpretq_u8_u32(z.val[0]);
+		*hi = vreinterpretq_u8_u32(z.val[1]);
 	}
-
-	texgz_tex_delete(&conv);
-	texgz_tex_delete(&src);
-
-	// success
-	return dst;
-
-	// failure
-	fail_convert:
-	fail_size:
-		texgz_tex_delete(&dst);
-	fail_dst:
-		texgz_tex_delete(&conv);
-	fail_conv:
-		texgz_tex_delete(&src);
-	return NULL;
+	else
+	{
+		*lo = vcombine_u8(vget_low_u8(a), vget_low_u8(b));
+		*hi = vcombine_u8(vget_high_u8(a), vget_high_u8(b));
+	}
+	#endif
 }
 
-texgz_tex_t* texgz_tex_resize(texgz_tex_t* self,
-                              int width,
-                              int height)
+// rotate an n x n block of 1/2/4 byte pixels where
+// n = 16/bpp by transposing the rows in registers
+static void
+texgz_tex_rotateBlock(texgz_tex_rotate_t* self,
+                      int x0, int y0)
 {
 	ASSERT(self);
-	ASSERT(self->type == TEXGZ_UNSIGNED_BYTE);
-	ASSERT((self->format == TEXGZ_RGB) ||
-	       (self->format == TEXGZ_RGBA));
 
-	texgz_tex_t* copy;
-	copy = texgz_tex_new(width, height,
-	                     width, height,
-	                     self->type, self->format,
-	                     NULL);
-	if(copy == NULL)
+	texgz_tex_t* src = self->src;
+	texgz_tex_t* dst = self->dst;
+
+	int       i;
+	int       bpp = self->bpp;
+	int       n   = 16/bpp;
+	ptrdiff_t ss  = src->stride;
+
+	// the rows are loaded in dst order so that each
+	// transposed column is stored as one dst span
+	texgz_tex_vec_t va[16];
+	texgz_tex_vec_t vb[16];
+	texgz_tex_vec_t* a = va;
+	texgz_tex_vec_t* b = vb;
+	for(i = 0; i < n; ++i)
 	{
-		return NULL;
+		ptrdiff_t y = (self->iy > 0) ? y0 + i : y0 + n - 1 - i;
+		a[i] = texgz_tex_vecLoad(&src->pixels[bpp*(y*ss + x0)]);
 	}
 
-	int bpp = texgz_tex_bpp(self);
+	// each pass interleaves pairs of rows in elements of
+	// twice the size of the previous pass which leaves
+	// column c in vector bitreverse(c)
+	int size;
+	for(size = bpp; size < 16; size *= 2)
+	{
+		for(i = 0; i < n/2; ++i)
+		{
+			texgz_tex_vecUnpack(a[2*i], a[2*i + 1], size,
+			                    &b[i], &b[i + n/2]);
+		}
 
-	int   i;
-	int   j;
-	float u;
-	float v;
-	unsigned char pixel[4];
-	for(i = 0; i < height; ++i)
+		texgz_tex_vec_t* t = a;
+		a = b;
+		b = t;
+	}
+
+	int       c;
+	int       m;
+	int       r;
+	ptrdiff_t y = (self->iy > 0) ? y0 : y0 + n - 1;
+	for(c = 0; c < n; ++c)
 	{
-		for(j = 0; j < width; ++j)
+		r = 0;
+		for(m = 1; m < n; m *= 2)
 		{
-			u = (((float) j) + 0.5f)/((float) width);
-			v = (((float) i) + 0.5f)/((float) height);
-			texgz_tex_sample(self, u, v, bpp, pixel);
-			texgz_tex_setPixel(copy, j, i, pixel);
+			r = 2*r + ((c & m) ? 1 : 0);
 		}
+
+		ptrdiff_t d = self->offset + (x0 + c)*self->ix +
+		              y*self->iy;
+		texgz_tex_vecStore(&dst->pixels[bpp*d], a[r]);
 	}
+}
 
-	return copy;
+#endif
+
+static void
+texgz_tex_rotateTiles(void* priv, int tid, int t0, int t1)
+{
+	ASSERT(priv);
+
+	texgz_tex_rotate_t* self = (texgz_tex_rotate_t*) priv;
+
+	texgz_tex_t* src = self->src;
+	texgz_tex_t* dst = self->dst;
+
+	// the tiles keep the strided side of the copy within
+	// a small set of cache lines
+	int       x;
+	int       y;
+	int       tx;
+	int       ty;
+	int       bpp = self->bpp;
+	ptrdiff_t ix  = self->ix;
+	ptrdiff_t iy  = self->iy;
+	ptrdiff_t ss  = src->stride;
+	for(ty = t0*TEXGZ_ROTATE_TILE; ty < t1*TEXGZ_ROTATE_TILE;
+	    ty += TEXGZ_ROTATE_TILE)
+	{
+		int y1 = ty + TEXGZ_ROTATE_TILE;
+		if(y1 > src->height)
+		{
+			y1 = src->height;
+		}
+
+		for(tx = 0; tx < src->width; tx += TEXGZ_ROTATE_TILE)
+		{
+			int x1 = tx + TEXGZ_ROTATE_TILE;
+			if(x1 > src->width)
+			{
+				x1 = src->width;
+			}
+
+			#if defined(__SSE2__) || defined(__ARM_NEON)
+			// full tiles of 1/2/4 byte pixels are
+			// transposed in blocks of 16 bytes
+			if(((bpp == 1) || (bpp == 2) || (bpp == 4)) &&
+			   (x1 - tx == TEXGZ_ROTATE_TILE) &&
+			   (y1 - ty == TEXGZ_ROTATE_TILE))
+			{
+				int n = 16/bpp;
+				for(y = ty; y < y1; y += n)
+				{
+					for(x = tx; x < x1; x += n)
+					{
+						texgz_tex_rotateBlock(self, x, y);
+					}
+				}
+				continue;
+			}
+			#endif
+
+			for(y = ty; y < y1; ++y)
+			{
+				ptrdiff_t s = y*ss + tx;
+				ptrdiff_t d = self->offset + tx*ix + y*iy;
+				if(bpp == 1)
+				{
+					uint8_t* sp = (uint8_t*) src->pixels;
+					uint8_t* dp = (uint8_t*) dst->pixels;
+					for(x = tx; x < x1; ++x)
+					{
+						dp[d] = sp[s];
+						++s;
+						d += ix;
+					}
+				}
+				else if(bpp == 2)
+				{
+					uint16_t* sp = (uint16_t*) src->pixels;
+					uint16_t* dp = (uint16_t*) dst->pixels;
+					for(x = tx; x < x1; ++x)
+					{
+						dp[d] = sp[s];
+						++s;
+						d += ix;
+					}
+				}
+				else if(bpp == 4)
+				{
+					uint32_t* sp = (uint32_t*) src->pixels;
+					uint32_t* dp = (uint32_t*) dst->pixels;
+					for(x = tx; x < x1; ++x)
+					{
+						dp[d] = sp[s];
+						++s;
+						d += ix;
+					}
+				}
+				else if(bpp == 8)
+				{
+					uint64_t* sp = (uint64_t*) src->pixels;
+					uint64_t* dp = (uint64_t*) dst->pixels;
+					for(x = tx; x < x1; ++x)
+					{
+						dp[d] = sp[s];
+						++s;
+						d += ix;
+					}
+				}
+				else if(bpp == 16)
+				{
+					uint32_t* sp = (uint32_t*) src->pixels;
+					uint32_t* dp = (uint32_t*) dst->pixels;
+					for(x = tx; x < x1; ++x)
+					{
+						dp[4*d]     = sp[4*s];
+						dp[4*d + 1] = sp[4*s + 1];
+						dp[4*d + 2] = sp[4*s + 2];
+						dp[4*d + 3] = sp[4*s + 3];
+						++s;
+						d += ix;
+					}
+				}
+				else
+				{
+					for(x = tx; x < x1; ++x)
+					{
+						memcpy(&dst->pixels[bpp*d],
+						       &src->pixels[bpp*s], bpp);
+						++s;
+						d += ix;
+					}
+				}
+			}
+		}
+	}
 }
 
-texgz_tex_t* texgz_tex_import(const char* filename)
+static texgz_tex_t*
+texgz_tex_rotatecopy(texgz_tex_t* self, int ccw)
 {
-	ASSERT(filename);
+	ASSERT(self);
 
-	// open texture
-	gzFile f = gzopen(filename, "rb");
-	if(!f)
+	int bpp = texgz_tex_bpp(self);
+	if(bpp == 0)
 	{
-		LOGE("gzopen failed filename=%s", filename);
 		return NULL;
 	}
 
-	// read header
-	unsigned char buffer[4096];   // 4KB
-	int bytes_read = gzread(f, buffer, TEXGZ_TEX_HSIZE);
-	if(bytes_read != TEXGZ_TEX_HSIZE)
+	// the width and height are swapped
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->height, self->width,
+	                    self->vstride, self->stride,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
 	{
-		LOGE("gzread failed to read header");
-		goto fail_header;
+		return NULL;
 	}
 
-	int type;
-	int format;
-	int width;
-	int height;
-	int stride;
-	int vstride;
-	if(texgz_parseh(buffer, &type, &format,
-                    &width, &height, &stride, &vstride) == 0)
+	texgz_tex_rotate_t rotate =
 	{
-		goto fail_parseh;
+		.src = self,
+		.dst = tex,
+		.bpp = bpp,
+	};
+
+	ptrdiff_t w  = self->width;
+	ptrdiff_t h  = self->height;
+	ptrdiff_t ds = tex->stride;
+	if(ccw)
+	{
+		// rotate270: (x,y) to (y,w-1-x)
+		rotate.offset = (w - 1)*ds;
+		rotate.ix     = -ds;
+		rotate.iy     = 1;
+	}
+	else
+	{
+		// rotate90: (x,y) to (h-1-y,x)
+		rotate.offset = h - 1;
+		rotate.ix     = ds;
+		rotate.iy     = -1;
 	}
 
-	texgz_tex_t* self;
-	self = texgz_tex_new(width, height, stride, vstride,
-	                     type, format, NULL);
-	if(self == NULL)
-		goto fail_tex;
+	int tiles = (self->height + TEXGZ_ROTATE_TILE - 1)/
+	            TEXGZ_ROTATE_TILE;
+	texgz_thread_parallel(tiles, &rotate,
+	                      texgz_tex_rotateTiles);
 
-	// get texture size and check for supported formats
-	int bytes = texgz_tex_size(self);
-	if(bytes == 0)
-		goto fail_size;
+	return tex;
+}
 
-	// read pixels
-	unsigned char* pixels = self->pixels;
-	while(bytes > 0)
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+// reverse the order of the 1/2/4 byte pixels in v
+static inline texgz_tex_vec_t
+texgz_tex_vecReverse(texgz_tex_vec_t v, int bpp)
+{
+	#if defined(__SSE2__)
+	if(bpp == 1)
 	{
-		int bytes_read = gzread(f, pixels, bytes);
-		if(bytes_read == 0)
-		{
-			LOGE("failed to read pixels");
-			goto fail_pixels;
-		}
-		pixels += bytes_read;
-		bytes -= bytes_read;
+		v = _mm_or_si128(_mm_slli_epi16(v, 8),
+		                 _mm_srli_epi16(v, 8));
 	}
 
-	// success
-	gzclose(f);
-	return self;
-
-	// failure
-	fail_pixels:
-	fail_size:
-		texgz_tex_delete(&self);
-	fail_tex:
-	fail_parseh:
-	fail_header:
-		gzclose(f);
-	return NULL;
-}
-
-texgz_tex_t* texgz_tex_importz(const char* filename)
-{
-	ASSERT(filename);
-
-	FILE* f = fopen(filename, "r");
-	if(f == NULL)
+	if(bpp <= 2)
 	{
-		LOGE("invalid filename=%s", filename);
-		return NULL;
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+		return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
 	}
-
-	// determine the file size
-	fseek(f, (long) 0, SEEK_END);
-	int fsize = (int) ftell(f);
-	rewind(f);
-
-	texgz_tex_t* tex = texgz_tex_importf(f, fsize);
-	fclose(f);
-	return tex;
-}
-
-texgz_tex_t* texgz_tex_importf(FILE* f, int size)
-{
-	ASSERT(f);
-	ASSERT(size > 0);
-
-	// allocate src buffer
-	char* src = (char*) MALLOC(size*sizeof(char));
-	if(src == NULL)
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+	#else
+	if(bpp == 1)
 	{
-		LOGE("MALLOC failed");
-		return NULL;
+		v = vrev64q_u8(v);
 	}
-
-	// read buffer
-	long start = ftell(f);
-	if(fread((void*) src, sizeof(char), size, f) != size)
+	else if(bpp == 2)
 	{
-		LOGE("fread failed");
-		goto fail_read;
+		v = vreinterpretq_u8_u16(vrev64q_u16(vreinterpretq_u16_u8(v)));
 	}
-
-	texgz_tex_t* self;
-	self = texgz_tex_importd((size_t) size, (const void*) src);
-	if(self == NULL)
+	else
 	{
-		goto fail_tex;
+		v = vreinterpretq_u8_u32(vrev64q_u32(vreinterpretq_u32_u8(v)));
 	}
-
-	FREE(src);
-
-	// success
-	return self;
-
-	// failure
-	fail_tex:
-		FREE(src);
-	fail_read:
-		fseek(f, start, SEEK_SET);
-		FREE(src);
-	return NULL;
+	return vcombine_u8(vget_high_u8(v), vget_low_u8(v));
+	#endif
 }
 
-texgz_tex_t*
-texgz_tex_importd(size_t size, const void* data)
+#endif
+
+static void
+texgz_tex_mirrorRow(const unsigned char* src,
+                    unsigned char* dst, int width, int bpp)
 {
-	ASSERT(size > 0);
-	ASSERT(data);
+	ASSERT(src);
+	ASSERT(dst);
+	ASSERT(src != dst);
 
-	// uncompress the header
-	unsigned char header[TEXGZ_TEX_HSIZE];
-	uLong         hsize    = TEXGZ_TEX_HSIZE;
-	uLong         src_size = (uLong) size;
-	uncompress((Bytef*) header, &hsize, (const Bytef*) data,
-	           src_size);
-	if(hsize != TEXGZ_TEX_HSIZE)
+	int x  = 0;
+	int w1 = width - 1;
+
+	#if defined(__SSE2__) || defined(__ARM_NEON)
+	// 1/2/4 byte pixels are reversed 16 bytes at a time
+	if((bpp == 1) || (bpp == 2) || (bpp == 4))
 	{
-		LOGE("uncompress failed hsize=%i", (int) hsize);
-		return NULL;
+		int n = 16/bpp;
+		for(; x + n <= width; x += n)
+		{
+			texgz_tex_vec_t v;
+			v = texgz_tex_vecLoad(&src[bpp*x]);
+			texgz_tex_vecStore(&dst[bpp*(width - x - n)],
+			                   texgz_tex_vecReverse(v, bpp));
+		}
 	}
+	#endif
 
-	int type;
-	int format;
-	int width;
-	int height;
-	int stride;
-	int vstride;
-	if(texgz_parseh(header, &type, &format,
-                    &width, &height, &stride,
-	                &vstride) == 0)
+	if(bpp == 1)
 	{
-		return NULL;
+		for(; x < width; ++x)
+		{
+			dst[w1 - x] = src[x];
+		}
 	}
-
-	// create tex
-	texgz_tex_t* self;
-	self = texgz_tex_new(width, height, stride, vstride,
-	                     type, format, NULL);
-	if(self == NULL)
+	else if(bpp == 2)
 	{
-		return NULL;
+		const uint16_t* s = (const uint16_t*) src;
+		uint16_t*       d = (uint16_t*) dst;
+		for(; x < width; ++x)
+		{
+			d[w1 - x] = s[x];
+		}
 	}
-
-	// allocate dst buffer
-	int   bytes    = texgz_tex_size(self);
-	uLong dst_size =  TEXGZ_TEX_HSIZE + bytes;
-	unsigned char* dst;
-	dst = (unsigned char*)
-	      MALLOC(dst_size*sizeof(unsigned char));
-	if(dst == NULL)
+	else if(bpp == 3)
 	{
-		LOGE("MALLOC failed");
-		goto fail_dst;
+		for(; x < width; ++x)
+		{
+			int i = 3*x;
+			int j = 3*(w1 - x);
+			dst[j]     = src[i];
+			dst[j + 1] = src[i + 1];
+			dst[j + 2] = src[i + 2];
+		}
 	}
-
-	if(uncompress((Bytef*) dst, &dst_size,
-	              (const Bytef*) data, src_size) != Z_OK)
+	else if(bpp == 4)
 	{
-		LOGE("fail uncompress");
-		goto fail_uncompress;
+		const uint32_t* s = (const uint32_t*) src;
+		uint32_t*       d = (uint32_t*) dst;
+		for(; x < width; ++x)
+		{
+			d[w1 - x] = s[x];
+		}
 	}
-
-	if(dst_size != (TEXGZ_TEX_HSIZE + bytes))
+	else if(bpp == 8)
 	{
-		LOGE("invalid dst_size=%i, expected=%i",
-		     (int) dst_size, (int) (TEXGZ_TEX_HSIZE + bytes));
-		goto fail_dst_size;
+		const uint64_t* s = (const uint64_t*) src;
+		uint64_t*       d = (uint64_t*) dst;
+		for(; x < width; ++x)
+		{
+			d[w1 - x] = s[x];
+		}
+	}
+	else
+	{
+		for(; x < width; ++x)
+		{
+			memcpy(&dst[bpp*(w1 - x)], &src[bpp*x], bpp);
+		}
 	}
-
-	// copy buffer into tex
-	memcpy(self->pixels, &dst[TEXGZ_TEX_HSIZE], bytes);
-
-	FREE(dst);
-
-	// success
-	return self;
-
-	// failure
-	fail_dst_size:
-	fail_uncompress:
-		FREE(dst);
-	fail_dst:
-		texgz_tex_delete(&self);
-	return NULL;
 }
 
-int texgz_tex_export(texgz_tex_t* self,
-                     const char* filename)
+static void
+texgz_tex_mirrorRowInPlace(unsigned char* row,
+                           int width, int bpp)
 {
-	ASSERT(self);
-	ASSERT(filename);
+	ASSERT(row);
 
-	gzFile f = gzopen(filename, "wb");
-	if(f == NULL)
+	int x  = 0;
+	int w1 = width - 1;
+	int w2 = width/2;
+
+	#if defined(__SSE2__) || defined(__ARM_NEON)
+	// 1/2/4 byte pixels are swapped 16 bytes at a time
+	// from both ends until the spans would overlap
+	if((bpp == 1) || (bpp == 2) || (bpp == 4))
 	{
-		LOGE("fopen failed for %s", filename);
-		return 0;
+		int n = 16/bpp;
+		for(; x + n <= width - x - n; x += n)
+		{
+			unsigned char*  l = &row[bpp*x];
+			unsigned char*  r = &row[bpp*(width - x - n)];
+			texgz_tex_vec_t vl = texgz_tex_vecLoad(l);
+			texgz_tex_vec_t vr = texgz_tex_vecLoad(r);
+			texgz_tex_vecStore(l, texgz_tex_vecReverse(vr, bpp));
+			texgz_tex_vecStore(r, texgz_tex_vecReverse(vl, bpp));
+		}
 	}
+	#endif
 
-	// write header
-	int magic = TEXGZ_MAGIC;
-	if(gzwrite(f, (const void*) &magic,
-	           sizeof(int)) != sizeof(int))
+	if(bpp == 1)
 	{
-		LOGE("failed to write MAGIC");
-		goto fail_header;
+		for(; x < w2; ++x)
+		{
+			unsigned char t = row[x];
+			row[x]      = row[w1 - x];
+			row[w1 - x] = t;
+		}
 	}
-	if(gzwrite(f, (const void*) &self->type,
-	           sizeof(int)) != sizeof(int))
+	else if(bpp == 2)
 	{
-		LOGE("failed to write type");
-		goto fail_header;
+		uint16_t* r = (uint16_t*) row;
+		for(; x < w2; ++x)
+		{
+			uint16_t t = r[x];
+			r[x]      = r[w1 - x];
+			r[w1 - x] = t;
+		}
 	}
-	if(gzwrite(f, (const void*) &self->format,
-	           sizeof(int)) != sizeof(int))
+	else if(bpp == 3)
 	{
-		LOGE("failed to write format");
-		goto fail_header;
+		int k;
+		for(; x < w2; ++x)
+		{
+			int i = 3*x;
+			int j = 3*(w1 - x);
+			for(k = 0; k < 3; ++k)
+			{
+				unsigned char t = row[i + k];
+				row[i + k] = row[j + k];
+				row[j + k] = t;
+			}
+		}
 	}
-	if(gzwrite(f, (const void*) &self->width,
-	           sizeof(int)) != sizeof(int))
+	else if(bpp == 4)
 	{
-		LOGE("failed to write width");
-		goto fail_header;
+		uint32_t* r = (uint32_t*) row;
+		for(; x < w2; ++x)
+		{
+			uint32_t t = r[x];
+			r[x]      = r[w1 - x];
+			r[w1 - x] = t;
+		}
 	}
-	if(gzwrite(f, (const void*) &self->height,
-	           sizeof(int)) != sizeof(int))
+	else if(bpp == 8)
 	{
-		LOGE("failed to write height");
-		goto fail_header;
+		uint64_t* r = (uint64_t*) row;
+		for(; x < w2; ++x)
+		{
+			uint64_t t = r[x];
+			r[x]      = r[w1 - x];
+			r[w1 - x] = t;
+		}
 	}
-	if(gzwrite(f, (const void*) &self->stride,
-	           sizeof(int)) != sizeof(int))
+	else
 	{
-		LOGE("failed to write stride");
-		goto fail_header;
+		unsigned char t[16];
+		for(; x < w2; ++x)
+		{
+			memcpy(t, &row[bpp*x], bpp);
+			memcpy(&row[bpp*x], &row[bpp*(w1 - x)], bpp);
+			memcpy(&row[bpp*(w1 - x)], t, bpp);
+		}
 	}
-	if(gzwrite(f, (const void*) &self->vstride,
-	           sizeof(int)) != sizeof(int))
+}
+
+// channel index of R(0), G(1), B(2), A(3) in a byte
+// format or -1
+static int texgz_tex_swizzleIndex(int format, int channel)
+{
+	if(format == TEXGZ_RGBA)
 	{
-		LOGE("failed to write vstride");
-		goto fail_header;
+		return channel;
+	}
+	else if(format == TEXGZ_BGRA)
+	{
+		const int index[] = { 2, 1, 0, 3 };
+		return index[channel];
+	}
+	else if(format == TEXGZ_RGB)
+	{
+		return (channel < 3) ? channel : -1;
 	}
 
-	// get texture size and check for supported formats
-	int bytes = texgz_tex_size(self);
-	if(bytes == 0)
-		goto fail_size;
+	return -1;
+}
 
-	// write pixels
-	unsigned char* pixels = self->pixels;
-	while(bytes > 0)
+// compute the swizzle for a byte conversion between the
+// RGB/RGBA/BGRA formats where map[c] is the src channel
+// for the dst channel c or -1 for opaque alpha
+static int
+texgz_tex_swizzle(texgz_tex_t* self, int type, int format,
+                  int* map, int* src_n, int* dst_n)
+{
+	ASSERT(self);
+	ASSERT(map);
+	ASSERT(src_n);
+	ASSERT(dst_n);
+
+	if((self->type != TEXGZ_UNSIGNED_BYTE) ||
+	   (type       != TEXGZ_UNSIGNED_BYTE))
 	{
-		int bytes_written = gzwrite(f, (const void*) pixels,
-		                            bytes);
-		if(bytes_written == 0)
+		return 0;
+	}
+
+	*src_n = (self->format == TEXGZ_RGB) ? 3 : 4;
+	*dst_n = (format == TEXGZ_RGB) ? 3 : 4;
+	if((texgz_tex_swizzleIndex(self->format, 0) < 0) ||
+	   (texgz_tex_swizzleIndex(format, 0) < 0))
+	{
+		return 0;
+	}
+
+	int c;
+	for(c = 0; c < 4; ++c)
+	{
+		int dc = texgz_tex_swizzleIndex(format, c);
+		if(dc >= 0)
 		{
-			LOGE("failed to write pixels");
-			goto fail_pixels;
+			map[dc] = texgz_tex_swizzleIndex(self->format, c);
 		}
-		pixels += bytes_written;
-		bytes -= bytes_written;
 	}
 
-	gzclose(f);
-
-	// success
 	return 1;
+}
+
+typedef struct
+{
+	int    width;
+	int    height;
+	int    stride;
+	int    step;
+	int    inside;
+	int    size;
+	double inf;
+
+	// src is a byte texture with step bytes per pixel and
+	// stride bytes per row where pixels are inside for
+	// values >= 128
+	const unsigned char* src;
+
+	// g: column distance squared
+	// d: distance squared
+	double* g;
+	double* d;
+
+	// scratch per thread
+	// z: size + 1 doubles at (size + 1)*tid
+	// v: size ints at size*tid
+	double* scratch;
+	int*    v;
+} texgz_tex_edt_t;
+
+static void
+texgz_tex_edtCols(void* priv, int tid, int x0, int x1)
+{
+	ASSERT(priv);
+
+	texgz_tex_edt_t* self = (texgz_tex_edt_t*) priv;
+
+	// the squared distance to the nearest feature within
+	// the column is computed with a forward and backward
+	// scan
+	int    x;
+	int    y;
+	int    w = self->width;
+	int    h = self->height;
+	double* g = self->g;
+	for(x = x0; x < x1; ++x)
+	{
+		double dist = self->inf;
+		for(y = 0; y < h; ++y)
+		{
+			int in = (self->src[y*self->stride + self->step*x] >= 128);
+			if(in == self->inside)
+			{
+				dist = 0.0;
+			}
+			else if(dist < self->inf)
+			{
+				dist += 1.0;
+			}
+			g[y*w + x] = dist;
+		}
+
+		dist = self->inf;
+		for(y = h - 1; y >= 0; --y)
+		{
+			if(g[y*w + x] == 0.0)
+			{
+				dist = 0.0;
+			}
+			else if(dist < self->inf)
+			{
+				dist += 1.0;
+			}
+
+			if(dist < g[y*w + x])
+			{
+				g[y*w + x] = dist;
+			}
+		}
+
+		for(y = 0; y < h; ++y)
+		{
+			double gy = g[y*w + x];
+			g[y*w + x] = (gy < self->inf) ? gy*gy : self->inf;
+		}
+	}
+}
+
+static void
+texgz_tex_edtRows(void* priv, int tid, int y0, int y1)
+{
+	ASSERT(priv);
+
+	texgz_tex_edt_t* self = (texgz_tex_edt_t*) priv;
+
+	// Felzenszwalb and Huttenlocher, "Distance Transforms
+	// of Sampled Functions" computes the lower envelope of
+	// the parabolas rooted at the column distances
+	int     n = self->width;
+	double* z = &self->scratch[(self->size + 1)*tid];
+	int*    v = &self->v[self->size*tid];
+
+	int y;
+	int q;
+	int k;
+	for(y = y0; y < y1; ++y)
+	{
+		double* f = &self->g[y*n];
+		double* d = &self->d[y*n];
+
+		k    = 0;
+		v[0] = 0;
+		z[0] = -HUGE_VAL;
+		z[1] = HUGE_VAL;
+		for(q = 1; q < n; ++q)
+		{
+			int    p = v[k];
+			double s = ((f[q] + (double) q*q) -
+			            (f[p] + (double) p*p))/(2.0*(q - p));
+			while(s <= z[k])
+			{
+				--k;
+				p = v[k];
+				s = ((f[q] + (double) q*q) -
+				     (f[p] + (double) p*p))/(2.0*(q - p));
+			}
+
+			++k;
+			v[k]     = q;
+			z[k]     = s;
+			z[k + 1] = HUGE_VAL;
+		}
+
+		k = 0;
+		for(q = 0; q < n; ++q)
+		{
+			while(z[k + 1] < q)
+			{
+				++k;
+			}
+
+			double dq = (double) (q - v[k]);
+			d[q] = dq*dq + f[v[k]];
+			if(d[q] > self->inf)
+			{
+				d[q] = self->inf;
+			}
+		}
+	}
+}
+
+// compute the squared euclidean distance from each pixel
+// to the nearest pixel which is inside (or outside)
+static double*
+texgz_tex_edt(const unsigned char* src, int width,
+              int height, int stride, int step, int inside)
+{
+	ASSERT(src);
+
+	int size = (width > height) ? width : height;
+
+	texgz_tex_edt_t edt =
+	{
+		.width  = width,
+		.height = height,
+		.stride = stride,
+		.step   = step,
+		.inside = inside,
+		.size   = size,
+		.src    = src,
+	};
+
+	// larger than any distance squared but small enough
+	// that integer arithmetic remains exact
+	edt.inf = ((double) width)*width +
+	          ((double) height)*height + 1.0;
+
+	size_t count = ((size_t) width)*height;
+	edt.g = (double*) MALLOC(count*sizeof(double));
+	if(edt.g == NULL)
+	{
+		return NULL;
+	}
+
+	edt.d = (double*) MALLOC(count*sizeof(double));
+	if(edt.d == NULL)
+	{
+		goto fail_d;
+	}
+
+	size_t nth = (size_t) texgz_thread_count();
+	edt.scratch = (double*)
+	              MALLOC(nth*(size + 1)*sizeof(double));
+	if(edt.scratch == NULL)
+	{
+		goto fail_scratch;
+	}
+
+	edt.v = (int*) MALLOC(nth*size*sizeof(int));
+	if(edt.v == NULL)
+	{
+		goto fail_v;
+	}
+
+	texgz_thread_parallel(width, &edt, texgz_tex_edtCols);
+	texgz_thread_parallel(height, &edt, texgz_tex_edtRows);
+
+	FREE(edt.v);
+	FREE(edt.scratch);
+	FREE(edt.g);
+
+	// success
+	return edt.d;
 
 	// failure
-	fail_pixels:
-	fail_size:
-	fail_header:
-		gzclose(f);
-	return 0;
+	fail_v:
+		FREE(edt.scratch);
+	fail_scratch:
+		FREE(edt.d);
+	fail_d:
+		FREE(edt.g);
+	return NULL;
 }
 
-int texgz_tex_exportz(texgz_tex_t* self,
-                      const char* filename)
+static int
+texgz_tex_mipmapTaps(int method, int scale)
 {
-	ASSERT(filename);
+	// identity
+	if(scale == 1)
+	{
+		return 1;
+	}
 
-	FILE* f = fopen(filename, "w");
-	if(f == NULL)
+	if(method == TEXGZ_MIPMAP_METHOD_LANCZOS3)
 	{
-		LOGE("invalid filename=%s", filename);
-		return 0;
+		return 6*scale;
 	}
 
-	int ret = texgz_tex_exportf(self, f);
-	fclose(f);
-	return ret;
+	return scale;
 }
 
-int texgz_tex_exportf(texgz_tex_t* self, FILE* f)
+static int
+texgz_tex_mipmapMask(int method, int scale, float* mask)
 {
-	ASSERT(self);
-	ASSERT(f);
+	ASSERT(mask);
 
-	int bytes = texgz_tex_size(self);
-	if(bytes == 0)
+	// the scale must be a power-of-two so the filter
+	// center is aligned with the decimated pixels
+	if((scale <= 0) || (scale & (scale - 1)))
 	{
+		LOGE("invalid scale=%i", scale);
 		return 0;
 	}
 
-	// allocate src buffer
-	int size = bytes + TEXGZ_TEX_HSIZE;
-	unsigned char* src;
-	src = (unsigned char*) MALLOC(size*sizeof(unsigned char));
-	if(src == NULL)
+	int size = texgz_tex_mipmapTaps(method, scale);
+	if(size >= TEXGZ_LANCZOS3_MAXSIZE)
 	{
-		LOGE("MALLOC failed");
+		LOGE("invalid method=%i, scale=%i", method, scale);
 		return 0;
 	}
 
-	// copy tex to src buffer
-	int* srci = (int*) src;
-	srci[0] = TEXGZ_MAGIC;
-	srci[1] = self->type;
-	srci[2] = self->format;
-	srci[3] = self->width;
-	srci[4] = self->height;
-	srci[5] = self->stride;
-	srci[6] = self->vstride;
-	memcpy(&src[TEXGZ_TEX_HSIZE], self->pixels, bytes);
+	int i;
+	if((size == 1) || (method == TEXGZ_MIPMAP_METHOD_BOX))
+	{
+		for(i = 0; i < size; ++i)
+		{
+			mask[i] = 1.0f/((float) size);
+		}
+		return size;
+	}
+	else if(method != TEXGZ_MIPMAP_METHOD_LANCZOS3)
+	{
+		LOGE("invalid method=%i", method);
+		return 0;
+	}
 
-	// allocate dst buffer
-	uLong src_size = (uLong) (TEXGZ_TEX_HSIZE + bytes);
-	uLong dst_size = compressBound(src_size);
-	unsigned char* dst;
-	dst = (unsigned char*)
-	      MALLOC(dst_size*sizeof(unsigned char));
-	if(dst == NULL)
+	// https://github.com/jeffboody/Lanczos
+	// sample the filter symmetrically around the center
+	// of the decimated pixel and normalize the weights
+	float fs = (float) scale;
+	float x0 = 0.5f*fs - 0.5f;
+	float w  = 0.0f;
+	int   m  = 0;
+	for(i = -(3*scale) + 1; i <= (3*scale); ++i)
+	{
+		mask[m] = pil_lanczos3_filter((i - x0 + floorf(x0))/fs);
+		w += mask[m];
+		++m;
+	}
+
+	for(m = 0; m < size; ++m)
 	{
-		LOGE("MALLOC failed");
-		goto fail_dst;
+		mask[m] /= w;
 	}
 
-	// compress buffer
-	if(compress((Bytef*) dst, (uLongf*) &dst_size,
-	            (const Bytef*) src, src_size) != Z_OK)
+	return size;
+}
+
+static texgz_tex_t*
+texgz_tex_decimateF(texgz_tex_t* src, int method,
+                    int width, int height)
+{
+	ASSERT(src);
+	ASSERT(src->type   == TEXGZ_FLOAT);
+	ASSERT(src->format == TEXGZ_RGBA);
+
+	if((width  <= 0) || (src->width%width)  ||
+	   (height <= 0) || (src->height%height))
 	{
-		LOGE("compress failed");
-		goto fail_compress;
+		LOGE("invalid width=%i:%i, height=%i:%i",
+		     src->width,  width,
+		     src->height, height);
+		return NULL;
 	}
 
-	// write buffer
-	if(fwrite(dst, sizeof(unsigned char), dst_size,
-	          f) != dst_size)
+	int   scalex = src->width/width;
+	int   scaley = src->height/height;
+	float maskx[TEXGZ_LANCZOS3_MAXSIZE];
+	float masky[TEXGZ_LANCZOS3_MAXSIZE];
+	int   sizex = texgz_tex_mipmapMask(method, scalex, maskx);
+	int   sizey = texgz_tex_mipmapMask(method, scaley, masky);
+	if((sizex == 0) || (sizey == 0))
 	{
-		LOGE("fwrite failed");
-		goto fail_fwrite;
+		return NULL;
 	}
 
-	// free src and dst buffer
-	FREE(src);
-	FREE(dst);
+	texgz_tex_t* conv;
+	conv = texgz_tex_new(width, src->height,
+	                     width, src->height,
+	                     TEXGZ_FLOAT, TEXGZ_RGBA,
+	                     NULL);
+	if(conv == NULL)
+	{
+		return NULL;
+	}
+
+	texgz_tex_t* dst;
+	dst = texgz_tex_new(width, height,
+	                    width, height,
+	                    TEXGZ_FLOAT, TEXGZ_RGBA,
+	                    NULL);
+	if(dst == NULL)
+	{
+		goto fail_dst;
+	}
+
+	// apply filter and decimate
+	texgz_tex_convolveF(src,  conv,
+	                    sizex, 1, scalex, 1, maskx);
+	texgz_tex_convolveF(conv, dst,
+	                    1, sizey, 1, scaley, masky);
+
+	texgz_tex_delete(&conv);
 
 	// success
-	return 1;
+	return dst;
 
 	// failure
-	fail_fwrite:
-	fail_compress:
-		FREE(dst);
 	fail_dst:
-		FREE(src);
-	return 0;
+		texgz_tex_delete(&conv);
+	return NULL;
 }
 
-int texgz_tex_convert(texgz_tex_t* self, int type,
-                      int format)
+static void
+texgz_tex_mipmapCost(int method, int width, int height,
+                     int src, int dst,
+                     texgz_mipmapPlan_t* plan)
 {
-	ASSERT(self);
+	ASSERT(plan);
 
-	// already in requested format
-	if((type == self->type) && (format == self->format))
-		return 1;
+	int ws = (width  >> src) ? (width  >> src) : 1;
+	int hs = (height >> src) ? (height >> src) : 1;
+	int wd = (width  >> dst) ? (width  >> dst) : 1;
+	int hd = (height >> dst) ? (height >> dst) : 1;
 
-	// convert L,A,LABL
-	if((type == TEXGZ_UNSIGNED_BYTE)         &&
-	   (self->type   == TEXGZ_UNSIGNED_BYTE) &&
-	   ((format == TEXGZ_ALPHA)     ||
-	    (format == TEXGZ_LUMINANCE) ||
-	    (format == TEXGZ_LABL)) &&
-	   ((self->format == TEXGZ_ALPHA)     ||
-	    (self->format == TEXGZ_LUMINANCE) ||
-	    (self->format == TEXGZ_LABL)))
+	plan->src    = src;
+	plan->scalex = ws/wd;
+	plan->scaley = hs/hd;
+	plan->tapsx  = texgz_tex_mipmapTaps(method, plan->scalex);
+	plan->tapsy  = texgz_tex_mipmapTaps(method, plan->scaley);
+
+	// the separable filter first decimates the rows
+	// (wd x hs outputs) and then the columns (wd x hd)
+	// while the inlier filter makes two passes over each
+	// block to compute the moments and inlier average
+	if(method == TEXGZ_MIPMAP_METHOD_INLIER)
 	{
-		self->format = format;
-		return 1;
+		plan->cost = 2.0*plan->tapsx*plan->tapsy*wd*hd;
+	}
+	else
+	{
+		plan->cost = ((double) plan->tapsx)*wd*hs +
+		             ((double) plan->tapsy)*wd*hd;
 	}
-
-	texgz_tex_t* tex;
-	tex = texgz_tex_convertcopy(self, type, format);
-	if(tex == NULL)
-		return 0;
-
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
-
-	texgz_tex_delete(&tex);
-	return 1;
 }
 
-int texgz_tex_convertF(texgz_tex_t* self,
-                       float min, float max,
-                       int type, int format)
+static int
+texgz_tex_mipmapValid(int method, int width, int height,
+                      int src, int dst,
+                      texgz_mipmapPlan_t* plan)
 {
-	ASSERT(self);
+	ASSERT(plan);
 
-	// already in requested format
-	if((type == self->type) && (format == self->format))
-		return 1;
+	int ws = (width  >> src) ? (width  >> src) : 1;
+	int hs = (height >> src) ? (height >> src) : 1;
+	int wd = (width  >> dst) ? (width  >> dst) : 1;
+	int hd = (height >> dst) ? (height >> dst) : 1;
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_convertFcopy(self, min, max, type, format);
-	if(tex == NULL)
+	if((ws != plan->scalex*wd) ||
+	   (hs != plan->scaley*hd))
+	{
 		return 0;
+	}
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
+	// the separable filters are limited by the mask size
+	// (see texgz_tex_decimateF) while the inlier filter
+	// has no tap limit
+	if((method != TEXGZ_MIPMAP_METHOD_INLIER) &&
+	   ((plan->tapsx >= TEXGZ_LANCZOS3_MAXSIZE) ||
+	    (plan->tapsy >= TEXGZ_LANCZOS3_MAXSIZE)))
+	{
+		return 0;
+	}
 
-	texgz_tex_delete(&tex);
 	return 1;
 }
 
-texgz_tex_t*
-texgz_tex_convertcopy(texgz_tex_t* self, int type,
-                      int format)
+// sum the inlier block moments of fx x fy blocks of the
+// previous level to compute the w x h block moments of
+// the next level (see texgz_tex_inlierMoments)
+static void
+texgz_tex_mipmapMoments(int w, int h, int fx, int fy,
+                        const double* src, double* dst)
 {
-	ASSERT(self);
+	ASSERT(src);
+	ASSERT(dst);
 
-	// copy in the case that the src and dst formats match
-	// in particular this case prevents the conversion of
-	// 8888 to 8888
-	if((type == self->type) && (format == self->format))
-		return texgz_tex_copy(self);
+	int c;
+	int i;
+	int j;
+	int x;
+	int y;
+	int sw = fx*w;
+	for(y = 0; y < h; ++y)
+	{
+		for(x = 0; x < w; ++x)
+		{
+			double* d = &dst[8*(y*w + x)];
+			for(c = 0; c < 8; ++c)
+			{
+				d[c] = 0.0;
+			}
 
-	// convert to RGBA-8888
-	// No conversions are allowed on TEXGZ_SHORT
-	texgz_tex_t* tmp        = NULL;
-	int      tmp_delete = 1;   // delete if self is not 8888
-	if((self->type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) &&
-	   (self->format == TEXGZ_RGBA))
-		tmp = texgz_tex_4444to8888(self);
-	else if((self->type == TEXGZ_UNSIGNED_SHORT_5_6_5) &&
-	        (self->format == TEXGZ_RGB))
-		tmp = texgz_tex_565to8888(self);
-	else if((self->type == TEXGZ_UNSIGNED_SHORT_5_5_5_1) &&
-	        (self->format == TEXGZ_RGBA))
-		tmp = texgz_tex_5551to8888(self);
-	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_RGB))
-		tmp = texgz_tex_888to8888(self);
-	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_LUMINANCE))
-		tmp = texgz_tex_Lto8888(self);
-	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_ALPHA))
-		tmp = texgz_tex_Ato8888(self);
-	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_LUMINANCE_ALPHA))
+			for(i = 0; i < fy; ++i)
+			{
+				const double* m = &src[8*((fy*y + i)*sw + fx*x)];
+				for(j = 0; j < fx; ++j)
+				{
+					for(c = 0; c < 8; ++c)
+					{
+						d[c] += m[8*j + c];
+					}
+				}
+			}
+		}
+	}
+}
+
+// filter the inlier levels in the input type where a level
+// filtered from the same source as the previous level
+// (e.g. every level when depth=1) reuses the block
+// moments of the previous level rather than revisiting
+// the samples
+static int
+texgz_tex_mipmapInlier(texgz_tex_t* self, int miplevels,
+                       const texgz_mipmapPlan_t* plan,
+                       texgz_tex_t** levels)
+{
+	ASSERT(self);
+	ASSERT(plan);
+	ASSERT(levels);
+
+	int     l;
+	double* prev = NULL;
+	double* moments;
+	for(l = 1; l < miplevels; ++l)
 	{
-		if(format == TEXGZ_RG00)
+		if((plan[l].src < 0) || (plan[l].src >= l))
 		{
-			tmp    = texgz_tex_LAto8800(self);
-			format = TEXGZ_RGBA;
+			LOGE("invalid level=%i, src=%i", l, plan[l].src);
+			goto fail_level;
+		}
+
+		texgz_tex_t* src = levels[plan[l].src];
+
+		int sx = plan[l].scalex;
+		int sy = plan[l].scaley;
+		if((sx <= 0) || (sy <= 0) ||
+		   (src->width%sx != 0) || (src->height%sy != 0))
+		{
+			LOGE("invalid level=%i, sx=%i, sy=%i", l, sx, sy);
+			goto fail_level;
+		}
+
+		int w = src->width/sx;
+		int h = src->height/sy;
+
+		// the previous moments are reused when the block
+		// size is a multiple of the previous block size and
+		// the moments are only kept when they are smaller
+		// than the block samples (e.g. 8x8 RGBA8 blocks)
+		// since the fine levels are bandwidth bound
+		int reuse = prev &&
+		            (plan[l - 1].src == plan[l].src) &&
+		            (sx%plan[l - 1].scalex == 0) &&
+		            (sy%plan[l - 1].scaley == 0);
+		int keep  = (l + 1 < miplevels) &&
+		            (plan[l + 1].src == plan[l].src) &&
+		            (sx*sy*texgz_tex_bpp(src) >
+		             (int) (8*sizeof(double)));
+
+		moments = NULL;
+		if(reuse || keep)
+		{
+			moments = (double*)
+			          MALLOC(8*w*h*sizeof(double));
+			if(moments == NULL)
+			{
+				LOGE("MALLOC failed");
+				goto fail_level;
+			}
+		}
+
+		if(reuse)
+		{
+			texgz_tex_mipmapMoments(w, h,
+			                        sx/plan[l - 1].scalex,
+			                        sy/plan[l - 1].scaley,
+			                        prev, moments);
+		}
+
+		levels[l] = texgz_tex_inlierMoments(src, sx, sy,
+		                                    TEXGZ_MIPMAP_INLIER_SDX,
+		                                    src->type,
+		                                    moments, reuse);
+
+		FREE(prev);
+		prev = NULL;
+		if(keep)
+		{
+			prev = moments;
 		}
 		else
 		{
-			tmp = texgz_tex_LAto8888(self);
+			FREE(moments);
+		}
+
+		if(levels[l] == NULL)
+		{
+			goto fail_level;
 		}
 	}
-	else if((self->type == TEXGZ_FLOAT) &&
-	        (self->format == TEXGZ_LUMINANCE))
-		tmp = texgz_tex_Fto8888(self, 0.0f, 1.0f);
-	else if((self->type == TEXGZ_FLOAT) &&
-	        (self->format == TEXGZ_RGBA))
-		tmp = texgz_tex_FFFFto8888(self, 0.0f, 1.0f);
-	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_BGRA))
-		tmp = texgz_tex_8888format(self, TEXGZ_RGBA);
-	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_RGBA))
+
+	FREE(prev);
+
+	// success
+	return 1;
+
+	// failure
+	fail_level:
+		FREE(prev);
+	return 0;
+}
+
+static int texgz_clampi(int v, int min, int max)
+{
+	ASSERT(min < max);
+
+	if(v < min)
 	{
-		tmp        = self;
-		tmp_delete = 0;
+		v = min;
+	}
+	else if(v > max)
+	{
+		v = max;
 	}
+	return v;
+}
 
-	// check for errors
-	if(tmp == NULL)
+/*
+ * public
+ */
+
+texgz_tex_t*
+texgz_tex_new(int width, int height,
+              int stride, int vstride,
+              int type, int format,
+              unsigned char* pixels)
+{
+	// pixels can be NULL
+
+	if((stride <= 0) || (width > stride))
 	{
-		LOGE("could not convert to 8888");
+		LOGE("invalid width=%i, stride=%i",
+		     width, stride);
+		return NULL;
+	}
+
+	if((vstride <= 0) || (height > vstride))
+	{
+		LOGE("invalid height=%i, vstride=%i",
+		     height, vstride);
 		return NULL;
 	}
 
-	// convert to requested format
-	texgz_tex_t* tex = NULL;
 	if((type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) &&
 	   (format == TEXGZ_RGBA))
-		tex = texgz_tex_8888to4444(tmp);
+		; // ok
+	else if((type == TEXGZ_UNSIGNED_SHORT_5_5_5_1) &&
+	        (format == TEXGZ_RGBA))
+		; // ok
 	else if((type == TEXGZ_UNSIGNED_SHORT_5_6_5) &&
 	        (format == TEXGZ_RGB))
-		tex = texgz_tex_8888to565(tmp);
-	else if((type == TEXGZ_UNSIGNED_SHORT_5_5_5_1) &&
+		; // ok
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
 	        (format == TEXGZ_RGBA))
-		tex = texgz_tex_8888to5551(tmp);
+		; // ok
 	else if((type == TEXGZ_UNSIGNED_BYTE) &&
 	        (format == TEXGZ_RGB))
-		tex = texgz_tex_8888to888(tmp);
+		; // ok
 	else if((type == TEXGZ_UNSIGNED_BYTE) &&
 	        (format == TEXGZ_LUMINANCE))
-		tex = texgz_tex_8888toL(tmp);
+		; // ok
 	else if((type == TEXGZ_UNSIGNED_BYTE) &&
 	        (format == TEXGZ_LABL))
-		tex = texgz_tex_8888toLABL(tmp);
+		; // ok
 	else if((type == TEXGZ_UNSIGNED_BYTE) &&
 	        (format == TEXGZ_ALPHA))
-		tex = texgz_tex_8888toA(tmp);
+		; // ok
+	else if((type == TEXGZ_SHORT) &&
+	        (format == TEXGZ_LUMINANCE))
+		; // ok
+	else if((type == TEXGZ_UNSIGNED_SHORT) &&
+	        (format == TEXGZ_LUMINANCE))
+		; // ok
+	else if((type == TEXGZ_UNSIGNED_INT) &&
+	        (format == TEXGZ_LUMINANCE))
+		; // ok
 	else if((type == TEXGZ_UNSIGNED_BYTE) &&
 	        (format == TEXGZ_LUMINANCE_ALPHA))
-		tex = texgz_tex_8888toLA(tmp);
+		; // ok
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_BGRA))
+		; // ok
 	else if((type == TEXGZ_FLOAT) &&
 	        (format == TEXGZ_LUMINANCE))
-		tex = texgz_tex_8888toF(tmp);
+		; // ok
 	else if((type == TEXGZ_FLOAT) &&
 	        (format == TEXGZ_RGBA))
-		tex = texgz_tex_8888toFFFF(tmp, 0.0f, 1.0f);
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_BGRA))
-		tex = texgz_tex_8888format(tmp, TEXGZ_BGRA);
-	else if((type == TEXGZ_UNSIGNED_BYTE) &&
-	        (format == TEXGZ_RGBA))
+		; // ok
+	else if((type == TEXGZ_FLOAT) &&
+	        (format == TEXGZ_LUMINANCE_ALPHA))
+		; // ok
+	else
 	{
-		// note that tex will never equal self because of the
-		// shortcut copy
-		tex        = tmp;
-		tmp_delete = 0;
+		LOGE("invalid type=0x%X, format=0x%X",
+		     type, format);
+		return NULL;
 	}
 
-	// cleanup
-	if(tmp_delete == 1)
-		texgz_tex_delete(&tmp);
-
-	// check for errors
-	if(tex == NULL)
+	texgz_tex_t* self;
+	self = (texgz_tex_t*) MALLOC(sizeof(texgz_tex_t));
+	if(self == NULL)
 	{
-		LOGE("could not convert to type=0x%X, format=0x%X",
-		     type, format);
+		LOGE("MALLOC failed");
 		return NULL;
 	}
 
+	self->width   = width;
+	self->height  = height;
+	self->stride  = stride;
+	self->vstride = vstride;
+	self->type    = type;
+	self->format  = format;
+
+	int size = texgz_tex_size(self);
+	if(size == 0)
+	{
+		LOGE("invalid type=%i, format=%i", type, format);
+		goto fail_bpp;
+	}
+
+	self->pixels = (unsigned char*) MALLOC((size_t) size);
+	if(self->pixels == NULL)
+	{
+		LOGE("MALLOC failed");
+		goto fail_pixels;
+	}
+
+	if(pixels == NULL)
+		memset(self->pixels, 0, size);
+	else
+		memcpy(self->pixels, pixels, size);
+
 	// success
-	return tex;
+	return self;
+
+	// failure
+	fail_pixels:
+	fail_bpp:
+		FREE(self);
+	return NULL;
 }
 
-texgz_tex_t*
-texgz_tex_convertFcopy(texgz_tex_t* self,
-                       float min, float max,
-                       int type, int format)
+void texgz_tex_delete(texgz_tex_t** _self)
 {
-	ASSERT(self);
+	ASSERT(_self);
 
-	if((self->type   == TEXGZ_FLOAT)         &&
-	   (self->format == TEXGZ_RGBA)          &&
-	   (type         == TEXGZ_UNSIGNED_BYTE) &&
-	   (format       == TEXGZ_RGBA))
+	texgz_tex_t* self = *_self;
+	if(self)
 	{
-		return texgz_tex_FFFFto8888(self, min, max);
+		FREE(self->pixels);
+		FREE(self);
+		*_self = NULL;
 	}
-	else if((self->type   == TEXGZ_FLOAT)         &&
-	        (self->format == TEXGZ_LUMINANCE)     &&
-	        (type         == TEXGZ_UNSIGNED_BYTE) &&
-	        (format       == TEXGZ_RGBA))
-	{
-		return texgz_tex_Fto8888(self, min, max);
-	}
-	else if((self->type   == TEXGZ_FLOAT)         &&
-	        (self->format == TEXGZ_LUMINANCE)     &&
-	        (type         == TEXGZ_UNSIGNED_BYTE) &&
-	        (format       == TEXGZ_LUMINANCE))
-	{
-		return texgz_tex_Fto8(self, min, max);
-	}
-	else if((self->type   == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_LUMINANCE)     &&
-	        (type         == TEXGZ_FLOAT)         &&
-	        (format       == TEXGZ_LUMINANCE))
-	{
-		return texgz_tex_8toF(self, min, max);
-	}
-	else if((self->type   == TEXGZ_UNSIGNED_BYTE) &&
-	        (self->format == TEXGZ_RGBA)          &&
-	        (type         == TEXGZ_FLOAT)         &&
-	        (format       == TEXGZ_RGBA))
+}
+
+texgz_tex_t* texgz_tex_copy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	return texgz_tex_new(self->width, self->height,
+                         self->stride, self->vstride,
+                         self->type, self->format,
+                         self->pixels);
+}
+
+texgz_tex_t* texgz_tex_downscale(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	// only support even/one w/h textures
+	int w = self->width;
+	int h = self->height;
+	if(((w == 1) || (w%2 == 0)) &&
+	   ((h == 1) || (h%2 == 0)))
 	{
-		return texgz_tex_8888toFFFF(self, min, max);
+		// continue
 	}
 	else
 	{
-		LOGE("invalid type=0x%X:0x%X, format=0x%X:0x%X",
-		     self->type, type, self->format, format);
+		LOGE("invalid w=%i, h=%i", w, h);
 		return NULL;
 	}
-}
 
-texgz_tex_t* texgz_tex_grayscaleF(texgz_tex_t* self)
-{
-	ASSERT(self);
-	ASSERT(self->type == TEXGZ_FLOAT);
+	// handle 1x1 special case
+	if((w == 1) && (h == 1))
+	{
+		return texgz_tex_copy(self);
+	}
 
-	// channels
-	int n;
-	if(self->format == TEXGZ_RGBA)
+	// convert to unsigned bytes
+	int type = self->type;
+	texgz_tex_t* src;
+	if(type == TEXGZ_UNSIGNED_BYTE)
 	{
-		n = 4;
+		src = self;
 	}
-	else if(self->format == TEXGZ_RGB)
+	else if((type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) ||
+	        (type == TEXGZ_UNSIGNED_SHORT_5_5_5_1))
 	{
-		n = 3;
+		src = texgz_tex_convertcopy(self,
+		                            TEXGZ_UNSIGNED_BYTE,
+		                            TEXGZ_RGBA);
+	}
+	else if(type == TEXGZ_UNSIGNED_SHORT_5_6_5)
+	{
+		src = texgz_tex_convertcopy(self,
+		                            TEXGZ_UNSIGNED_BYTE,
+		                            TEXGZ_RGB);
 	}
 	else
 	{
-		LOGE("invalid format=0x%X", self->format);
+		LOGE("invalid type=0x%X", type);
 		return NULL;
 	}
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    self->stride, self->vstride,
-	                    TEXGZ_FLOAT, TEXGZ_LUMINANCE,
-	                    NULL);
-	if(tex == NULL)
+	// check the conversion (if needed)
+	if(src == NULL)
 	{
 		return NULL;
 	}
 
-	float src[4] = { 0 };
-	float dst;
+	// create downscale texture
+	w = (w == 1) ? 1 : w/2;
+	h = (h == 1) ? 1 : h/2;
+	texgz_tex_t* down;
+	down = texgz_tex_new(w, h, w, h, src->type, src->format,
+	                     NULL);
+	if(down == NULL)
+	{
+		goto fail_new;
+	}
+
+	// downscale with box filter
+	int   i;
 	int   x;
 	int   y;
-	int   i;
-	for(y = 0; y < self->height; ++y)
+	float p00;
+	float p01;
+	float p10;
+	float p11;
+	float avg;
+	int   bpp        = texgz_tex_bpp(src);
+	int   bpp2       = 2*bpp;
+	int   src_step   = bpp*src->stride;
+	int   dst_step   = bpp*down->stride;
+	int   src_offset00;
+	int   src_offset01;
+	int   src_offset10;
+	int   src_offset11;
+	int   dst_offset;
+	unsigned char* src_pixels = src->pixels;
+	unsigned char* dst_pixels = down->pixels;
+	if(src->width == 1)
 	{
-		for(x = 0; x < self->width; ++x)
+		for(y = 0; y < src->height; y += 2)
 		{
-			dst = 0.0f;
-			texgz_tex_getPixelF(self, x, y, src);
-			for(i = 0; i < n; ++i)
+			src_offset00 = y*src_step;
+			src_offset10 = src_offset00 + src_step;
+			dst_offset   = (y/2)*dst_step;
+			for(i = 0; i < bpp; ++i)
 			{
-				dst += src[i];
+				p00 = (float) src_pixels[src_offset00 + i];
+				p10 = (float) src_pixels[src_offset10 + i];
+				avg = (p00 + p10)/2.0f;
+				dst_pixels[dst_offset + i] = (unsigned char) avg;
 			}
-			dst /= n;
-
-			texgz_tex_setPixelF(tex, x, y, &dst);
 		}
 	}
-
-	return tex;
-}
-
-int texgz_tex_RGB2LABF(texgz_tex_t* self,
-                       texgz_tex_t** _labl,
-                       texgz_tex_t** _laba,
-                       texgz_tex_t** _labb)
-{
-	ASSERT(self);
-	ASSERT(_labl);
-	ASSERT(_laba);
-	ASSERT(_labb);
-
-	// check for supported type/format
-	int channels = 0;
-	if(self->type == TEXGZ_UNSIGNED_BYTE)
+	else if(src->height == 1)
 	{
-		if(self->format == TEXGZ_RGBA)
+		src_offset00 = 0;
+		src_offset01 = bpp;
+		dst_offset   = 0;
+		for(x = 0; x < src->width; x += 2)
 		{
-			channels = 4;
+			for(i = 0; i < bpp; ++i)
+			{
+				p00 = (float) src_pixels[src_offset00 + i];
+				p01 = (float) src_pixels[src_offset01 + i];
+				avg = (p00 + p01)/2.0f;
+				dst_pixels[dst_offset + i] = (unsigned char) avg;
+			}
+			src_offset00 += bpp2;
+			src_offset01 += bpp2;
+			dst_offset   += bpp;
 		}
-		else if(self->format == TEXGZ_RGB)
+	}
+	else
+	{
+		for(y = 0; y < src->height; y += 2)
 		{
-			channels = 3;
+			src_offset00 = y*src_step;
+			src_offset01 = src_offset00 + bpp;
+			src_offset10 = src_offset00 + src_step;
+			src_offset11 = src_offset10 + bpp;
+			dst_offset   = (y/2)*dst_step;
+			for(x = 0; x < src->width; x += 2)
+			{
+				for(i = 0; i < bpp; ++i)
+				{
+					p00 = (float) src_pixels[src_offset00 + i];
+					p01 = (float) src_pixels[src_offset01 + i];
+					p10 = (float) src_pixels[src_offset10 + i];
+					p11 = (float) src_pixels[src_offset11 + i];
+					avg = (p00 + p01 + p10 + p11)/4.0f;
+					dst_pixels[dst_offset + i] = (unsigned char) avg;
+				}
+				src_offset00 += bpp2;
+				src_offset01 += bpp2;
+				src_offset10 += bpp2;
+				src_offset11 += bpp2;
+				dst_offset   += bpp;
+			}
 		}
 	}
 
-	if(channels == 0)
+	// convert to input type
+	if(type == TEXGZ_UNSIGNED_SHORT_4_4_4_4)
 	{
-		LOGE("invalid type=0x%X, format=0x%X",
-		     self->type, self->format);
-		return 0;
+		if(texgz_tex_convert(down,
+		                     TEXGZ_UNSIGNED_SHORT_4_4_4_4,
+		                     TEXGZ_RGBA) == 0)
+		{
+			goto fail_convert;
+		}
 	}
-
-	texgz_tex_t* labl;
-	labl = texgz_tex_new(self->width, self->height,
-	                     self->stride, self->vstride,
-	                     TEXGZ_FLOAT, TEXGZ_LUMINANCE,
-	                     NULL);
-	if(labl == NULL)
+	else if(type == TEXGZ_UNSIGNED_SHORT_5_5_5_1)
 	{
-		return 0;
+		if(texgz_tex_convert(down,
+		                     TEXGZ_UNSIGNED_SHORT_5_5_5_1,
+		                     TEXGZ_RGBA) == 0)
+		{
+			goto fail_convert;
+		}
 	}
-
-	texgz_tex_t* laba;
-	laba = texgz_tex_new(self->width, self->height,
-	                     self->stride, self->vstride,
-	                     TEXGZ_FLOAT, TEXGZ_LUMINANCE,
-	                     NULL);
-	if(laba == NULL)
+	else if(type == TEXGZ_UNSIGNED_SHORT_5_6_5)
 	{
-		goto fail_laba;
+		if(texgz_tex_convert(down,
+		                     TEXGZ_UNSIGNED_SHORT_5_6_5,
+		                     TEXGZ_RGB) == 0)
+		{
+			goto fail_convert;
+		}
 	}
 
-	texgz_tex_t* labb;
-	labb = texgz_tex_new(self->width, self->height,
-	                     self->stride, self->vstride,
-	                     TEXGZ_FLOAT, TEXGZ_LUMINANCE,
-	                     NULL);
-	if(labb == NULL)
+	// delete the temporary texture
+	if(type != TEXGZ_UNSIGNED_BYTE)
 	{
-		goto fail_labb;
+		texgz_tex_delete(&src);
 	}
 
-	// See rgb2lab
-	// https://github.com/antimatter15/rgb-lab/blob/master/color.js
-	float r;
-	float g;
-	float b;
-	float xx;
-	float yy;
-	float zz;
-	float pixel_labl[4] = { 0 };
-	float pixel_laba[4] = { 0 };
-	float pixel_labb[4] = { 0 };
-	int x, y, idx;
-	unsigned char* pixel_src;
-	for(y = 0; y < self->height; ++y)
-	{
-		for(x = 0; x < self->width; ++x)
-		{
-			idx       = y*self->stride + x;
-			pixel_src = &self->pixels[channels*idx];
-
-			r = ((float) pixel_src[0])/255.0f;
-			g = ((float) pixel_src[1])/255.0f;
-			b = ((float) pixel_src[2])/255.0f;
-
-			r = (r > 0.04045f) ? powf((r + 0.055f)/1.055f, 2.4f) : r/12.92f;
-			g = (g > 0.04045f) ? powf((g + 0.055f)/1.055f, 2.4f) : g/12.92f;
-			b = (b > 0.04045f) ? powf((b + 0.055f)/1.055f, 2.4f) : b/12.92f;
-
-			xx = (r*0.4124f + g*0.3576f + b*0.1805f)/0.95047f;
-			yy = (r*0.2126f + g*0.7152f + b*0.0722f)/1.00000f;
-			zz = (r*0.0193f + g*0.1192f + b*0.9505f)/1.08883f;
-
-			xx = (xx > 0.008856f) ? powf(xx, 0.333333f) : (7.787f*xx) + 16.0f/116.0f;
-			yy = (yy > 0.008856f) ? powf(yy, 0.333333f) : (7.787f*yy) + 16.0f/116.0f;
-			zz = (zz > 0.008856f) ? powf(zz, 0.333333f) : (7.787f*zz) + 16.0f/116.0f;
-
-			pixel_labl[0] = 116.0f*yy - 16.0f;
-			pixel_laba[0] = 500.0f*(xx - yy);
-			pixel_labb[0] = 200.0f*(yy - zz);
-
-			texgz_tex_setPixelF(labl, x, y, pixel_labl);
-			texgz_tex_setPixelF(laba, x, y, pixel_laba);
-			texgz_tex_setPixelF(labb, x, y, pixel_labb);
-		}
-	}
-
-	*_labl = labl;
-	*_laba = laba;
-	*_labb = labb;
-
 	// success
-	return 1;
+	return down;
 
 	// failure
-	fail_labb:
-		texgz_tex_delete(&laba);
-	fail_laba:
-		texgz_tex_delete(&labl);
-	return 0;
+	fail_convert:
+		texgz_tex_delete(&down);
+	fail_new:
+		if(type != TEXGZ_UNSIGNED_BYTE)
+		{
+			texgz_tex_delete(&src);
+		}
+	return NULL;
 }
 
 texgz_tex_t*
-texgz_tex_channelF(texgz_tex_t* self, int channel,
-                   float min, float max)
+texgz_tex_lanczos3(texgz_tex_t* self, int level)
 {
 	ASSERT(self);
 
-	int channels = texgz_tex_channels(self);
-	if((channels == 0) || (channel >= channels))
+	// https://github.com/jeffboody/Lanczos
+
+	int src_width  = self->width;
+	int src_height = self->height;
+	int dst_width  = src_width/cc_pow2n(level);
+	int dst_height = src_height/cc_pow2n(level);
+
+	if((src_width%dst_width) || (src_height%dst_height))
 	{
-		LOGE("invalid format=0x%X, channel=%i",
-		     self->format, channel);
+		LOGE("invalid width=%i:%i, height=%i:%i",
+		     src_width,  dst_width,
+		     src_height, dst_height);
 		return NULL;
 	}
 
-	// check type
-	if((self->type == TEXGZ_FLOAT) ||
-	   (self->type == TEXGZ_UNSIGNED_BYTE))
-	{
-		// ok
-	}
-	else
+	// float inputs are filtered directly and returned as float
+	if((self->type   == TEXGZ_FLOAT) &&
+	   (self->format == TEXGZ_RGBA))
 	{
-		LOGE("invalid type=0x%X", self->type);
-		return NULL;
+		return texgz_tex_decimateF(self,
+		                           TEXGZ_MIPMAP_METHOD_LANCZOS3,
+		                           dst_width, dst_height);
 	}
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    self->stride, self->vstride,
-	                    TEXGZ_FLOAT, TEXGZ_LUMINANCE,
-	                    NULL);
-	if(tex == NULL)
+	texgz_tex_t* src;
+	src = texgz_tex_convertFcopy(self, 0.0f, 1.0f,
+	                             TEXGZ_FLOAT, TEXGZ_RGBA);
+	if(src == NULL)
 	{
 		return NULL;
 	}
 
-	// copy channel
-	int x;
-	int y;
-	unsigned char srcu[4] = { 0 };
-	float         srcf[4] = { 0 };
-	float         dstf[4] = { 0 };
-	if(self->type == TEXGZ_FLOAT)
+	// apply filter and decimate
+	texgz_tex_t* dst;
+	dst = texgz_tex_decimateF(src, TEXGZ_MIPMAP_METHOD_LANCZOS3,
+	                          dst_width, dst_height);
+	if(dst == NULL)
 	{
-		for(y = 0; y < self->height; ++y)
-		{
-			for(x = 0; x < self->width; ++x)
-			{
-				// ignore min/max for floats
-				texgz_tex_getPixelF(self, x, y, srcf);
-				dstf[0] = srcf[channel];
-				texgz_tex_setPixelF(tex, x, y, dstf);
-			}
-		}
+		goto fail_dst;
 	}
-	else
+
+	if(texgz_tex_convertF(dst, 0.0f, 1.0f,
+	                      TEXGZ_UNSIGNED_BYTE,
+	                      TEXGZ_RGBA) == 0)
 	{
-		for(y = 0; y < self->height; ++y)
-		{
-			for(x = 0; x < self->width; ++x)
-			{
-				texgz_tex_getPixel(self, x, y, srcu);
-				srcf[0] = (float) srcu[channel];
-				dstf[0] = (max - min)*srcf[0]/255.0f + min;
-				texgz_tex_setPixelF(tex, x, y, dstf);
-			}
-		}
+		goto fail_convert;
 	}
 
-	return tex;
+	texgz_tex_delete(&src);
+
+	// success
+	return dst;
+
+	// failure
+	fail_convert:
+		texgz_tex_delete(&dst);
+	fail_dst:
+		texgz_tex_delete(&src);
+	return NULL;
 }
 
-void
-texgz_tex_convolveF(texgz_tex_t* src, texgz_tex_t* dst,
-                    int mw, int mh,
-                    int stride, int vstride,
-                    float* mask)
+texgz_tex_t* texgz_tex_resize(texgz_tex_t* self,
+                              int width,
+                              int height)
 {
-	ASSERT(src);
-	ASSERT(dst);
-	ASSERT(mask);
-	ASSERT(src->width  == (stride*dst->width));
-	ASSERT(src->height == (vstride*dst->height));
-	ASSERT(src->type == TEXGZ_FLOAT);
-	ASSERT(dst->type == TEXGZ_FLOAT);
-	ASSERT(texgz_tex_channels(src) ==
-	       texgz_tex_channels(dst));
-
-	// compute center offset
-	// examples:
-	// 1) Sobel Edge: stride=1, mw=3
-	//    +---+---+---+
-	//    | 0 | 1 | 2 |
-	//    +---+---+---+
-	//    |   | C |   |
-	//    +---+---+---+
-	//
-	// 2) Box Downsample: stride=2, mw=2
-	//    +---+---+
-	//    | 0 | 1 |
-	//    +---+---+
-	//    | C |   |
-	//    +---+---+
-	//
-	// 3) Lanczos3 Downsample: stride=2, mw=12
-	//    +---+---+---+---+---+---+---+---+---+---+---+---+
-	//    | 0 | 1 | 2 | 3 | 4 | 5 | 6 | 7 | 8 | 9 | A | B |
-	//    +---+---+---+---+---+---+---+---+---+---+---+---+
-	//    |   |   |   |   |   | C |   |   |   |   |   |   |
-	//    +---+---+---+---+---+---+---+---+---+---+---+---+
-	int cm = (mh - vstride)/2;
-	int cn = (mw - stride)/2;
+	ASSERT(self);
+	ASSERT(self->type == TEXGZ_UNSIGNED_BYTE);
+	ASSERT((self->format == TEXGZ_RGB) ||
+	       (self->format == TEXGZ_RGBA));
 
-	int i;
-	int j;
-	int c;
-	int m;
-	int n;
-	int w        = src->width;
-	int h        = src->height;
-	int channels = texgz_tex_channels(src);
-	float pixel[4];
-	float f[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-	for(i = 0; i < h; i += vstride)
+	texgz_tex_t* copy;
+	copy = texgz_tex_new(width, height,
+	                     width, height,
+	                     self->type, self->format,
+	                     NULL);
+	if(copy == NULL)
 	{
-		for(j = 0; j < w; j += stride)
-		{
-			for(c = 0; c < channels; ++c)
-			{
-				f[c] = 0.0f;
-			}
-
-			// convolve
-			for(m = 0; m < mh; ++m)
-			{
-				for(n = 0; n < mw; ++n)
-				{
-					texgz_tex_getClampedPixelF(src, j + n - cn,
-					                           i + m - cm, pixel);
-
-					for(c = 0; c < channels; ++c)
-					{
-						f[c] += mask[m*mw + n]*pixel[c];
-					}
-				}
-			}
-
-			// decimate and fill pixel
-			texgz_tex_setPixelF(dst, j/stride, i/vstride, f);
-		}
+		return NULL;
 	}
-}
 
-int texgz_tex_blur(texgz_tex_t* self, float sigma,
-                   float mu, int size)
-{
-	texgz_tex_t* tex;
-	tex = texgz_tex_blurcopy(self, sigma, mu, size);
-	if(tex == NULL)
+	int bpp = texgz_tex_bpp(self);
+
+	int   i;
+	int   j;
+	float u;
+	float v;
+	unsigned char pixel[4];
+	for(i = 0; i < height; ++i)
 	{
-		return 0;
+		for(j = 0; j < width; ++j)
+		{
+			u = (((float) j) + 0.5f)/((float) width);
+			v = (((float) i) + 0.5f)/((float) height);
+			texgz_tex_sample(self, u, v, bpp, pixel);
+			texgz_tex_setPixel(copy, j, i, pixel);
+		}
 	}
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
-
-	texgz_tex_delete(&tex);
-	return 1;
+	return copy;
 }
 
-texgz_tex_t*
-texgz_tex_blurcopy(texgz_tex_t* self, float sigma,
-                   float mu, int size)
+texgz_tex_t* texgz_tex_import(const char* filename)
 {
-	ASSERT(self);
+	ASSERT(filename);
 
-	// blur is designed for 4-channel RGBA
-	if((self->type   != TEXGZ_UNSIGNED_BYTE) ||
-	   (self->format != TEXGZ_RGBA))
+	// open texture
+	gzFile f = gzopen(filename, "rb");
+	if(!f)
 	{
-		LOGE("invalid type=%i, format=%i",
-		     self->type, self->format);
+		LOGE("gzopen failed filename=%s", filename);
 		return NULL;
 	}
 
-	const int max_size = 7;
-	if(size > max_size)
+	// read header
+	unsigned char buffer[4096];   // 4KB
+	int bytes_read = gzread(f, buffer, TEXGZ_TEX_HSIZE);
+	if(bytes_read != TEXGZ_TEX_HSIZE)
 	{
-		LOGE("invalid size=%i", size);
-		return NULL;
+		LOGE("gzread failed to read header");
+		goto fail_header;
 	}
 
-	float mask[max_size];
-	if(texgz_tex_gaussianCoef(sigma, mu, size, mask) == 0)
-	{
-		return NULL;
-	}
-
-	texgz_tex_t* tex;
-	tex = texgz_tex_convertFcopy(self, 0.0f, 1.0f,
-	                             TEXGZ_FLOAT, TEXGZ_RGBA);
-	if(tex == NULL)
+	int type;
+	int format;
+	int width;
+	int height;
+	int stride;
+	int vstride;
+	if(texgz_parseh(buffer, &type, &format,
+                    &width, &height, &stride, &vstride) == 0)
 	{
-		return NULL;
+		goto fail_parseh;
 	}
 
-	texgz_tex_t* conv;
-	conv = texgz_tex_new(tex->width, tex->width,
-	                     tex->stride, tex->vstride,
-	                     tex->type, tex->format,
-	                     NULL);
-	if(conv == NULL)
-	{
-		goto fail_conv;
-	}
+	texgz_tex_t* self;
+	self = texgz_tex_new(width, height, stride, vstride,
+	                     type, format, NULL);
+	if(self == NULL)
+		goto fail_tex;
 
-	texgz_tex_convolveF(tex, conv, size, 1, 1, 1, mask);
-	texgz_tex_convolveF(conv, tex, 1, size, 1, 1, mask);
+	// get texture size and check for supported formats
+	int bytes = texgz_tex_size(self);
+	if(bytes == 0)
+		goto fail_size;
 
-	if(texgz_tex_convertF(tex, 0.0f, 1.0f,
-	                      TEXGZ_UNSIGNED_BYTE,
-	                      TEXGZ_RGBA) == 0)
+	// read pixels
+	unsigned char* pixels = self->pixels;
+	while(bytes > 0)
 	{
-		goto fail_convert;
+		int bytes_read = gzread(f, pixels, bytes);
+		if(bytes_read == 0)
+		{
+			LOGE("failed to read pixels");
+			goto fail_pixels;
+		}
+		pixels += bytes_read;
+		bytes -= bytes_read;
 	}
 
-	texgz_tex_delete(&conv);
-
 	// success
-	return tex;
+	gzclose(f);
+	return self;
 
-	fail_convert:
-		texgz_tex_delete(&conv);
-	fail_conv:
-		texgz_tex_delete(&tex);
+	// failure
+	fail_pixels:
+	fail_size:
+		texgz_tex_delete(&self);
+	fail_tex:
+	fail_parseh:
+	fail_header:
+		gzclose(f);
 	return NULL;
 }
 
-int texgz_tex_rotate90(texgz_tex_t* self)
+texgz_tex_t* texgz_tex_importz(const char* filename)
 {
-	texgz_tex_t* tex;
-	tex = texgz_tex_rotate90copy(self);
-	if(tex == NULL)
+	ASSERT(filename);
+
+	FILE* f = fopen(filename, "r");
+	if(f == NULL)
 	{
-		return 0;
+		LOGE("invalid filename=%s", filename);
+		return NULL;
 	}
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
+	// determine the file size
+	fseek(f, (long) 0, SEEK_END);
+	int fsize = (int) ftell(f);
+	rewind(f);
 
-	texgz_tex_delete(&tex);
-	return 1;
+	texgz_tex_t* tex = texgz_tex_importf(f, fsize);
+	fclose(f);
+	return tex;
 }
 
-texgz_tex_t*
-texgz_tex_rotate90copy(texgz_tex_t* self)
+texgz_tex_t* texgz_tex_importf(FILE* f, int size)
 {
-	ASSERT(self);
+	ASSERT(f);
+	ASSERT(size > 0);
 
-	if(self->width != self->height)
+	// allocate src buffer
+	char* src = (char*) MALLOC(size*sizeof(char));
+	if(src == NULL)
 	{
-		LOGE("invalid width=%i, height=%i",
-		     self->width, self->height);
+		LOGE("MALLOC failed");
 		return NULL;
 	}
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    self->stride, self->vstride,
-	                    self->type, self->format, NULL);
-	if(tex == NULL)
+	// read buffer
+	long start = ftell(f);
+	if(fread((void*) src, sizeof(char), size, f) != size)
 	{
-		return NULL;
+		LOGE("fread failed");
+		goto fail_read;
 	}
 
-	int x;
-	int y;
-	int w = self->width;
-	unsigned char pixel[4];
-	for(y = 0; y < self->height; ++y)
+	texgz_tex_t* self;
+	self = texgz_tex_importd((size_t) size, (const void*) src);
+	if(self == NULL)
 	{
-		for(x = 0; x < self->width; ++x)
-		{
-			texgz_tex_getPixel(self, x, y, pixel);
-			texgz_tex_setPixel(tex, (w - 1 - y), x, pixel);
-		}
+		goto fail_tex;
 	}
 
-	return tex;
-}
-
-int texgz_tex_rotate180(texgz_tex_t* self)
-{
-	texgz_tex_t* tex;
-	tex = texgz_tex_rotate180copy(self);
-	if(tex == NULL)
-	{
-		return 0;
-	}
+	FREE(src);
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
+	// success
+	return self;
 
-	texgz_tex_delete(&tex);
-	return 1;
+	// failure
+	fail_tex:
+		FREE(src);
+	fail_read:
+		fseek(f, start, SEEK_SET);
+		FREE(src);
+	return NULL;
 }
 
 texgz_tex_t*
-texgz_tex_rotate180copy(texgz_tex_t* self)
+texgz_tex_importd(size_t size, const void* data)
 {
-	ASSERT(self);
+	ASSERT(size > 0);
+	ASSERT(data);
 
-	if(self->width != self->height)
+	// uncompress the header
+	unsigned char header[TEXGZ_TEX_HSIZE];
+	uLong         hsize    = TEXGZ_TEX_HSIZE;
+	uLong         src_size = (uLong) size;
+	uncompress((Bytef*) header, &hsize, (const Bytef*) data,
+	           src_size);
+	if(hsize != TEXGZ_TEX_HSIZE)
 	{
-		LOGE("invalid width=%i, height=%i",
-		     self->width, self->height);
+		LOGE("uncompress failed hsize=%i", (int) hsize);
 		return NULL;
 	}
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    self->stride, self->vstride,
-	                    self->type, self->format, NULL);
-	if(tex == NULL)
+	int type;
+	int format;
+	int width;
+	int height;
+	int stride;
+	int vstride;
+	if(texgz_parseh(header, &type, &format,
+                    &width, &height, &stride,
+	                &vstride) == 0)
 	{
 		return NULL;
 	}
 
-	int x;
-	int y;
-	int w = self->width;
-	unsigned char pixel[4];
-	for(y = 0; y < self->height; ++y)
+	// create tex
+	texgz_tex_t* self;
+	self = texgz_tex_new(width, height, stride, vstride,
+	                     type, format, NULL);
+	if(self == NULL)
 	{
-		for(x = 0; x < self->width; ++x)
-		{
-			texgz_tex_getPixel(self, x, y, pixel);
-			texgz_tex_setPixel(tex, (w - 1 - x), (w - 1 - y), pixel);
-		}
+		return NULL;
 	}
 
-	return tex;
-}
+	// allocate dst buffer
+	int   bytes    = texgz_tex_size(self);
+	uLong dst_size =  TEXGZ_TEX_HSIZE + bytes;
+	unsigned char* dst;
+	dst = (unsigned char*)
+	      MALLOC(dst_size*sizeof(unsigned char));
+	if(dst == NULL)
+	{
+		LOGE("MALLOC failed");
+		goto fail_dst;
+	}
 
-int texgz_tex_rotate270(texgz_tex_t* self)
-{
-	texgz_tex_t* tex;
-	tex = texgz_tex_rotate270copy(self);
-	if(tex == NULL)
+	if(uncompress((Bytef*) dst, &dst_size,
+	              (const Bytef*) data, src_size) != Z_OK)
 	{
-		return 0;
+		LOGE("fail uncompress");
+		goto fail_uncompress;
 	}
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
+	if(dst_size != (TEXGZ_TEX_HSIZE + bytes))
+	{
+		LOGE("invalid dst_size=%i, expected=%i",
+		     (int) dst_size, (int) (TEXGZ_TEX_HSIZE + bytes));
+		goto fail_dst_size;
+	}
 
-	texgz_tex_delete(&tex);
-	return 1;
+	// copy buffer into tex
+	memcpy(self->pixels, &dst[TEXGZ_TEX_HSIZE], bytes);
+
+	FREE(dst);
+
+	// success
+	return self;
+
+	// failure
+	fail_dst_size:
+	fail_uncompress:
+		FREE(dst);
+	fail_dst:
+		texgz_tex_delete(&self);
+	return NULL;
 }
 
-texgz_tex_t*
-texgz_tex_rotate270copy(texgz_tex_t* self)
+int texgz_tex_export(texgz_tex_t* self,
+                     const char* filename)
 {
 	ASSERT(self);
+	ASSERT(filename);
 
-	if(self->width != self->height)
+	gzFile f = gzopen(filename, "wb");
+	if(f == NULL)
 	{
-		LOGE("invalid width=%i, height=%i",
-		     self->width, self->height);
-		return NULL;
+		LOGE("fopen failed for %s", filename);
+		return 0;
 	}
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    self->stride, self->vstride,
-	                    self->type, self->format, NULL);
-	if(tex == NULL)
+	// write header
+	int magic = TEXGZ_MAGIC;
+	if(gzwrite(f, (const void*) &magic,
+	           sizeof(int)) != sizeof(int))
 	{
-		return NULL;
+		LOGE("failed to write MAGIC");
+		goto fail_header;
+	}
+	if(gzwrite(f, (const void*) &self->type,
+	           sizeof(int)) != sizeof(int))
+	{
+		LOGE("failed to write type");
+		goto fail_header;
+	}
+	if(gzwrite(f, (const void*) &self->format,
+	           sizeof(int)) != sizeof(int))
+	{
+		LOGE("failed to write format");
+		goto fail_header;
+	}
+	if(gzwrite(f, (const void*) &self->width,
+	           sizeof(int)) != sizeof(int))
+	{
+		LOGE("failed to write width");
+		goto fail_header;
+	}
+	if(gzwrite(f, (const void*) &self->height,
+	           sizeof(int)) != sizeof(int))
+	{
+		LOGE("failed to write height");
+		goto fail_header;
+	}
+	if(gzwrite(f, (const void*) &self->stride,
+	           sizeof(int)) != sizeof(int))
+	{
+		LOGE("failed to write stride");
+		goto fail_header;
+	}
+	if(gzwrite(f, (const void*) &self->vstride,
+	           sizeof(int)) != sizeof(int))
+	{
+		LOGE("failed to write vstride");
+		goto fail_header;
 	}
 
-	int x;
-	int y;
-	int w = self->width;
-	unsigned char pixel[4];
-	for(y = 0; y < self->height; ++y)
+	// get texture size and check for supported formats
+	int bytes = texgz_tex_size(self);
+	if(bytes == 0)
+		goto fail_size;
+
+	// write pixels
+	unsigned char* pixels = self->pixels;
+	while(bytes > 0)
 	{
-		for(x = 0; x < self->width; ++x)
+		int bytes_written = gzwrite(f, (const void*) pixels,
+		                            bytes);
+		if(bytes_written == 0)
 		{
-			texgz_tex_getPixel(self, x, y, pixel);
-			texgz_tex_setPixel(tex, y, (w - 1 - x), pixel);
+			LOGE("failed to write pixels");
+			goto fail_pixels;
 		}
+		pixels += bytes_written;
+		bytes -= bytes_written;
 	}
 
-	return tex;
+	gzclose(f);
+
+	// success
+	return 1;
+
+	// failure
+	fail_pixels:
+	fail_size:
+	fail_header:
+		gzclose(f);
+	return 0;
 }
 
-int texgz_tex_flipvertical(texgz_tex_t* self)
+int texgz_tex_exportz(texgz_tex_t* self,
+                      const char* filename)
 {
-	ASSERT(self);
+	ASSERT(filename);
 
-	texgz_tex_t* tex = texgz_tex_flipverticalcopy(self);
-	if(tex == NULL)
+	FILE* f = fopen(filename, "w");
+	if(f == NULL)
 	{
+		LOGE("invalid filename=%s", filename);
 		return 0;
 	}
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
-
-	texgz_tex_delete(&tex);
-	return 1;
+	int ret = texgz_tex_exportf(self, f);
+	fclose(f);
+	return ret;
 }
 
-texgz_tex_t* texgz_tex_flipverticalcopy(texgz_tex_t* self)
+int texgz_tex_exportf(texgz_tex_t* self, FILE* f)
 {
 	ASSERT(self);
+	ASSERT(f);
 
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    self->stride, self->vstride,
-	                    self->type, self->format, NULL);
-	if(tex == NULL)
+	int bytes = texgz_tex_size(self);
+	if(bytes == 0)
 	{
-		return NULL;
+		return 0;
 	}
 
-	int y;
-	int bpp    = texgz_tex_bpp(self);
-	int stride = self->stride;
-	int width  = self->width;
-	int height = self->height;
-	for(y = 0; y < height; ++y)
+	// allocate src buffer
+	int size = bytes + TEXGZ_TEX_HSIZE;
+	unsigned char* src;
+	src = (unsigned char*) MALLOC(size*sizeof(unsigned char));
+	if(src == NULL)
 	{
-		unsigned char* src;
-		unsigned char* dst;
-		src = &self->pixels[y*bpp*stride];
-		dst = &tex->pixels[(height - 1 - y)*bpp*stride];
-		memcpy(dst, src, bpp*width);
-	}
-	return tex;
-}
-
-int texgz_tex_crop(texgz_tex_t* self, int top, int left,
-                   int bottom, int right)
-{
-	ASSERT(self);
-
-	texgz_tex_t* tex;
-	tex = texgz_tex_cropcopy(self, top, left, bottom, right);
-	if(tex == NULL)
+		LOGE("MALLOC failed");
 		return 0;
+	}
 
-	// swap the data
-	texgz_tex_t tmp = *self;
-	*self = *tex;
-	*tex = tmp;
-
-	texgz_tex_delete(&tex);
-	return 1;
-}
-
-texgz_tex_t*
-texgz_tex_cropcopy(texgz_tex_t* self, int top, int left,
-                   int bottom, int right)
-{
-	ASSERT(self);
+	// copy tex to src buffer
+	int* srci = (int*) src;
+	srci[0] = TEXGZ_MAGIC;
+	srci[1] = self->type;
+	srci[2] = self->format;
+	srci[3] = self->width;
+	srci[4] = self->height;
+	srci[5] = self->stride;
+	srci[6] = self->vstride;
+	memcpy(&src[TEXGZ_TEX_HSIZE], self->pixels, bytes);
 
-	// crop rectangle is inclusive
-	// i.e. {0, 0, 0, 0} is a single pixel at {0, 0}
-	if((top < 0) ||
-	   (top > bottom) ||
-	   (left < 0) ||
-	   (left > right) ||
-	   (right >= self->width) ||
-	   (bottom >= self->height))
+	// allocate dst buffer
+	uLong src_size = (uLong) (TEXGZ_TEX_HSIZE + bytes);
+	uLong dst_size = compressBound(src_size);
+	unsigned char* dst;
+	dst = (unsigned char*)
+	      MALLOC(dst_size*sizeof(unsigned char));
+	if(dst == NULL)
 	{
-		LOGE("invalid top=%i, left=%i, bottom=%i, right=%i",
-		     top, left, bottom, right);
-		return NULL;
+		LOGE("MALLOC failed");
+		goto fail_dst;
 	}
 
-
-	int width  = right - left + 1;
-	int height = bottom - top + 1;
-	texgz_tex_t* tex;
-	tex = texgz_tex_new(width, height, width, height,
-	                    self->type, self->format, NULL);
-	if(tex == NULL)
+	// compress buffer
+	if(compress((Bytef*) dst, (uLongf*) &dst_size,
+	            (const Bytef*) src, src_size) != Z_OK)
 	{
-		return NULL;
+		LOGE("compress failed");
+		goto fail_compress;
 	}
 
-	// blit
-	int y;
-	int bpp = texgz_tex_bpp(self);
-	for(y = 0; y < height; ++y)
+	// write buffer
+	if(fwrite(dst, sizeof(unsigned char), dst_size,
+	          f) != dst_size)
 	{
-		int src_y = y + top;
-		unsigned char* src;
-		unsigned char* dst;
-		src = &self->pixels[src_y*bpp*self->stride];
-		dst = &tex->pixels[y*bpp*width];
-		memcpy(dst, src, bpp*width);
+		LOGE("fwrite failed");
+		goto fail_fwrite;
 	}
-	return tex;
+
+	// free src and dst buffer
+	FREE(src);
+	FREE(dst);
+
+	// success
+	return 1;
+
+	// failure
+	fail_fwrite:
+	fail_compress:
+		FREE(dst);
+	fail_dst:
+		FREE(src);
+	return 0;
 }
 
-int texgz_tex_pad(texgz_tex_t* self)
+int texgz_tex_convert(texgz_tex_t* self, int type,
+                      int format)
 {
 	ASSERT(self);
 
-	int pot_stride  = texgz_nextpot(self->stride);
-	int pot_vstride = texgz_nextpot(self->vstride);
-	if((pot_stride == self->stride) &&
-	   (pot_vstride == self->vstride))
+	// already in requested format
+	if((type == self->type) && (format == self->format))
+		return 1;
+
+	// convert L,A,LABL
+	if((type == TEXGZ_UNSIGNED_BYTE)         &&
+	   (self->type   == TEXGZ_UNSIGNED_BYTE) &&
+	   ((format == TEXGZ_ALPHA)     ||
+	    (format == TEXGZ_LUMINANCE) ||
+	    (format == TEXGZ_LABL)) &&
+	   ((self->format == TEXGZ_ALPHA)     ||
+	    (self->format == TEXGZ_LUMINANCE) ||
+	    (self->format == TEXGZ_LABL)))
 	{
-		// already power-of-two
+		self->format = format;
 		return 1;
 	}
 
-	texgz_tex_t* tex = texgz_tex_padcopy(self);
+	texgz_tex_t* tex;
+	tex = texgz_tex_convertcopy(self, type, format);
 	if(tex == NULL)
 		return 0;
 
@@ -3851,471 +4985,2522 @@ int texgz_tex_pad(texgz_tex_t* self)
 	return 1;
 }
 
-texgz_tex_t* texgz_tex_padcopy(texgz_tex_t* self)
+int texgz_tex_convertF(texgz_tex_t* self,
+                       float min, float max,
+                       int type, int format)
 {
 	ASSERT(self);
 
-	int pot_stride  = texgz_nextpot(self->stride);
-	int pot_vstride = texgz_nextpot(self->vstride);
-	if((pot_stride == self->stride) &&
-	   (pot_vstride == self->vstride))
-	{
-		// already power-of-two
-		return texgz_tex_copy(self);
-	}
+	// already in requested format
+	if((type == self->type) && (format == self->format))
+		return 1;
 
 	texgz_tex_t* tex;
-	tex = texgz_tex_new(self->width, self->height,
-	                    pot_stride, pot_vstride,
-	                    self->type, self->format, NULL);
+	tex = texgz_tex_convertFcopy(self, min, max, type, format);
 	if(tex == NULL)
+		return 0;
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_convertcopy(texgz_tex_t* self, int type,
+                      int format)
+{
+	ASSERT(self);
+
+	// copy in the case that the src and dst formats match
+	// in particular this case prevents the conversion of
+	// 8888 to 8888
+	if((type == self->type) && (format == self->format))
+		return texgz_tex_copy(self);
+
+	// convert to RGBA-8888
+	// No conversions are allowed on TEXGZ_SHORT,
+	// TEXGZ_UNSIGNED_SHORT or TEXGZ_UNSIGNED_INT
+	texgz_tex_t* tmp        = NULL;
+	int      tmp_delete = 1;   // delete if self is not 8888
+	if((self->type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) &&
+	   (self->format == TEXGZ_RGBA))
+		tmp = texgz_tex_4444to8888(self);
+	else if((self->type == TEXGZ_UNSIGNED_SHORT_5_6_5) &&
+	        (self->format == TEXGZ_RGB))
+		tmp = texgz_tex_565to8888(self);
+	else if((self->type == TEXGZ_UNSIGNED_SHORT_5_5_5_1) &&
+	        (self->format == TEXGZ_RGBA))
+		tmp = texgz_tex_5551to8888(self);
+	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_RGB))
+		tmp = texgz_tex_888to8888(self);
+	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_LUMINANCE))
+		tmp = texgz_tex_Lto8888(self);
+	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_ALPHA))
+		tmp = texgz_tex_Ato8888(self);
+	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_LUMINANCE_ALPHA))
+	{
+		if(format == TEXGZ_RG00)
+		{
+			tmp    = texgz_tex_LAto8800(self);
+			format = TEXGZ_RGBA;
+		}
+		else
+		{
+			tmp = texgz_tex_LAto8888(self);
+		}
+	}
+	else if((self->type == TEXGZ_FLOAT) &&
+	        (self->format == TEXGZ_LUMINANCE))
+		tmp = texgz_tex_Fto8888(self, 0.0f, 1.0f);
+	else if((self->type == TEXGZ_FLOAT) &&
+	        (self->format == TEXGZ_RGBA))
+		tmp = texgz_tex_FFFFto8888(self, 0.0f, 1.0f);
+	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_BGRA))
+		tmp = texgz_tex_8888format(self, TEXGZ_RGBA);
+	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_RGBA))
+	{
+		tmp        = self;
+		tmp_delete = 0;
+	}
+
+	// check for errors
+	if(tmp == NULL)
 	{
+		LOGE("could not convert to 8888");
 		return NULL;
 	}
 
-	// blit
-	int y;
-	int bpp = texgz_tex_bpp(self);
-	for(y = 0; y < tex->height; ++y)
+	// convert to requested format
+	texgz_tex_t* tex = NULL;
+	if((type == TEXGZ_UNSIGNED_SHORT_4_4_4_4) &&
+	   (format == TEXGZ_RGBA))
+		tex = texgz_tex_8888to4444(tmp);
+	else if((type == TEXGZ_UNSIGNED_SHORT_5_6_5) &&
+	        (format == TEXGZ_RGB))
+		tex = texgz_tex_8888to565(tmp);
+	else if((type == TEXGZ_UNSIGNED_SHORT_5_5_5_1) &&
+	        (format == TEXGZ_RGBA))
+		tex = texgz_tex_8888to5551(tmp);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_RGB))
+		tex = texgz_tex_8888to888(tmp);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_LUMINANCE))
+		tex = texgz_tex_8888toL(tmp);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_LABL))
+		tex = texgz_tex_8888toLABL(tmp);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_ALPHA))
+		tex = texgz_tex_8888toA(tmp);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_LUMINANCE_ALPHA))
+		tex = texgz_tex_8888toLA(tmp);
+	else if((type == TEXGZ_FLOAT) &&
+	        (format == TEXGZ_LUMINANCE))
+		tex = texgz_tex_8888toF(tmp);
+	else if((type == TEXGZ_FLOAT) &&
+	        (format == TEXGZ_RGBA))
+		tex = texgz_tex_8888toFFFF(tmp, 0.0f, 1.0f);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_BGRA))
+		tex = texgz_tex_8888format(tmp, TEXGZ_BGRA);
+	else if((type == TEXGZ_UNSIGNED_BYTE) &&
+	        (format == TEXGZ_RGBA))
 	{
-		unsigned char* src = &self->pixels[y*bpp*self->stride];
-		unsigned char* dst = &tex->pixels[y*bpp*tex->stride];
-		memcpy(dst, src, bpp*tex->width);
+		// note that tex will never equal self because of the
+		// shortcut copy
+		tex        = tmp;
+		tmp_delete = 0;
+	}
+
+	// cleanup
+	if(tmp_delete == 1)
+		texgz_tex_delete(&tmp);
+
+	// check for errors
+	if(tex == NULL)
+	{
+		LOGE("could not convert to type=0x%X, format=0x%X",
+		     type, format);
+		return NULL;
 	}
+
+	// success
 	return tex;
 }
 
-texgz_tex_t* texgz_tex_outline(texgz_tex_t* self, int size)
+texgz_tex_t*
+texgz_tex_convertFcopy(texgz_tex_t* self,
+                       float min, float max,
+                       int type, int format)
 {
 	ASSERT(self);
 
-	// validate the outline circle
-	int    off     = size/2;
-	float* mask = NULL;
-	if(size == 3)
+	if((self->type   == TEXGZ_FLOAT)         &&
+	   (self->format == TEXGZ_RGBA)          &&
+	   (type         == TEXGZ_UNSIGNED_BYTE) &&
+	   (format       == TEXGZ_RGBA))
 	{
-		mask = TEXGZ_TEX_OUTLINE3;
+		return texgz_tex_FFFFto8888(self, min, max);
 	}
-	else if(size == 5)
+	else if((self->type   == TEXGZ_FLOAT)         &&
+	        (self->format == TEXGZ_LUMINANCE)     &&
+	        (type         == TEXGZ_UNSIGNED_BYTE) &&
+	        (format       == TEXGZ_RGBA))
 	{
-		mask = TEXGZ_TEX_OUTLINE5;
+		return texgz_tex_Fto8888(self, min, max);
 	}
-	else if(size == 7)
+	else if((self->type   == TEXGZ_FLOAT)         &&
+	        (self->format == TEXGZ_LUMINANCE)     &&
+	        (type         == TEXGZ_UNSIGNED_BYTE) &&
+	        (format       == TEXGZ_LUMINANCE))
 	{
-		mask = TEXGZ_TEX_OUTLINE7;
+		return texgz_tex_Fto8(self, min, max);
 	}
-	else if(size == 9)
+	else if((self->type   == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_LUMINANCE)     &&
+	        (type         == TEXGZ_FLOAT)         &&
+	        (format       == TEXGZ_LUMINANCE))
 	{
-		mask = TEXGZ_TEX_OUTLINE9;
+		return texgz_tex_8toF(self, min, max);
 	}
-	else if(size == 11)
+	else if((self->type   == TEXGZ_UNSIGNED_BYTE) &&
+	        (self->format == TEXGZ_RGBA)          &&
+	        (type         == TEXGZ_FLOAT)         &&
+	        (format       == TEXGZ_RGBA))
 	{
-		mask = TEXGZ_TEX_OUTLINE11;
+		return texgz_tex_8888toFFFF(self, min, max);
 	}
 	else
 	{
-		LOGE("invalid size=%i", size);
+		LOGE("invalid type=0x%X:0x%X, format=0x%X:0x%X",
+		     self->type, type, self->format, format);
 		return NULL;
 	}
+}
 
-	// validate the input tex
-	if(((self->format == TEXGZ_ALPHA)     ||
-	    (self->format == TEXGZ_LUMINANCE) ||
-	    (self->format == TEXGZ_LABL)) &&
-	   (self->type == TEXGZ_UNSIGNED_BYTE))
+texgz_tex_t* texgz_tex_grayscaleF(texgz_tex_t* self)
+{
+	ASSERT(self);
+	ASSERT(self->type == TEXGZ_FLOAT);
+
+	// channels
+	int n;
+	if(self->format == TEXGZ_RGBA)
 	{
-		// OK
+		n = 4;
+	}
+	else if(self->format == TEXGZ_RGB)
+	{
+		n = 3;
 	}
 	else
 	{
-		LOGE("invalid format=0x%X, type=0x%X",
-		     self->format, self->type);
+		LOGE("invalid format=0x%X", self->format);
 		return NULL;
 	}
 
-	// create the dst tex
-	int w2 = self->width  + 2*off;
-	int h2 = self->height + 2*off;
-	int w2r = w2 + (w2%2);
-	int h2r = h2 + (h2%2);
 	texgz_tex_t* tex;
-	tex = texgz_tex_new(w2r, h2r, w2r, h2r,
-	                    TEXGZ_UNSIGNED_BYTE,
-	                    TEXGZ_LUMINANCE_ALPHA, NULL);
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    TEXGZ_FLOAT, TEXGZ_LUMINANCE,
+	                    NULL);
 	if(tex == NULL)
 	{
 		return NULL;
 	}
 
-	// copy the base
-	int i;
-	int j;
-	unsigned char* ps = self->pixels;
-	unsigned char* pd = tex->pixels;
-	for(i = 0; i < self->height; ++i)
+	float src[4] = { 0 };
+	float dst;
+	int   x;
+	int   y;
+	int   i;
+	for(y = 0; y < self->height; ++y)
+	{
+		for(x = 0; x < self->width; ++x)
+		{
+			dst = 0.0f;
+			texgz_tex_getPixelF(self, x, y, src);
+			for(i = 0; i < n; ++i)
+			{
+				dst += src[i];
+			}
+			dst /= n;
+
+			texgz_tex_setPixelF(tex, x, y, &dst);
+		}
+	}
+
+	return tex;
+}
+
+int texgz_tex_RGB2LABF(texgz_tex_t* self,
+                       texgz_tex_t** _labl,
+                       texgz_tex_t** _laba,
+                       texgz_tex_t** _labb)
+{
+	ASSERT(self);
+	ASSERT(_labl);
+	ASSERT(_laba);
+	ASSERT(_labb);
+
+	texgz_tex_t* labl;
+	labl = texgz_tex_new(self->width, self->height,
+	                     self->stride, self->vstride,
+	                     TEXGZ_FLOAT, TEXGZ_LUMINANCE,
+	                     NULL);
+	if(labl == NULL)
+	{
+		return 0;
+	}
+
+	texgz_tex_t* laba;
+	laba = texgz_tex_new(self->width, self->height,
+	                     self->stride, self->vstride,
+	                     TEXGZ_FLOAT, TEXGZ_LUMINANCE,
+	                     NULL);
+	if(laba == NULL)
+	{
+		goto fail_laba;
+	}
+
+	texgz_tex_t* labb;
+	labb = texgz_tex_new(self->width, self->height,
+	                     self->stride, self->vstride,
+	                     TEXGZ_FLOAT, TEXGZ_LUMINANCE,
+	                     NULL);
+	if(labb == NULL)
+	{
+		goto fail_labb;
+	}
+
+	texgz_tex_lab_t lab =
+	{
+		.mode = TEXGZ_LAB_MODE_PLANAR,
+		.src  = self,
+		.dst  = { labl, laba, labb },
+	};
+
+	if(texgz_tex_lab(&lab) == 0)
+	{
+		goto fail_lab;
+	}
+
+	*_labl = labl;
+	*_laba = laba;
+	*_labb = labb;
+
+	// success
+	return 1;
+
+	// failure
+	fail_lab:
+		texgz_tex_delete(&labb);
+	fail_labb:
+		texgz_tex_delete(&laba);
+	fail_laba:
+		texgz_tex_delete(&labl);
+	return 0;
+}
+
+texgz_tex_t* texgz_tex_RGB2LABFcopy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    TEXGZ_FLOAT, TEXGZ_RGBA, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	texgz_tex_lab_t lab =
+	{
+		.mode = TEXGZ_LAB_MODE_RGBA,
+		.src  = self,
+		.dst  = { tex, NULL, NULL },
+	};
+
+	if(texgz_tex_lab(&lab) == 0)
+	{
+		texgz_tex_delete(&tex);
+		return NULL;
+	}
+
+	return tex;
+}
+
+texgz_tex_t*
+texgz_tex_channelF(texgz_tex_t* self, int channel,
+                   float min, float max)
+{
+	ASSERT(self);
+
+	int channels = texgz_tex_channels(self);
+	if((channels == 0) || (channel >= channels))
+	{
+		LOGE("invalid format=0x%X, channel=%i",
+		     self->format, channel);
+		return NULL;
+	}
+
+	// check type
+	if((self->type == TEXGZ_FLOAT) ||
+	   (self->type == TEXGZ_UNSIGNED_BYTE))
+	{
+		// ok
+	}
+	else
+	{
+		LOGE("invalid type=0x%X", self->type);
+		return NULL;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    TEXGZ_FLOAT, TEXGZ_LUMINANCE,
+	                    NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	// copy channel
+	int x;
+	int y;
+	unsigned char srcu[4] = { 0 };
+	float         srcf[4] = { 0 };
+	float         dstf[4] = { 0 };
+	if(self->type == TEXGZ_FLOAT)
+	{
+		for(y = 0; y < self->height; ++y)
+		{
+			for(x = 0; x < self->width; ++x)
+			{
+				// ignore min/max for floats
+				texgz_tex_getPixelF(self, x, y, srcf);
+				dstf[0] = srcf[channel];
+				texgz_tex_setPixelF(tex, x, y, dstf);
+			}
+		}
+	}
+	else
+	{
+		for(y = 0; y < self->height; ++y)
+		{
+			for(x = 0; x < self->width; ++x)
+			{
+				texgz_tex_getPixel(self, x, y, srcu);
+				srcf[0] = (float) srcu[channel];
+				dstf[0] = (max - min)*srcf[0]/255.0f + min;
+				texgz_tex_setPixelF(tex, x, y, dstf);
+			}
+		}
+	}
+
+	return tex;
+}
+
+void
+texgz_tex_convolveF(texgz_tex_t* src, texgz_tex_t* dst,
+                    int mw, int mh,
+                    int stride, int vstride,
+                    float* mask)
+{
+	ASSERT(src);
+	ASSERT(dst);
+	ASSERT(mask);
+	ASSERT(src->width  == (stride*dst->width));
+	ASSERT(src->height == (vstride*dst->height));
+	ASSERT(src->type == TEXGZ_FLOAT);
+	ASSERT(dst->type == TEXGZ_FLOAT);
+	ASSERT(texgz_tex_channels(src) ==
+	       texgz_tex_channels(dst));
+
+	// compute center offset
+	// examples:
+	// 1) Sobel Edge: stride=1, mw=3
+	//    +---+---+---+
+	//    | 0 | 1 | 2 |
+	//    +---+---+---+
+	//    |   | C |   |
+	//    +---+---+---+
+	//
+	// 2) Box Downsample: stride=2, mw=2
+	//    +---+---+
+	//    | 0 | 1 |
+	//    +---+---+
+	//    | C |   |
+	//    +---+---+
+	//
+	// 3) Lanczos3 Downsample: stride=2, mw=12
+	//    +---+---+---+---+---+---+---+---+---+---+---+---+
+	//    | 0 | 1 | 2 | 3 | 4 | 5 | 6 | 7 | 8 | 9 | A | B |
+	//    +---+---+---+---+---+---+---+---+---+---+---+---+
+	//    |   |   |   |   |   | C |   |   |   |   |   |   |
+	//    +---+---+---+---+---+---+---+---+---+---+---+---+
+	int cm = (mh - vstride)/2;
+	int cn = (mw - stride)/2;
+
+	int i;
+	int j;
+	int c;
+	int m;
+	int n;
+	int w        = src->width;
+	int h        = src->height;
+	int channels = texgz_tex_channels(src);
+	float pixel[4];
+	float f[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for(i = 0; i < h; i += vstride)
+	{
+		for(j = 0; j < w; j += stride)
+		{
+			for(c = 0; c < channels; ++c)
+			{
+				f[c] = 0.0f;
+			}
+
+			// convolve
+			for(m = 0; m < mh; ++m)
+			{
+				for(n = 0; n < mw; ++n)
+				{
+					texgz_tex_getClampedPixelF(src, j + n - cn,
+					                           i + m - cm, pixel);
+
+					for(c = 0; c < channels; ++c)
+					{
+						f[c] += mask[m*mw + n]*pixel[c];
+					}
+				}
+			}
+
+			// decimate and fill pixel
+			texgz_tex_setPixelF(dst, j/stride, i/vstride, f);
+		}
+	}
+}
+
+int texgz_tex_blur(texgz_tex_t* self, float sigma,
+                   float mu, int size)
+{
+	texgz_tex_t* tex;
+	tex = texgz_tex_blurcopy(self, sigma, mu, size);
+	if(tex == NULL)
+	{
+		return 0;
+	}
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_blurcopy(texgz_tex_t* self, float sigma,
+                   float mu, int size)
+{
+	ASSERT(self);
+
+	if((size < 0) || (size%2 == 0))
+	{
+		LOGE("invalid size=%i", size);
+		return NULL;
+	}
+
+	float* mask = (float*) MALLOC(size*sizeof(float));
+	if(mask == NULL)
+	{
+		return NULL;
+	}
+
+	if(texgz_tex_gaussianCoef(sigma, mu, size, mask) == 0)
+	{
+		goto fail_coef;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_filtercopy(self, size, mask, NULL);
+	if(tex == NULL)
+	{
+		goto fail_filter;
+	}
+
+	FREE(mask);
+
+	// success
+	return tex;
+
+	// failure
+	fail_filter:
+	fail_coef:
+		FREE(mask);
+	return NULL;
+}
+
+int texgz_tex_gaussian(texgz_tex_t* self, float sigma)
+{
+	ASSERT(self);
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_gaussiancopy(self, sigma);
+	if(tex == NULL)
+	{
+		return 0;
+	}
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_gaussiancopy(texgz_tex_t* self, float sigma)
+{
+	ASSERT(self);
+
+	if(sigma < 0.0f)
+	{
+		LOGE("invalid sigma=%f", sigma);
+		return NULL;
+	}
+	else if(sigma == 0.0f)
+	{
+		return texgz_tex_copy(self);
+	}
+
+	// small kernels are evaluated exactly while large
+	// kernels are approximated by 3 box filters whose
+	// cost is independent of sigma
+	int r = (int) ceilf(3.0f*sigma);
+	if(r > TEXGZ_GAUSSIAN_EXACT_RADIUS)
+	{
+		int box[3];
+		texgz_tex_gaussianBox(sigma, box);
+		return texgz_tex_filtercopy(self, 0, NULL, box);
+	}
+
+	return texgz_tex_blurcopy(self, sigma, 0.0f, 2*r + 1);
+}
+
+int texgz_tex_boxblur(texgz_tex_t* self, int radius)
+{
+	ASSERT(self);
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_boxblurcopy(self, radius);
+	if(tex == NULL)
+	{
+		return 0;
+	}
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_boxblurcopy(texgz_tex_t* self, int radius)
+{
+	ASSERT(self);
+
+	if(radius < 0)
+	{
+		LOGE("invalid radius=%i", radius);
+		return NULL;
+	}
+
+	// the sat validates the type/format
+	texgz_sat_t* sat = texgz_sat_new(self);
+	if(sat == NULL)
+	{
+		return NULL;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
+	{
+		goto fail_tex;
+	}
+
+	// the box is clipped to the image so edge pixels
+	// average the samples which are available
+	int   x;
+	int   y;
+	int   c;
+	int   size = 2*radius + 1;
+	float mean[4];
+	for(y = 0; y < self->height; ++y)
+	{
+		for(x = 0; x < self->width; ++x)
+		{
+			texgz_sat_mean(sat, x - radius, y - radius,
+			               size, size, mean);
+
+			if(tex->type == TEXGZ_FLOAT)
+			{
+				texgz_tex_setPixelF(tex, x, y, mean);
+			}
+			else
+			{
+				unsigned char* dst;
+				dst = &tex->pixels[4*(y*tex->stride + x)];
+				for(c = 0; c < 4; ++c)
+				{
+					dst[c] = (unsigned char)
+					         cc_clamp(255.0f*mean[c] + 0.5f,
+					                  0.0f, 255.0f);
+				}
+			}
+		}
+	}
+
+	texgz_sat_delete(&sat);
+
+	// success
+	return tex;
+
+	// failure
+	fail_tex:
+		texgz_sat_delete(&sat);
+	return NULL;
+}
+
+int texgz_tex_rotate90(texgz_tex_t* self)
+{
+	texgz_tex_t* tex;
+	tex = texgz_tex_rotate90copy(self);
+	if(tex == NULL)
+	{
+		return 0;
+	}
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_rotate90copy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	return texgz_tex_rotatecopy(self, 0);
+}
+
+int texgz_tex_rotate180(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	// flip first since the mirror cannot fail
+	if(texgz_tex_flipvertical(self) == 0)
+	{
+		return 0;
+	}
+
+	return texgz_tex_fliphorizontal(self);
+}
+
+texgz_tex_t*
+texgz_tex_rotate180copy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	int bpp = texgz_tex_bpp(self);
+	if(bpp == 0)
+	{
+		return NULL;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	int y;
+	int h1 = self->height - 1;
+	for(y = 0; y < self->height; ++y)
+	{
+		texgz_tex_mirrorRow(&self->pixels[y*bpp*self->stride],
+		                    &tex->pixels[(h1 - y)*bpp*tex->stride],
+		                    self->width, bpp);
+	}
+
+	return tex;
+}
+
+int texgz_tex_rotate270(texgz_tex_t* self)
+{
+	texgz_tex_t* tex;
+	tex = texgz_tex_rotate270copy(self);
+	if(tex == NULL)
+	{
+		return 0;
+	}
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_rotate270copy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	return texgz_tex_rotatecopy(self, 1);
+}
+
+int texgz_tex_flipvertical(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	int bpp = texgz_tex_bpp(self);
+	if(bpp == 0)
+	{
+		return 0;
+	}
+
+	// swap rows in place using a single row of scratch
+	size_t         size = bpp*self->width;
+	unsigned char* row  = (unsigned char*) MALLOC(size);
+	if(row == NULL)
+	{
+		return 0;
+	}
+
+	int y;
+	int h1 = self->height - 1;
+	for(y = 0; y < self->height/2; ++y)
+	{
+		unsigned char* a;
+		unsigned char* b;
+		a = &self->pixels[y*bpp*self->stride];
+		b = &self->pixels[(h1 - y)*bpp*self->stride];
+		memcpy(row, a, size);
+		memcpy(a, b, size);
+		memcpy(b, row, size);
+	}
+
+	FREE(row);
+	return 1;
+}
+
+texgz_tex_t* texgz_tex_flipverticalcopy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	int y;
+	int bpp    = texgz_tex_bpp(self);
+	int stride = self->stride;
+	int width  = self->width;
+	int height = self->height;
+	for(y = 0; y < height; ++y)
+	{
+		unsigned char* src;
+		unsigned char* dst;
+		src = &self->pixels[y*bpp*stride];
+		dst = &tex->pixels[(height - 1 - y)*bpp*stride];
+		memcpy(dst, src, bpp*width);
+	}
+	return tex;
+}
+
+int texgz_tex_fliphorizontal(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	int bpp = texgz_tex_bpp(self);
+	if(bpp == 0)
+	{
+		return 0;
+	}
+
+	int y;
+	for(y = 0; y < self->height; ++y)
+	{
+		texgz_tex_mirrorRowInPlace(&self->pixels[y*bpp*self->stride],
+		                           self->width, bpp);
+	}
+
+	return 1;
+}
+
+texgz_tex_t* texgz_tex_fliphorizontalcopy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	int bpp = texgz_tex_bpp(self);
+	if(bpp == 0)
+	{
+		return NULL;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	int y;
+	for(y = 0; y < self->height; ++y)
+	{
+		texgz_tex_mirrorRow(&self->pixels[y*bpp*self->stride],
+		                    &tex->pixels[y*bpp*tex->stride],
+		                    self->width, bpp);
+	}
+
+	return tex;
+}
+
+int texgz_tex_flipverticalconvert(texgz_tex_t* self,
+                                  int type, int format)
+{
+	ASSERT(self);
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_flipverticalconvertcopy(self, type,
+	                                        format);
+	if(tex == NULL)
+	{
+		return 0;
+	}
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_flipverticalconvertcopy(texgz_tex_t* self,
+                                  int type, int format)
+{
+	ASSERT(self);
+
+	// byte swizzles are flipped and converted in a single
+	// pass which is the common case for screen captures
+	int map[4];
+	int src_n;
+	int dst_n;
+	if((type == self->type) && (format == self->format))
+	{
+		return texgz_tex_flipverticalcopy(self);
+	}
+	else if(texgz_tex_swizzle(self, type, format,
+	                          map, &src_n, &dst_n) == 0)
+	{
+		texgz_tex_t* tex;
+		tex = texgz_tex_convertcopy(self, type, format);
+		if(tex == NULL)
+		{
+			return NULL;
+		}
+
+		if(texgz_tex_flipvertical(tex) == 0)
+		{
+			texgz_tex_delete(&tex);
+			return NULL;
+		}
+
+		return tex;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    type, format, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	int x;
+	int y;
+	int c;
+	int h1 = self->height - 1;
+	for(y = 0; y < self->height; ++y)
+	{
+		unsigned char* src;
+		unsigned char* dst;
+		src = &self->pixels[src_n*y*self->stride];
+		dst = &tex->pixels[dst_n*(h1 - y)*tex->stride];
+		for(x = 0; x < self->width; ++x)
+		{
+			for(c = 0; c < dst_n; ++c)
+			{
+				dst[c] = (map[c] < 0) ? 0xFF : src[map[c]];
+			}
+			src += src_n;
+			dst += dst_n;
+		}
+	}
+
+	return tex;
+}
+
+int texgz_tex_crop(texgz_tex_t* self, int top, int left,
+                   int bottom, int right)
+{
+	ASSERT(self);
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_cropcopy(self, top, left, bottom, right);
+	if(tex == NULL)
+		return 0;
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t*
+texgz_tex_cropcopy(texgz_tex_t* self, int top, int left,
+                   int bottom, int right)
+{
+	ASSERT(self);
+
+	// crop rectangle is inclusive
+	// i.e. {0, 0, 0, 0} is a single pixel at {0, 0}
+	if((top < 0) ||
+	   (top > bottom) ||
+	   (left < 0) ||
+	   (left > right) ||
+	   (right >= self->width) ||
+	   (bottom >= self->height))
+	{
+		LOGE("invalid top=%i, left=%i, bottom=%i, right=%i",
+		     top, left, bottom, right);
+		return NULL;
+	}
+
+
+	int width  = right - left + 1;
+	int height = bottom - top + 1;
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(width, height, width, height,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	// blit
+	int y;
+	int bpp = texgz_tex_bpp(self);
+	for(y = 0; y < height; ++y)
+	{
+		int src_y = y + top;
+		unsigned char* src;
+		unsigned char* dst;
+		src = &self->pixels[src_y*bpp*self->stride];
+		dst = &tex->pixels[y*bpp*width];
+		memcpy(dst, src, bpp*width);
+	}
+	return tex;
+}
+
+int texgz_tex_pad(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	int pot_stride  = texgz_nextpot(self->stride);
+	int pot_vstride = texgz_nextpot(self->vstride);
+	if((pot_stride == self->stride) &&
+	   (pot_vstride == self->vstride))
+	{
+		// already power-of-two
+		return 1;
+	}
+
+	texgz_tex_t* tex = texgz_tex_padcopy(self);
+	if(tex == NULL)
+		return 0;
+
+	// swap the data
+	texgz_tex_t tmp = *self;
+	*self = *tex;
+	*tex = tmp;
+
+	texgz_tex_delete(&tex);
+	return 1;
+}
+
+texgz_tex_t* texgz_tex_padcopy(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	int pot_stride  = texgz_nextpot(self->stride);
+	int pot_vstride = texgz_nextpot(self->vstride);
+	if((pot_stride == self->stride) &&
+	   (pot_vstride == self->vstride))
+	{
+		// already power-of-two
+		return texgz_tex_copy(self);
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    pot_stride, pot_vstride,
+	                    self->type, self->format, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	// blit
+	int y;
+	int bpp = texgz_tex_bpp(self);
+	for(y = 0; y < tex->height; ++y)
+	{
+		unsigned char* src = &self->pixels[y*bpp*self->stride];
+		unsigned char* dst = &tex->pixels[y*bpp*tex->stride];
+		memcpy(dst, src, bpp*tex->width);
+	}
+	return tex;
+}
+
+texgz_tex_t* texgz_tex_outline(texgz_tex_t* self, int size)
+{
+	ASSERT(self);
+
+	// validate the outline circle
+	int    off     = size/2;
+	float* mask = NULL;
+	if(size == 3)
+	{
+		mask = TEXGZ_TEX_OUTLINE3;
+	}
+	else if(size == 5)
+	{
+		mask = TEXGZ_TEX_OUTLINE5;
+	}
+	else if(size == 7)
+	{
+		mask = TEXGZ_TEX_OUTLINE7;
+	}
+	else if(size == 9)
+	{
+		mask = TEXGZ_TEX_OUTLINE9;
+	}
+	else if(size == 11)
+	{
+		mask = TEXGZ_TEX_OUTLINE11;
+	}
+	else
+	{
+		LOGE("invalid size=%i", size);
+		return NULL;
+	}
+
+	// validate the input tex
+	if(((self->format == TEXGZ_ALPHA)     ||
+	    (self->format == TEXGZ_LUMINANCE) ||
+	    (self->format == TEXGZ_LABL)) &&
+	   (self->type == TEXGZ_UNSIGNED_BYTE))
+	{
+		// OK
+	}
+	else
+	{
+		LOGE("invalid format=0x%X, type=0x%X",
+		     self->format, self->type);
+		return NULL;
+	}
+
+	// create the dst tex
+	int w2 = self->width  + 2*off;
+	int h2 = self->height + 2*off;
+	int w2r = w2 + (w2%2);
+	int h2r = h2 + (h2%2);
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(w2r, h2r, w2r, h2r,
+	                    TEXGZ_UNSIGNED_BYTE,
+	                    TEXGZ_LUMINANCE_ALPHA, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	// the luminance is also copied to a contiguous
+	// plane for sampling
+	unsigned char* lum;
+	lum = (unsigned char*) CALLOC(w2r*h2r, sizeof(unsigned char));
+	if(lum == NULL)
+	{
+		goto fail_lum;
+	}
+
+	// copy the base
+	int i;
+	int j;
+	unsigned char* ps = self->pixels;
+	unsigned char* pd = tex->pixels;
+	for(i = 0; i < self->height; ++i)
+	{
+		for(j = 0; j < self->width; ++j)
+		{
+			int i2 = i + off;
+			int j2 = j + off;
+			pd[2*(i2*tex->stride + j2)] = ps[i*self->stride + j];
+			lum[i2*w2r + j2]            = ps[i*self->stride + j];
+		}
+	}
+
+	// sample the outline
+	texgz_tex_outline_t outline =
+	{
+		.width  = w2r,
+		.height = h2r,
+		.size   = size,
+		.mask   = mask,
+		.lum    = lum,
+		.dst    = tex,
+		.w2     = w2,
+		.h2     = h2,
+	};
+
+	int tiles = (h2 + TEXGZ_OUTLINE_TILE - 1)/TEXGZ_OUTLINE_TILE;
+	texgz_thread_parallel(tiles, &outline,
+	                      texgz_tex_outlineTiles);
+
+	FREE(lum);
+
+	// success
+	return tex;
+
+	// failure
+	fail_lum:
+		texgz_tex_delete(&tex);
+	return NULL;
+}
+
+static int texgz_tex_sdfValid(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	if(((self->format == TEXGZ_ALPHA)     ||
+	    (self->format == TEXGZ_LUMINANCE) ||
+	    (self->format == TEXGZ_LABL)) &&
+	   (self->type == TEXGZ_UNSIGNED_BYTE))
+	{
+		return 1;
+	}
+
+	LOGE("invalid format=0x%X, type=0x%X",
+	     self->format, self->type);
+	return 0;
+}
+
+texgz_tex_t* texgz_tex_sdfF(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	if(texgz_tex_sdfValid(self) == 0)
+	{
+		return NULL;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    TEXGZ_FLOAT, TEXGZ_LUMINANCE, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	// distance to the nearest inside/outside pixel
+	double* din;
+	double* dout;
+	din = texgz_tex_edt(self->pixels, self->width,
+	                    self->height, self->stride, 1, 1);
+	if(din == NULL)
+	{
+		goto fail_din;
+	}
+
+	dout = texgz_tex_edt(self->pixels, self->width,
+	                     self->height, self->stride, 1, 0);
+	if(dout == NULL)
+	{
+		goto fail_dout;
+	}
+
+	int    x;
+	int    y;
+	int    w      = self->width;
+	float* pixels = (float*) tex->pixels;
+	for(y = 0; y < self->height; ++y)
+	{
+		for(x = 0; x < w; ++x)
+		{
+			pixels[y*tex->stride + x] = (float)
+			                            (sqrt(din[y*w + x]) -
+			                             sqrt(dout[y*w + x]));
+		}
+	}
+
+	FREE(dout);
+	FREE(din);
+
+	// success
+	return tex;
+
+	// failure
+	fail_dout:
+		FREE(din);
+	fail_din:
+		texgz_tex_delete(&tex);
+	return NULL;
+}
+
+texgz_tex_t* texgz_tex_sdf(texgz_tex_t* self, float spread)
+{
+	ASSERT(self);
+
+	if(spread <= 0.0f)
+	{
+		LOGE("invalid spread=%f", spread);
+		return NULL;
+	}
+
+	texgz_tex_t* sdf = texgz_tex_sdfF(self);
+	if(sdf == NULL)
+	{
+		return NULL;
+	}
+
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(self->width, self->height,
+	                    self->stride, self->vstride,
+	                    TEXGZ_UNSIGNED_BYTE,
+	                    TEXGZ_LUMINANCE, NULL);
+	if(tex == NULL)
+	{
+		goto fail_tex;
+	}
+
+	// the edge is stored as 128 and inside is brighter
+	int    x;
+	int    y;
+	float  s      = 128.0f/spread;
+	float* pixels = (float*) sdf->pixels;
+	for(y = 0; y < self->height; ++y)
+	{
+		for(x = 0; x < self->width; ++x)
+		{
+			float d = pixels[y*sdf->stride + x];
+			tex->pixels[y*tex->stride + x] = (unsigned char)
+			                                 cc_clamp(128.0f - s*d + 0.5f,
+			                                          0.0f, 255.0f);
+		}
+	}
+
+	texgz_tex_delete(&sdf);
+
+	// success
+	return tex;
+
+	// failure
+	fail_tex:
+		texgz_tex_delete(&sdf);
+	return NULL;
+}
+
+texgz_tex_t*
+texgz_tex_outlineSDF(texgz_tex_t* self, float radius)
+{
+	ASSERT(self);
+
+	if(radius < 0.0f)
+	{
+		LOGE("invalid radius=%f", radius);
+		return NULL;
+	}
+
+	if(texgz_tex_sdfValid(self) == 0)
+	{
+		return NULL;
+	}
+
+	// create the dst tex
+	// the padding matches texgz_tex_outline for
+	// radius = size/2
+	int off = (int) ceilf(radius + 0.5f) - 1;
+	if(off < 0)
+	{
+		off = 0;
+	}
+	int w2  = self->width  + 2*off;
+	int h2  = self->height + 2*off;
+	int w2r = w2 + (w2%2);
+	int h2r = h2 + (h2%2);
+	texgz_tex_t* tex;
+	tex = texgz_tex_new(w2r, h2r, w2r, h2r,
+	                    TEXGZ_UNSIGNED_BYTE,
+	                    TEXGZ_LUMINANCE_ALPHA, NULL);
+	if(tex == NULL)
+	{
+		return NULL;
+	}
+
+	// copy the base
+	int i;
+	int j;
+	unsigned char* ps = self->pixels;
+	unsigned char* pd = tex->pixels;
+	for(i = 0; i < self->height; ++i)
+	{
+		for(j = 0; j < self->width; ++j)
+		{
+			int i2 = i + off;
+			int j2 = j + off;
+			pd[2*(i2*tex->stride + j2)] = ps[i*self->stride + j];
+		}
+	}
+
+	// compute the distance on the padded base which is
+	// stored in the luminance channel
+	double* d;
+	d = texgz_tex_edt(tex->pixels, w2r, h2r,
+	                  2*tex->stride, 2, 1);
+	if(d == NULL)
+	{
+		texgz_tex_delete(&tex);
+		return NULL;
+	}
+
+	// the outline is the distance clamped to the radius
+	// with one pixel of antialiasing and always covers
+	// the base
+	for(i = 0; i < h2r; ++i)
+	{
+		for(j = 0; j < w2r; ++j)
+		{
+			int   idx = 2*(i*tex->stride + j);
+			float a   = radius + 0.5f - (float) sqrt(d[i*w2r + j]);
+			float b   = ((float) pd[idx])/255.0f;
+			a = cc_clamp(a, 0.0f, 1.0f);
+			if(b > a)
+			{
+				a = b;
+			}
+			pd[idx + 1] = (unsigned char) (255.0f*a + 0.5f);
+		}
+	}
+
+	FREE(d);
+
+	// success
+	return tex;
+}
+
+int texgz_tex_blit(texgz_tex_t* src, texgz_tex_t* dst,
+                   int width, int height,
+                   int xs, int ys, int xd, int yd)
+{
+	ASSERT(src);
+	ASSERT(dst);
+
+	if((src->type != dst->type) ||
+	   (src->format != dst->format))
+	{
+		LOGE("invalid src: type=0x%X, format=0x%X, dst: type=0x%x, format=0x%X",
+		     src->type, src->format, dst->type, dst->format);
+		return 0;
+	}
+
+	if((width <= 0) || (height <= 0) ||
+	   (xs + width > src->width) || (ys + height > src->height) ||
+	   (xd + width > dst->width) || (yd + height > dst->height))
+	{
+		LOGE("invalid width=%i, height=%i, xs=%i, ys=%i, xd=%i, yd=%i",
+		     width, height, xs, ys, xd, yd);
+		return 0;
+	}
+
+	// blit
+	int i;
+	int bpp   = texgz_tex_bpp(src);
+	int bytes = width*bpp;
+	for(i = 0; i < height; ++i)
+	{
+		int os = bpp*((ys + i)*src->stride + xs);
+		int od = bpp*((yd + i)*dst->stride + xd);
+		unsigned char* ps = &src->pixels[os];
+		unsigned char* pd = &dst->pixels[od];
+
+		memcpy((void*) pd, (void*) ps, bytes);
+	}
+
+	return 1;
+}
+
+void texgz_tex_clear(texgz_tex_t* self)
+{
+	ASSERT(self);
+
+	memset(self->pixels, 0, MEMSIZEPTR(self->pixels));
+}
+
+void texgz_tex_fill(texgz_tex_t* self,
+                    int top, int left,
+                    int width, int height,
+                    unsigned int color)
+{
+	ASSERT(self);
+	ASSERT(self->type   == TEXGZ_UNSIGNED_BYTE);
+	ASSERT(self->format == TEXGZ_RGBA);
+
+	if((width  <= 0) || (height <= 0))
+	{
+		// ignore
+		return;
+	}
+
+	// clip rectangle
+	int bottom = top  + height - 1;
+	int right  = left + width  - 1;
+	if((top    >= self->height) ||
+	   (left   >= self->width)  ||
+	   (bottom < 0)             ||
+	   (right  < 0))
+	{
+		return;
+	}
+
+	// resize rectangle
+	if(top < 0)
+	{
+		top = 0;
+	}
+	if(left < 0)
+	{
+		left = 0;
+	}
+	if(bottom >= self->height)
+	{
+		bottom = self->height - 1;
+	}
+	if(right >= self->width)
+	{
+		right = self->width - 1;
+	}
+
+	unsigned char r = (unsigned char) ((color >> 24)&0xFF);
+	unsigned char g = (unsigned char) ((color >> 16)&0xFF);
+	unsigned char b = (unsigned char) ((color >> 8)&0xFF);
+	unsigned char a = (unsigned char) (color&0xFF);
+
+	// fill first scanline
+	int i;
+	int j;
+	int bpp = texgz_tex_bpp(self);
+	unsigned char* pix;
+	for(i = top; i <= bottom; ++i)
+	{
+		int roff = bpp*i*self->stride;
+		for(j = left; j <= right; ++j)
+		{
+			int coff = bpp*j;
+			pix = &self->pixels[roff + coff];
+			pix[0] = r;
+			pix[1] = g;
+			pix[2] = b;
+			pix[3] = a;
+		}
+	}
+}
+
+void texgz_tex_lineDraw(texgz_tex_t* self,
+                        float x0, float y0,
+                        float x1, float y1,
+                        unsigned char* pixel)
+{
+	ASSERT(self);
+	ASSERT(pixel);
+
+	ASSERT(self->type    == TEXGZ_UNSIGNED_BYTE);
+	ASSERT((self->format == TEXGZ_RGB)  ||
+	       (self->format == TEXGZ_RGBA) ||
+	       (self->format == TEXGZ_LUMINANCE));
+
+	int direction = 1;
+	if(texgz_tex_lineClip(self, &direction, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	texgz_tex_lineDrawClipped(self, x0, y0, x1, y1, pixel);
+}
+
+void texgz_tex_lineDrawF(texgz_tex_t* self,
+                         float x0, float y0,
+                         float x1, float y1,
+                         float pixel)
+{
+	ASSERT(self);
+	ASSERT(self->type   == TEXGZ_FLOAT);
+	ASSERT(self->format == TEXGZ_LUMINANCE);
+
+	int direction = 1;
+	if(texgz_tex_lineClip(self, &direction, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	texgz_tex_lineDrawClippedF(self, x0, y0, x1, y1, pixel);
+}
+
+void texgz_tex_lineSampleF(texgz_tex_t* self, int id,
+                           float x0, float y0,
+                           float x1, float y1,
+                           int* _count,
+                           int* _size,
+                           texgz_sampleF_t** _samples)
+{
+	ASSERT(self);
+	ASSERT(_count);
+	ASSERT(_size);
+	ASSERT(_samples);
+
+	int direction = 1;
+	if(texgz_tex_lineClip(self, &direction, &x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	texgz_tex_lineSampleClippedF(self, id, x0, y0, x1, y1,
+	                             direction,
+	                             _count, _size, _samples);
+}
+
+void texgz_tex_sample(texgz_tex_t* self, float u, float v,
+                      int bpp, unsigned char* pixel)
+{
+	ASSERT(self);
+	ASSERT(pixel);
+	ASSERT((u >= 0.0f) && (u <= 1.0f));
+	ASSERT((v >= 0.0f) && (v <= 1.0f));
+	ASSERT(self->type == TEXGZ_UNSIGNED_BYTE);
+
+	// skip expensive ASSERT
+	// ASSERT(bpp == texgz_tex_bpp(self));
+
+	// "float indices"
+	float x = u*self->width - 0.5f;
+	float y = v*self->height - 0.5f;
+
+	// determine indices to sample
+	// floor prevents extrapolation near the top/left edge
+	int x0 = (int) floorf(x);
+	int y0 = (int) floorf(y);
+	int x1 = x0 + 1;
+	int y1 = y0 + 1;
+
+	// clamp indices
+	x0 = texgz_clampi(x0, 0, self->width - 1);
+	y0 = texgz_clampi(y0, 0, self->height - 1);
+	x1 = texgz_clampi(x1, 0, self->width - 1);
+	y1 = texgz_clampi(y1, 0, self->height - 1);
+	if(x0 == x1)
+	{
+		x = (float) x0;
+	}
+	if(y0 == y1)
+	{
+		y = (float) y0;
+	}
+
+	// compute interpolation coefficients
+	float s = x - ((float) x0);
+	float t = y - ((float) y0);
+
+	// sample interpolation values
+	int i;
+	int offset00 = bpp*(y0*self->stride + x0);
+	int offset01 = bpp*(y1*self->stride + x0);
+	int offset10 = bpp*(y0*self->stride + x1);
+	int offset11 = bpp*(y1*self->stride + x1);
+	unsigned char* pixels = self->pixels;
+	for(i = 0; i < bpp; ++i)
+	{
+		// convert component to float
+		float f00 = (float) pixels[offset00 + i];
+		float f01 = (float) pixels[offset01 + i];
+		float f10 = (float) pixels[offset10 + i];
+		float f11 = (float) pixels[offset11 + i];
+
+		// interpolate x
+		float f0010 = f00 + s*(f10 - f00);
+		float f0111 = f01 + s*(f11 - f01);
+
+		// interpolate y
+		pixel[i] = (unsigned char)
+		           (f0010 + t*(f0111 - f0010) + 0.5f);
+	}
+}
+
+static void
+texgz_tex_cubicInterpolateRGBA(unsigned char* p, float s,
+                               unsigned char* out)
+{
+	ASSERT(p);
+	ASSERT(out);
+
+	// interpolate each component
+
+	float p0 = (float) p[0];
+	float p1 = (float) p[4];
+	float p2 = (float) p[8];
+	float p3 = (float) p[12];
+	float pi = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
+	out[0]   = (unsigned char) pi;
+
+	p0     = (float) p[1];
+	p1     = (float) p[5];
+	p2     = (float) p[9];
+	p3     = (float) p[13];
+	pi     = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
+	out[1] = (unsigned char) pi;
+
+	p0     = (float) p[2];
+	p1     = (float) p[6];
+	p2     = (float) p[10];
+	p3     = (float) p[14];
+	pi     = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
+	out[2] = (unsigned char) pi;
+
+	p0     = (float) p[3];
+	p1     = (float) p[7];
+	p2     = (float) p[11];
+	p3     = (float) p[15];
+	pi     = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
+	out[3] = (unsigned char) pi;
+}
+
+void
+texgz_tex_sampleBicubicRGBA(texgz_tex_t* self,
+                            float u, float v,
+                            unsigned char* pixel)
+{
+	ASSERT(self);
+	ASSERT(pixel);
+	ASSERT((u >= 0.0f) && (u <= 1.0f));
+	ASSERT((v >= 0.0f) && (v <= 1.0f));
+	ASSERT(self->type   == TEXGZ_UNSIGNED_BYTE);
+	ASSERT(self->format == TEXGZ_RGBA);
+
+	// http://paulbourke.net/miscellaneous/interpolation/
+	// https://www.paulinternet.nl/?page=bicubic
+
+	// "float indices"
+	float x = u*(self->width  - 1);
+	float y = v*(self->height - 1);
+
+	// determine indices to sample
+	int x1 = (int) x;
+	int y1 = (int) y;
+	int x0 = x1 - 1;
+	int y0 = y1 - 1;
+	int y2 = y1 + 1;
+	int x3 = x1 + 2;
+	int y3 = y1 + 2;
+
+	// double check the indices
+	if((x0 < 0) ||
+	   (y0 < 0) ||
+	   (x3 >= self->width) ||
+	   (y3 >= self->height))
+	{
+		texgz_tex_sample(self, u, v, 4, pixel);
+		return;
+	}
+
+	// compute interpolation coefficients
+	float s = x - ((float) x1);
+	float t = y - ((float) y1);
+
+	// sample interpolation values
+	int bpp = 4;
+	unsigned char* pixels  = self->pixels;
+	unsigned char* pixels0 = &pixels[bpp*(y0*self->stride + x0)];
+	unsigned char* pixels1 = &pixels[bpp*(y1*self->stride + x0)];
+	unsigned char* pixels2 = &pixels[bpp*(y2*self->stride + x0)];
+	unsigned char* pixels3 = &pixels[bpp*(y3*self->stride + x0)];
+	unsigned char  pixelsi[4*bpp];
+	texgz_tex_cubicInterpolateRGBA(pixels0, s, pixelsi),
+	texgz_tex_cubicInterpolateRGBA(pixels1, s, &pixelsi[bpp]),
+	texgz_tex_cubicInterpolateRGBA(pixels2, s, &pixelsi[2*bpp]),
+	texgz_tex_cubicInterpolateRGBA(pixels3, s, &pixelsi[3*bpp]),
+	texgz_tex_cubicInterpolateRGBA(pixelsi, t, pixel);
+}
+
+static float          texgz_tex_lanczos3Lut[TEXGZ_SAMPLE_PHASES + 1][6];
+static pthread_once_t texgz_tex_lanczos3Once = PTHREAD_ONCE_INIT;
+
+static void texgz_tex_lanczos3LutInit(void)
+{
+	int i;
+	int t;
+	for(i = 0; i <= TEXGZ_SAMPLE_PHASES; ++i)
+	{
+		double s   = ((double) i)/TEXGZ_SAMPLE_PHASES;
+		double sum = 0.0;
+		double w[6];
+		for(t = 0; t < 6; ++t)
+		{
+			// distance from the tap to the sample
+			double d = fabs(((double) (t - 2)) - s);
+			if(d < 1e-6)
+			{
+				w[t] = 1.0;
+			}
+			else if(d < 3.0)
+			{
+				double pd = M_PI*d;
+				w[t] = 3.0*sin(pd)*sin(pd/3.0)/(pd*pd);
+			}
+			else
+			{
+				w[t] = 0.0;
+			}
+			sum += w[t];
+		}
+
+		for(t = 0; t < 6; ++t)
+		{
+			texgz_tex_lanczos3Lut[i][t] = (float) (w[t]/sum);
+		}
+	}
+}
+
+static int texgz_tex_address(int i, int n, int address)
+{
+	if(address == TEXGZ_ADDRESS_REPEAT)
+	{
+		i = i%n;
+		return (i < 0) ? i + n : i;
+	}
+	else if(address == TEXGZ_ADDRESS_MIRROR)
+	{
+		int n2 = 2*n;
+		i = i%n2;
+		if(i < 0)
+		{
+			i += n2;
+		}
+		return (i < n) ? i : n2 - 1 - i;
+	}
+
+	// TEXGZ_ADDRESS_CLAMP
+	if(i < 0)
+	{
+		return 0;
+	}
+	else if(i >= n)
+	{
+		return n - 1;
+	}
+	return i;
+}
+
+// compute the filter taps for a block of coordinates
+// where the pixel centers are located at (i + 0.5)/n
+static int
+texgz_tex_sampleTaps(int filter, int address, int size,
+                     int count, const float* uv,
+                     int (*idx)[TEXGZ_SAMPLE_BLOCK],
+                     float (*wgt)[TEXGZ_SAMPLE_BLOCK])
+{
+	ASSERT(uv);
+	ASSERT(idx);
+	ASSERT(wgt);
+
+	int   k;
+	int   t;
+	float n = (float) size;
+	if(filter == TEXGZ_FILTER_NEAREST)
+	{
+		for(k = 0; k < count; ++k)
+		{
+			int i = (int) floorf(uv[k]*n);
+			idx[0][k] = texgz_tex_address(i, size, address);
+			wgt[0][k] = 1.0f;
+		}
+		return 1;
+	}
+	else if(filter == TEXGZ_FILTER_BILINEAR)
+	{
+		for(k = 0; k < count; ++k)
+		{
+			float x  = uv[k]*n - 0.5f;
+			float x0 = floorf(x);
+			float s  = x - x0;
+			int   i  = (int) x0;
+			idx[0][k] = texgz_tex_address(i, size, address);
+			idx[1][k] = texgz_tex_address(i + 1, size, address);
+			wgt[0][k] = 1.0f - s;
+			wgt[1][k] = s;
+		}
+		return 2;
+	}
+	else if(filter == TEXGZ_FILTER_LANCZOS3)
+	{
+		pthread_once(&texgz_tex_lanczos3Once,
+		             texgz_tex_lanczos3LutInit);
+
+		for(k = 0; k < count; ++k)
+		{
+			float x  = uv[k]*n - 0.5f;
+			float x0 = floorf(x);
+			int   p  = (int) ((x - x0)*TEXGZ_SAMPLE_PHASES + 0.5f);
+			int   i  = (int) x0;
+			float* w = texgz_tex_lanczos3Lut[p];
+			for(t = 0; t < 6; ++t)
+			{
+				idx[t][k] = texgz_tex_address(i + t - 2, size,
+				                              address);
+				wgt[t][k] = w[t];
+			}
+		}
+		return 6;
+	}
+
+	// TEXGZ_FILTER_BICUBIC
+	// Catmull-Rom weights matching
+	// texgz_tex_cubicInterpolateRGBA
+	for(k = 0; k < count; ++k)
+	{
+		float x  = uv[k]*n - 0.5f;
+		float x1 = floorf(x);
+		float s  = x - x1;
+		float s2 = s*s;
+		float s3 = s2*s;
+		int   i  = (int) x1;
+		for(t = 0; t < 4; ++t)
+		{
+			idx[t][k] = texgz_tex_address(i + t - 1, size,
+			                              address);
+		}
+		wgt[0][k] = 0.5f*(-s + 2.0f*s2 - s3);
+		wgt[1][k] = 0.5f*(2.0f - 5.0f*s2 + 3.0f*s3);
+		wgt[2][k] = 0.5f*(s + 4.0f*s2 - 3.0f*s3);
+		wgt[3][k] = 0.5f*(s3 - s2);
+	}
+	return 4;
+}
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+// accumulate the taps of a block of RGBA coordinates
+// where the pixel is loaded into a vector of 4 floats
+static void
+texgz_tex_sampleBlock4(texgz_tex_t* self, int taps, int count,
+                       int (*ix)[TEXGZ_SAMPLE_BLOCK],
+                       int (*iy)[TEXGZ_SAMPLE_BLOCK],
+                       float (*wx)[TEXGZ_SAMPLE_BLOCK],
+                       float (*wy)[TEXGZ_SAMPLE_BLOCK],
+                       float* out)
+{
+	ASSERT(self);
+	ASSERT(ix);
+	ASSERT(iy);
+	ASSERT(wx);
+	ASSERT(wy);
+	ASSERT(out);
+
+	int i;
+	int j;
+	int k;
+	int stride = self->stride;
+	for(k = 0; k < count; ++k)
+	{
+		#if defined(__SSE2__)
+		__m128  acc = _mm_setzero_ps();
+		__m128i z   = _mm_setzero_si128();
+		#else
+		float32x4_t acc = vdupq_n_f32(0.0f);
+		#endif
+		for(j = 0; j < taps; ++j)
+		{
+			int row = iy[j][k]*stride;
+			for(i = 0; i < taps; ++i)
+			{
+				float w   = wy[j][k]*wx[i][k];
+				int   off = 4*(row + ix[i][k]);
+
+				#if defined(__SSE2__)
+				__m128 p;
+				if(self->type == TEXGZ_FLOAT)
+				{
+					float* pf = (float*) self->pixels;
+					p = _mm_loadu_ps(&pf[off]);
+				}
+				else
+				{
+					int32_t t;
+					memcpy(&t, &self->pixels[off], 4);
+
+					__m128i v = _mm_cvtsi32_si128(t);
+					v = _mm_unpacklo_epi8(v, z);
+					v = _mm_unpacklo_epi16(v, z);
+					p = _mm_cvtepi32_ps(v);
+				}
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w), p));
+				#else
+				float32x4_t p;
+				if(self->type == TEXGZ_FLOAT)
+				{
+					float* pf = (float*) self->pixels;
+					p = vld1q_f32(&pf[off]);
+				}
+				else
+				{
+					uint32_t t;
+					memcpy(&t, &self->pixels[off], 4);
+
+					uint8x8_t  v8  = vreinterpret_u8_u32(vdup_n_u32(t));
+					uint16x4_t v16 = vget_low_u16(vmovl_u8(v8));
+					p = vcvtq_f32_u32(vmovl_u16(v16));
+				}
+				acc = vaddq_f32(acc, vmulq_f32(vdupq_n_f32(w), p));
+				#endif
+			}
+		}
+
+		#if defined(__SSE2__)
+		_mm_storeu_ps(&out[4*k], acc);
+		#else
+		vst1q_f32(&out[4*k], acc);
+		#endif
+	}
+}
+
+#endif
+
+// sample a block of coordinates in the native range of
+// the texture (e.g. 0-255 for bytes)
+static void
+texgz_tex_sampleBlock(texgz_tex_t* self, int channels,
+                      int filter, int address, int count,
+                      const float* u, const float* v,
+                      float* out)
+{
+	ASSERT(self);
+	ASSERT(u);
+	ASSERT(v);
+	ASSERT(out);
+
+	int   ix[TEXGZ_SAMPLE_TAPS][TEXGZ_SAMPLE_BLOCK];
+	int   iy[TEXGZ_SAMPLE_TAPS][TEXGZ_SAMPLE_BLOCK];
+	float wx[TEXGZ_SAMPLE_TAPS][TEXGZ_SAMPLE_BLOCK];
+	float wy[TEXGZ_SAMPLE_TAPS][TEXGZ_SAMPLE_BLOCK];
+
+	int taps;
+	taps = texgz_tex_sampleTaps(filter, address, self->width,
+	                            count, u, ix, wx);
+	texgz_tex_sampleTaps(filter, address, self->height,
+	                     count, v, iy, wy);
+
+	int   i;
+	int   j;
+	int   k;
+	int   c;
+	int   stride = self->stride;
+	float acc[4];
+
+	#if defined(__SSE2__) || defined(__ARM_NEON)
+	// RGBA is accumulated as a single vector
+	if(channels == 4)
 	{
-		for(j = 0; j < self->width; ++j)
-		{
-			int i2 = i + off;
-			int j2 = j + off;
-			pd[2*(i2*tex->stride + j2)] = ps[i*self->stride + j];
-		}
+		texgz_tex_sampleBlock4(self, taps, count,
+		                       ix, iy, wx, wy, out);
+		return;
 	}
+	#endif
 
-	// sample the outline
-	for(i = 0; i < h2; ++i)
+	for(k = 0; k < count; ++k)
 	{
-		for(j = 0; j < w2; ++j)
+		acc[0] = 0.0f;
+		acc[1] = 0.0f;
+		acc[2] = 0.0f;
+		acc[3] = 0.0f;
+		for(j = 0; j < taps; ++j)
+		{
+			int row = iy[j][k]*stride;
+			for(i = 0; i < taps; ++i)
+			{
+				float w   = wy[j][k]*wx[i][k];
+				int   off = channels*(row + ix[i][k]);
+				if(self->type == TEXGZ_FLOAT)
+				{
+					float* p = (float*) self->pixels;
+					for(c = 0; c < channels; ++c)
+					{
+						acc[c] += w*p[off + c];
+					}
+				}
+				else
+				{
+					unsigned char* p = self->pixels;
+					for(c = 0; c < channels; ++c)
+					{
+						acc[c] += w*((float) p[off + c]);
+					}
+				}
+			}
+		}
+
+		for(c = 0; c < channels; ++c)
 		{
-			texgz_tex_sampleOutline(tex, i, j, mask, size);
+			out[channels*k + c] = acc[c];
 		}
 	}
-
-	// success
-	return tex;
-
-	// failure
-	return NULL;
 }
 
-int texgz_tex_blit(texgz_tex_t* src, texgz_tex_t* dst,
-                   int width, int height,
-                   int xs, int ys, int xd, int yd)
+static int
+texgz_tex_sampleValid(texgz_tex_t* self,
+                      int filter, int address)
 {
-	ASSERT(src);
-	ASSERT(dst);
+	ASSERT(self);
 
-	if((src->type != dst->type) ||
-	   (src->format != dst->format))
+	if((filter < TEXGZ_FILTER_NEAREST) ||
+	   (filter > TEXGZ_FILTER_LANCZOS3))
 	{
-		LOGE("invalid src: type=0x%X, format=0x%X, dst: type=0x%x, format=0x%X",
-		     src->type, src->format, dst->type, dst->format);
+		LOGE("invalid filter=%i", filter);
 		return 0;
 	}
 
-	if((width <= 0) || (height <= 0) ||
-	   (xs + width > src->width) || (ys + height > src->height) ||
-	   (xd + width > dst->width) || (yd + height > dst->height))
+	if((address < TEXGZ_ADDRESS_CLAMP) ||
+	   (address > TEXGZ_ADDRESS_MIRROR))
 	{
-		LOGE("invalid width=%i, height=%i, xs=%i, ys=%i, xd=%i, yd=%i",
-		     width, height, xs, ys, xd, yd);
+		LOGE("invalid address=%i", address);
 		return 0;
 	}
 
-	// blit
-	int i;
-	int bpp   = texgz_tex_bpp(src);
-	int bytes = width*bpp;
-	for(i = 0; i < height; ++i)
+	if(((self->type != TEXGZ_UNSIGNED_BYTE) &&
+	    (self->type != TEXGZ_FLOAT)) ||
+	   (texgz_tex_filterChannels(self) == 0))
 	{
-		int os = bpp*((ys + i)*src->stride + xs);
-		int od = bpp*((yd + i)*dst->stride + xd);
-		unsigned char* ps = &src->pixels[os];
-		unsigned char* pd = &dst->pixels[od];
-
-		memcpy((void*) pd, (void*) ps, bytes);
+		LOGE("invalid type=0x%X, format=0x%X",
+		     self->type, self->format);
+		return 0;
 	}
 
 	return 1;
 }
 
-void texgz_tex_clear(texgz_tex_t* self)
-{
-	ASSERT(self);
-
-	memset(self->pixels, 0, MEMSIZEPTR(self->pixels));
-}
-
-void texgz_tex_fill(texgz_tex_t* self,
-                    int top, int left,
-                    int width, int height,
-                    unsigned int color)
+int texgz_tex_sampleN(texgz_tex_t* self,
+                      int filter, int address,
+                      int count,
+                      const float* u, const float* v,
+                      unsigned char* pixels)
 {
 	ASSERT(self);
-	ASSERT(self->type   == TEXGZ_UNSIGNED_BYTE);
-	ASSERT(self->format == TEXGZ_RGBA);
+	ASSERT(u);
+	ASSERT(v);
+	ASSERT(pixels);
 
-	if((width  <= 0) || (height <= 0))
+	if(texgz_tex_sampleValid(self, filter, address) == 0)
 	{
-		// ignore
-		return;
+		return 0;
 	}
 
-	// clip rectangle
-	int bottom = top  + height - 1;
-	int right  = left + width  - 1;
-	if((top    >= self->height) ||
-	   (left   >= self->width)  ||
-	   (bottom < 0)             ||
-	   (right  < 0))
+	if(self->type != TEXGZ_UNSIGNED_BYTE)
 	{
-		return;
+		LOGE("invalid type=0x%X", self->type);
+		return 0;
 	}
 
-	// resize rectangle
-	if(top < 0)
-	{
-		top = 0;
-	}
-	if(left < 0)
-	{
-		left = 0;
-	}
-	if(bottom >= self->height)
-	{
-		bottom = self->height - 1;
-	}
-	if(right >= self->width)
-	{
-		right = self->width - 1;
-	}
+	int   i;
+	int   k;
+	int   n;
+	int   channels = texgz_tex_filterChannels(self);
+	float out[4*TEXGZ_SAMPLE_BLOCK];
+	for(k = 0; k < count; k += TEXGZ_SAMPLE_BLOCK)
+	{
+		n = count - k;
+		if(n > TEXGZ_SAMPLE_BLOCK)
+		{
+			n = TEXGZ_SAMPLE_BLOCK;
+		}
 
-	unsigned char r = (unsigned char) ((color >> 24)&0xFF);
-	unsigned char g = (unsigned char) ((color >> 16)&0xFF);
-	unsigned char b = (unsigned char) ((color >> 8)&0xFF);
-	unsigned char a = (unsigned char) (color&0xFF);
+		texgz_tex_sampleBlock(self, channels, filter,
+		                      address, n, &u[k], &v[k], out);
 
-	// fill first scanline
-	int i;
-	int j;
-	int bpp = texgz_tex_bpp(self);
-	unsigned char* pix;
-	for(i = top; i <= bottom; ++i)
-	{
-		int roff = bpp*i*self->stride;
-		for(j = left; j <= right; ++j)
+		unsigned char* dst = &pixels[channels*k];
+		for(i = 0; i < channels*n; ++i)
 		{
-			int coff = bpp*j;
-			pix = &self->pixels[roff + coff];
-			pix[0] = r;
-			pix[1] = g;
-			pix[2] = b;
-			pix[3] = a;
+			dst[i] = (unsigned char)
+			         cc_clamp(out[i] + 0.5f, 0.0f, 255.0f);
 		}
 	}
+
+	return 1;
 }
 
-void texgz_tex_lineDraw(texgz_tex_t* self,
-                        float x0, float y0,
-                        float x1, float y1,
-                        unsigned char* pixel)
+int texgz_tex_sampleNF(texgz_tex_t* self,
+                       int filter, int address,
+                       int count,
+                       const float* u, const float* v,
+                       float* pixels)
 {
 	ASSERT(self);
-	ASSERT(pixel);
-
-	ASSERT(self->type    == TEXGZ_UNSIGNED_BYTE);
-	ASSERT((self->format == TEXGZ_RGB)  ||
-	       (self->format == TEXGZ_RGBA) ||
-	       (self->format == TEXGZ_LUMINANCE));
+	ASSERT(u);
+	ASSERT(v);
+	ASSERT(pixels);
 
-	int direction = 1;
-	if(texgz_tex_lineClip(self, &direction, &x0, &y0, &x1, &y1))
+	if(texgz_tex_sampleValid(self, filter, address) == 0)
 	{
-		return;
+		return 0;
 	}
 
-	texgz_tex_lineDrawClipped(self, x0, y0, x1, y1, pixel);
-}
-
-void texgz_tex_lineDrawF(texgz_tex_t* self,
-                         float x0, float y0,
-                         float x1, float y1,
-                         float pixel)
-{
-	ASSERT(self);
-	ASSERT(self->type   == TEXGZ_FLOAT);
-	ASSERT(self->format == TEXGZ_LUMINANCE);
-
-	int direction = 1;
-	if(texgz_tex_lineClip(self, &direction, &x0, &y0, &x1, &y1))
+	int k;
+	int n;
+	int channels = texgz_tex_filterChannels(self);
+	for(k = 0; k < count; k += TEXGZ_SAMPLE_BLOCK)
 	{
-		return;
+		n = count - k;
+		if(n > TEXGZ_SAMPLE_BLOCK)
+		{
+			n = TEXGZ_SAMPLE_BLOCK;
+		}
+
+		texgz_tex_sampleBlock(self, channels, filter,
+		                      address, n, &u[k], &v[k],
+		                      &pixels[channels*k]);
 	}
 
-	texgz_tex_lineDrawClippedF(self, x0, y0, x1, y1, pixel);
+	return 1;
 }
 
-void texgz_tex_lineSampleF(texgz_tex_t* self, int id,
-                           float x0, float y0,
-                           float x1, float y1,
-                           int* _count,
-                           int* _size,
-                           texgz_sampleF_t** _samples)
+#define TEXGZ_REMAP_MODE_MAP        0
+#define TEXGZ_REMAP_MODE_AFFINE     1
+#define TEXGZ_REMAP_MODE_HOMOGRAPHY 2
+
+typedef struct
 {
-	ASSERT(self);
-	ASSERT(_count);
-	ASSERT(_size);
-	ASSERT(_samples);
+	texgz_tex_t* src;
+	texgz_tex_t* map;
+	texgz_tex_t* dst;
+	int          mode;
+	int          filter;
+	int          channels;
+	double       m[9];
+} texgz_tex_remap_t;
 
-	int direction = 1;
-	if(texgz_tex_lineClip(self, &direction, &x0, &y0, &x1, &y1))
+static float texgz_tex_remapClamp(float uv)
+{
+	// the address mode clamps the coordinates to the
+	// edge so clamp extreme values (and NaN) before they
+	// are converted to indices
+	if(uv >= -1.0f)
 	{
-		return;
+		return (uv <= 2.0f) ? uv : 2.0f;
 	}
-
-	texgz_tex_lineSampleClippedF(self, id, x0, y0, x1, y1,
-	                             direction,
-	                             _count, _size, _samples);
+	return -1.0f;
 }
 
-void texgz_tex_sample(texgz_tex_t* self, float u, float v,
-                      int bpp, unsigned char* pixel)
+static void
+texgz_tex_remapCoords(texgz_tex_remap_t* self,
+                      int x0, int y, int count,
+                      float* u, float* v)
 {
 	ASSERT(self);
-	ASSERT(pixel);
-	ASSERT((u >= 0.0f) && (u <= 1.0f));
-	ASSERT((v >= 0.0f) && (v <= 1.0f));
-	ASSERT(self->type == TEXGZ_UNSIGNED_BYTE);
-
-	// skip expensive ASSERT
-	// ASSERT(bpp == texgz_tex_bpp(self));
+	ASSERT(u);
+	ASSERT(v);
 
-	// "float indices"
-	float x = u*self->width - 0.5f;
-	float y = v*self->height - 0.5f;
+	int k;
+	if(self->mode == TEXGZ_REMAP_MODE_MAP)
+	{
+		texgz_tex_t* map = self->map;
 
-	// determine indices to sample
-	int x0 = (int) x;
-	int y0 = (int) y;
-	int x1 = x0 + 1;
-	int y1 = y0 + 1;
+		float* p = (float*) map->pixels;
+		p = &p[2*(y*map->stride + x0)];
+		for(k = 0; k < count; ++k)
+		{
+			u[k] = texgz_tex_remapClamp(p[2*k]);
+			v[k] = texgz_tex_remapClamp(p[2*k + 1]);
+		}
+		return;
+	}
 
-	// clamp indices
-	x0 = texgz_clampi(x0, 0, self->width - 1);
-	y0 = texgz_clampi(y0, 0, self->height - 1);
-	x1 = texgz_clampi(x1, 0, self->width - 1);
-	y1 = texgz_clampi(y1, 0, self->height - 1);
-	if(x0 == x1)
+	// the coordinates are stepped incrementally from the
+	// dst pixel center (x0,y)
+	double* m  = self->m;
+	double  du = 1.0/self->dst->width;
+	double  ud = (x0 + 0.5)*du;
+	double  vd = (y + 0.5)/self->dst->height;
+	double  a  = m[0]*ud + m[1]*vd + m[2];
+	double  b  = m[3]*ud + m[4]*vd + m[5];
+	double  da = m[0]*du;
+	double  db = m[3]*du;
+	if(self->mode == TEXGZ_REMAP_MODE_AFFINE)
 	{
-		x = (float) x0;
+		for(k = 0; k < count; ++k)
+		{
+			u[k] = texgz_tex_remapClamp((float) a);
+			v[k] = texgz_tex_remapClamp((float) b);
+			a += da;
+			b += db;
+		}
+		return;
 	}
-	if(y0 == y1)
+
+	// TEXGZ_REMAP_MODE_HOMOGRAPHY
+	double c  = m[6]*ud + m[7]*vd + m[8];
+	double dc = m[6]*du;
+	for(k = 0; k < count; ++k)
 	{
-		y = (float) y0;
+		u[k] = texgz_tex_remapClamp((float) (a/c));
+		v[k] = texgz_tex_remapClamp((float) (b/c));
+		a += da;
+		b += db;
+		c += dc;
 	}
+}
 
-	// compute interpolation coefficients
-	float s = x - ((float) x0);
-	float t = y - ((float) y0);
+static void
+texgz_tex_remapTiles(void* priv, int tid, int t0, int t1)
+{
+	ASSERT(priv);
 
-	// sample interpolation values
-	int i;
-	int offset00 = bpp*(y0*self->stride + x0);
-	int offset01 = bpp*(y1*self->stride + x0);
-	int offset10 = bpp*(y0*self->stride + x1);
-	int offset11 = bpp*(y1*self->stride + x1);
-	unsigned char* pixels = self->pixels;
-	for(i = 0; i < bpp; ++i)
-	{
-		// convert component to float
-		float f00 = (float) pixels[offset00 + i];
-		float f01 = (float) pixels[offset01 + i];
-		float f10 = (float) pixels[offset10 + i];
-		float f11 = (float) pixels[offset11 + i];
+	texgz_tex_remap_t* self = (texgz_tex_remap_t*) priv;
 
-		// interpolate x
-		float f0010 = f00 + s*(f10 - f00);
-		float f0111 = f01 + s*(f11 - f01);
+	texgz_tex_t* dst = self->dst;
 
-		// interpolate y
-		pixel[i] = (unsigned char)
-		           (f0010 + t*(f0111 - f0010) + 0.5f);
+	int   i;
+	int   x0;
+	int   y0;
+	int   y;
+	int   n;
+	int   channels = self->channels;
+	float u[TEXGZ_REMAP_TILE];
+	float v[TEXGZ_REMAP_TILE];
+	float out[4*TEXGZ_REMAP_TILE];
+	for(y0 = t0*TEXGZ_REMAP_TILE; y0 < t1*TEXGZ_REMAP_TILE;
+	    y0 += TEXGZ_REMAP_TILE)
+	{
+		int y1 = y0 + TEXGZ_REMAP_TILE;
+		if(y1 > dst->height)
+		{
+			y1 = dst->height;
+		}
+
+		for(x0 = 0; x0 < dst->width; x0 += TEXGZ_REMAP_TILE)
+		{
+			n = dst->width - x0;
+			if(n > TEXGZ_REMAP_TILE)
+			{
+				n = TEXGZ_REMAP_TILE;
+			}
+
+			for(y = y0; y < y1; ++y)
+			{
+				texgz_tex_remapCoords(self, x0, y, n, u, v);
+				texgz_tex_sampleBlock(self->src, channels,
+				                      self->filter,
+				                      TEXGZ_ADDRESS_CLAMP,
+				                      n, u, v, out);
+
+				int offset = channels*(y*dst->stride + x0);
+				if(dst->type == TEXGZ_FLOAT)
+				{
+					float* p = (float*) dst->pixels;
+					memcpy(&p[offset], out,
+					       channels*n*sizeof(float));
+				}
+				else
+				{
+					unsigned char* p = &dst->pixels[offset];
+					for(i = 0; i < channels*n; ++i)
+					{
+						p[i] = (unsigned char)
+						       cc_clamp(out[i] + 0.5f,
+						                0.0f, 255.0f);
+					}
+				}
+			}
+		}
 	}
 }
 
-static void
-texgz_tex_cubicInterpolateRGBA(unsigned char* p, float s,
-                               unsigned char* out)
+static int texgz_tex_remapRun(texgz_tex_remap_t* self)
 {
-	ASSERT(p);
-	ASSERT(out);
+	ASSERT(self);
 
-	// interpolate each component
+	texgz_tex_t* src = self->src;
+	texgz_tex_t* dst = self->dst;
 
-	float p0 = (float) p[0];
-	float p1 = (float) p[4];
-	float p2 = (float) p[8];
-	float p3 = (float) p[12];
-	float pi = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
-	out[0]   = (unsigned char) pi;
+	if(texgz_tex_sampleValid(src, self->filter,
+	                         TEXGZ_ADDRESS_CLAMP) == 0)
+	{
+		return 0;
+	}
 
-	p0     = (float) p[1];
-	p1     = (float) p[5];
-	p2     = (float) p[9];
-	p3     = (float) p[13];
-	pi     = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
-	out[1] = (unsigned char) pi;
+	if((dst->type != src->type) || (dst->format != src->format))
+	{
+		LOGE("invalid type=0x%X:0x%X, format=0x%X:0x%X",
+		     src->type, dst->type, src->format, dst->format);
+		return 0;
+	}
 
-	p0     = (float) p[2];
-	p1     = (float) p[6];
-	p2     = (float) p[10];
-	p3     = (float) p[14];
-	pi     = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
-	out[2] = (unsigned char) pi;
+	self->channels = texgz_tex_filterChannels(src);
 
-	p0     = (float) p[3];
-	p1     = (float) p[7];
-	p2     = (float) p[11];
-	p3     = (float) p[15];
-	pi     = cc_clamp(p1 + 0.5f*s*(p2 - p0 + s*(2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3 + s*(3.0f*(p1 - p2) + p3 - p0))), 0.0f, 255.0f);
-	out[3] = (unsigned char) pi;
+	int tiles = (dst->height + TEXGZ_REMAP_TILE - 1)/
+	            TEXGZ_REMAP_TILE;
+	texgz_thread_parallel(tiles, self, texgz_tex_remapTiles);
+
+	return 1;
 }
 
-void
-texgz_tex_sampleBicubicRGBA(texgz_tex_t* self,
-                            float u, float v,
-                            unsigned char* pixel)
+int texgz_tex_remap(texgz_tex_t* src, texgz_tex_t* map,
+                    texgz_tex_t* dst, int filter)
 {
-	ASSERT(self);
-	ASSERT(pixel);
-	ASSERT((u >= 0.0f) && (u <= 1.0f));
-	ASSERT((v >= 0.0f) && (v <= 1.0f));
-	ASSERT(self->type   == TEXGZ_UNSIGNED_BYTE);
-	ASSERT(self->format == TEXGZ_RGBA);
+	ASSERT(src);
+	ASSERT(map);
+	ASSERT(dst);
 
-	// http://paulbourke.net/miscellaneous/interpolation/
-	// https://www.paulinternet.nl/?page=bicubic
+	if((map->type   != TEXGZ_FLOAT) ||
+	   (map->format != TEXGZ_LUMINANCE_ALPHA))
+	{
+		LOGE("invalid type=0x%X, format=0x%X",
+		     map->type, map->format);
+		return 0;
+	}
 
-	// "float indices"
-	float x = u*(self->width  - 1);
-	float y = v*(self->height - 1);
+	if((map->width  != dst->width) ||
+	   (map->height != dst->height))
+	{
+		LOGE("invalid map=%ix%i, dst=%ix%i",
+		     map->width, map->height,
+		     dst->width, dst->height);
+		return 0;
+	}
 
-	// determine indices to sample
-	int x1 = (int) x;
-	int y1 = (int) y;
-	int x0 = x1 - 1;
-	int y0 = y1 - 1;
-	int y2 = y1 + 1;
-	int x3 = x1 + 2;
-	int y3 = y1 + 2;
+	texgz_tex_remap_t remap =
+	{
+		.src    = src,
+		.map    = map,
+		.dst    = dst,
+		.mode   = TEXGZ_REMAP_MODE_MAP,
+		.filter = filter,
+	};
 
-	// double check the indices
-	if((x0 < 0) ||
-	   (y0 < 0) ||
-	   (x3 >= self->width) ||
-	   (y3 >= self->height))
+	return texgz_tex_remapRun(&remap);
+}
+
+int texgz_tex_remapAffine(texgz_tex_t* src,
+                          const float* affine,
+                          texgz_tex_t* dst, int filter)
+{
+	ASSERT(src);
+	ASSERT(affine);
+	ASSERT(dst);
+
+	texgz_tex_remap_t remap =
 	{
-		texgz_tex_sample(self, u, v, 4, pixel);
-		return;
+		.src    = src,
+		.dst    = dst,
+		.mode   = TEXGZ_REMAP_MODE_AFFINE,
+		.filter = filter,
+	};
+
+	int i;
+	for(i = 0; i < 6; ++i)
+	{
+		remap.m[i] = (double) affine[i];
 	}
 
-	// compute interpolation coefficients
-	float s = x - ((float) x1);
-	float t = y - ((float) y1);
+	return texgz_tex_remapRun(&remap);
+}
 
-	// sample interpolation values
-	int bpp = 4;
-	unsigned char* pixels  = self->pixels;
-	unsigned char* pixels0 = &pixels[bpp*(y0*self->stride + x0)];
-	unsigned char* pixels1 = &pixels[bpp*(y1*self->stride + x0)];
-	unsigned char* pixels2 = &pixels[bpp*(y2*self->stride + x0)];
-	unsigned char* pixels3 = &pixels[bpp*(y3*self->stride + x0)];
-	unsigned char  pixelsi[4*bpp];
-	texgz_tex_cubicInterpolateRGBA(pixels0, s, pixelsi),
-	texgz_tex_cubicInterpolateRGBA(pixels1, s, &pixelsi[bpp]),
-	texgz_tex_cubicInterpolateRGBA(pixels2, s, &pixelsi[2*bpp]),
-	texgz_tex_cubicInterpolateRGBA(pixels3, s, &pixelsi[3*bpp]),
-	texgz_tex_cubicInterpolateRGBA(pixelsi, t, pixel);
+int texgz_tex_remapHomography(texgz_tex_t* src,
+                              const float* homography,
+                              texgz_tex_t* dst, int filter)
+{
+	ASSERT(src);
+	ASSERT(homography);
+	ASSERT(dst);
+
+	texgz_tex_remap_t remap =
+	{
+		.src    = src,
+		.dst    = dst,
+		.mode   = TEXGZ_REMAP_MODE_HOMOGRAPHY,
+		.filter = filter,
+	};
+
+	int i;
+	for(i = 0; i < 9; ++i)
+	{
+		remap.m[i] = (double) homography[i];
+	}
+
+	return texgz_tex_remapRun(&remap);
 }
 
 void texgz_tex_getPixel(texgz_tex_t* self,
@@ -4491,7 +7676,9 @@ int texgz_tex_mipmap(texgz_tex_t* self, int miplevels,
 	ASSERT(self);
 	ASSERT(mipmaps);
 
-	// note that mipmaps[0] is self
+	// note that mipmaps[0] is self and that this is the
+	// legacy box filter chain (see texgz_tex_downscale)
+	// while texgz_tex_mipmapChain selects the method
 
 	// set mipmaps[l]
 	int l;
@@ -4526,6 +7713,257 @@ int texgz_tex_mipmap(texgz_tex_t* self, int miplevels,
 	return 0;
 }
 
+int texgz_tex_mipmapPlan(int width, int height,
+                         int method, int depth,
+                         int miplevels,
+                         texgz_mipmapPlan_t* plan)
+{
+	ASSERT(plan);
+
+	if((width <= 0) || (height <= 0) || (miplevels <= 0) ||
+	   (depth < 0)  ||
+	   ((method != TEXGZ_MIPMAP_METHOD_BOX)      &&
+	    (method != TEXGZ_MIPMAP_METHOD_LANCZOS3) &&
+	    (method != TEXGZ_MIPMAP_METHOD_INLIER)))
+	{
+		LOGE("invalid width=%i, height=%i, method=%i, "
+		     "depth=%i, miplevels=%i",
+		     width, height, method, depth, miplevels);
+		return 0;
+	}
+
+	// the base level is not filtered
+	memset(&plan[0], 0, sizeof(texgz_mipmapPlan_t));
+	plan[0].scalex = 1;
+	plan[0].scaley = 1;
+
+	// select the source for each level
+	// the recursive source (l - 1) is always the cheapest
+	// but each resampling accumulates error so the depth
+	// limits the number of resampling operations from the
+	// base level (e.g. depth=1 filters every level from the
+	// base and depth=0 is fully recursive) and a wider
+	// kernel is only paid for when the limit is reached
+	int l;
+	int k;
+	texgz_mipmapPlan_t best;
+	texgz_mipmapPlan_t cand;
+	for(l = 1; l < miplevels; ++l)
+	{
+		int found = 0;
+		for(k = l - 1; k >= 0; --k)
+		{
+			texgz_tex_mipmapCost(method, width, height,
+			                     k, l, &cand);
+			if(texgz_tex_mipmapValid(method, width, height,
+			                         k, l, &cand) == 0)
+			{
+				continue;
+			}
+			cand.depth = plan[k].depth + 1;
+
+			// prefer candidates within the depth limit,
+			// then the lowest cost, otherwise the lowest
+			// depth when the limit cannot be satisfied
+			// where best is only valid once found
+			int ok_cand = (depth == 0) || (cand.depth <= depth);
+			int ok_best = found &&
+			              ((depth == 0) || (best.depth <= depth));
+			if((found == 0)              ||
+			   (ok_cand && (ok_best == 0)) ||
+			   (ok_cand && (cand.cost < best.cost)) ||
+			   ((ok_cand == 0) && (ok_best == 0) &&
+			    (cand.depth < best.depth)))
+			{
+				best  = cand;
+				found = 1;
+			}
+		}
+
+		if(found == 0)
+		{
+			LOGE("invalid width=%i, height=%i, level=%i",
+			     width, height, l);
+			return 0;
+		}
+
+		plan[l] = best;
+	}
+
+	return 1;
+}
+
+int texgz_tex_mipmapPlanned(texgz_tex_t* self, int method,
+                            int miplevels,
+                            const texgz_mipmapPlan_t* plan,
+                            texgz_tex_t** mipmaps)
+{
+	ASSERT(self);
+	ASSERT(plan);
+	ASSERT(mipmaps);
+
+	// note that mipmaps[0] is self
+
+	if(((self->type   == TEXGZ_UNSIGNED_BYTE) ||
+	    (self->type   == TEXGZ_FLOAT)) &&
+	   (self->format == TEXGZ_RGBA))
+	{
+		// ok
+	}
+	else
+	{
+		LOGE("invalid type=0x%X, format=0x%X",
+		     self->type, self->format);
+		return 0;
+	}
+
+	// filter the levels as floats since subsequent levels
+	// may be filtered from any previous level except for
+	// the inlier method which filters the levels in the
+	// input type (see texgz_tex_mipmapInlier)
+	texgz_tex_t** levels;
+	levels = (texgz_tex_t**)
+	         CALLOC(miplevels, sizeof(texgz_tex_t*));
+	if(levels == NULL)
+	{
+		LOGE("CALLOC failed");
+		return 0;
+	}
+
+	if((self->type == TEXGZ_FLOAT) ||
+	   (method == TEXGZ_MIPMAP_METHOD_INLIER))
+	{
+		levels[0] = self;
+	}
+	else
+	{
+		levels[0] = texgz_tex_convertFcopy(self, 0.0f, 1.0f,
+		                                   TEXGZ_FLOAT,
+		                                   TEXGZ_RGBA);
+		if(levels[0] == NULL)
+		{
+			goto fail_base;
+		}
+	}
+
+	int l;
+	int w;
+	int h;
+	if(method == TEXGZ_MIPMAP_METHOD_INLIER)
+	{
+		if(texgz_tex_mipmapInlier(self, miplevels, plan,
+		                          levels) == 0)
+		{
+			goto fail_level;
+		}
+	}
+	else
+	{
+		for(l = 1; l < miplevels; ++l)
+		{
+			if((plan[l].src < 0) || (plan[l].src >= l))
+			{
+				LOGE("invalid level=%i, src=%i", l, plan[l].src);
+				goto fail_level;
+			}
+
+			w = (self->width  >> l) ? (self->width  >> l) : 1;
+			h = (self->height >> l) ? (self->height >> l) : 1;
+			levels[l] = texgz_tex_decimateF(levels[plan[l].src],
+			                                method, w, h);
+			if(levels[l] == NULL)
+			{
+				goto fail_level;
+			}
+		}
+	}
+
+	// convert to input type
+	if((method != TEXGZ_MIPMAP_METHOD_INLIER) &&
+	   (self->type == TEXGZ_UNSIGNED_BYTE))
+	{
+		for(l = 1; l < miplevels; ++l)
+		{
+			if(texgz_tex_convertF(levels[l], 0.0f, 1.0f,
+			                      TEXGZ_UNSIGNED_BYTE,
+			                      TEXGZ_RGBA) == 0)
+			{
+				goto fail_level;
+			}
+		}
+		texgz_tex_delete(&levels[0]);
+	}
+
+	// set mipmaps
+	mipmaps[0] = self;
+	for(l = 1; l < miplevels; ++l)
+	{
+		mipmaps[l] = levels[l];
+	}
+
+	FREE(levels);
+
+	// success
+	return 1;
+
+	// failure
+	fail_level:
+	{
+		for(l = 1; l < miplevels; ++l)
+		{
+			texgz_tex_delete(&levels[l]);
+		}
+		if(levels[0] != self)
+		{
+			texgz_tex_delete(&levels[0]);
+		}
+	}
+	fail_base:
+		FREE(levels);
+	return 0;
+}
+
+int texgz_tex_mipmapChain(texgz_tex_t* self, int method,
+                          int depth, int miplevels,
+                          texgz_tex_t** mipmaps)
+{
+	ASSERT(self);
+	ASSERT(mipmaps);
+
+	texgz_mipmapPlan_t* plan;
+	plan = (texgz_mipmapPlan_t*)
+	       CALLOC(miplevels, sizeof(texgz_mipmapPlan_t));
+	if(plan == NULL)
+	{
+		LOGE("CALLOC failed");
+		return 0;
+	}
+
+	if(texgz_tex_mipmapPlan(self->width, self->height,
+	                        method, depth, miplevels,
+	                        plan) == 0)
+	{
+		goto fail_plan;
+	}
+
+	if(texgz_tex_mipmapPlanned(self, method, miplevels,
+	                           plan, mipmaps) == 0)
+	{
+		goto fail_planned;
+	}
+
+	FREE(plan);
+
+	// success
+	return 1;
+
+	// failure
+	fail_planned:
+	fail_plan:
+		FREE(plan);
+	return 0;
+}
+
 int texgz_tex_channels(texgz_tex_t* self)
 {
 	ASSERT(self);
@@ -4597,6 +8035,16 @@ int texgz_tex_bpp(texgz_tex_t* self)
 	{
 		bpp = 2;
 	}
+	else if((self->type == TEXGZ_UNSIGNED_SHORT) &&
+	        (self->format == TEXGZ_LUMINANCE))
+	{
+		bpp = 2;
+	}
+	else if((self->type == TEXGZ_UNSIGNED_INT) &&
+	        (self->format == TEXGZ_LUMINANCE))
+	{
+		bpp = 4;
+	}
 	else if((self->type == TEXGZ_UNSIGNED_BYTE) &&
 	        (self->format == TEXGZ_LUMINANCE_ALPHA))
 	{
@@ -4612,6 +8060,11 @@ int texgz_tex_bpp(texgz_tex_t* self)
 	{
 		bpp = 16;
 	}
+	else if((self->type == TEXGZ_FLOAT) &&
+	        (self->format == TEXGZ_LUMINANCE_ALPHA))
+	{
+		bpp = 8;
+	}
 	else if((self->type == TEXGZ_UNSIGNED_SHORT_5_6_5) &&
 	        (self->format == TEXGZ_RGB))
 	{
@@ -35,6 +35,8 @@
 #define TEXGZ_UNSIGNED_SHORT_5_6_5   0x8363
 #define TEXGZ_UNSIGNED_BYTE          0x1401
 #define TEXGZ_SHORT                  0x1402
+#define TEXGZ_UNSIGNED_SHORT         0x1403
+#define TEXGZ_UNSIGNED_INT           0x1405
 #define TEXGZ_FLOAT                  0x1406
 
 // OpenGL ES format
@@ -49,6 +51,28 @@
 #define TEXGZ_RG00            0x9999
 #define TEXGZ_LABL            0x999A
 
+// mipmap methods
+// the inlier method averages the samples of each block
+// within TEXGZ_MIPMAP_INLIER_SDX standard deviations of
+// the block mean (see texgz_tex_inlier)
+#define TEXGZ_MIPMAP_METHOD_BOX      0
+#define TEXGZ_MIPMAP_METHOD_LANCZOS3 1
+#define TEXGZ_MIPMAP_METHOD_INLIER   2
+#define TEXGZ_MIPMAP_INLIER_SDX      1.0f
+
+// sample filters
+// texgz_tex_sampleN/sampleNF place pixel centers at
+// u = (x + 0.5)/width and v = (y + 0.5)/height
+#define TEXGZ_FILTER_NEAREST  0
+#define TEXGZ_FILTER_BILINEAR 1
+#define TEXGZ_FILTER_BICUBIC  2
+#define TEXGZ_FILTER_LANCZOS3 3
+
+// sample address modes
+#define TEXGZ_ADDRESS_CLAMP  0
+#define TEXGZ_ADDRESS_REPEAT 1
+#define TEXGZ_ADDRESS_MIRROR 2
+
 typedef struct
 {
 	int   id;
@@ -57,6 +81,22 @@ typedef struct
 	float pixel;
 } texgz_sampleF_t;
 
+// mipmap chain plan
+// each level is filtered from a previous level (src)
+// where depth is the number of resampling operations
+// from the base level and cost is the estimated
+// taps x pixels of the separable filter
+typedef struct
+{
+	int    src;
+	int    depth;
+	int    scalex;
+	int    scaley;
+	int    tapsx;
+	int    tapsy;
+	double cost;
+} texgz_mipmapPlan_t;
+
 typedef struct
 {
 	int width;
@@ -103,6 +143,7 @@ int          texgz_tex_RGB2LABF(texgz_tex_t* self,
                                 texgz_tex_t** _labl,
                                 texgz_tex_t** _laba,
                                 texgz_tex_t** _labb);
+texgz_tex_t* texgz_tex_RGB2LABFcopy(texgz_tex_t* self);
 texgz_tex_t* texgz_tex_channelF(texgz_tex_t* self,
                                 int channel,
                                 float min, float max);
@@ -118,6 +159,14 @@ int          texgz_tex_blur(texgz_tex_t* self,
 texgz_tex_t* texgz_tex_blurcopy(texgz_tex_t* self,
                                 float sigma,
                                 float mu, int size);
+int          texgz_tex_gaussian(texgz_tex_t* self,
+                                float sigma);
+texgz_tex_t* texgz_tex_gaussiancopy(texgz_tex_t* self,
+                                    float sigma);
+int          texgz_tex_boxblur(texgz_tex_t* self,
+                               int radius);
+texgz_tex_t* texgz_tex_boxblurcopy(texgz_tex_t* self,
+                                   int radius);
 int          texgz_tex_rotate90(texgz_tex_t* self);
 texgz_tex_t* texgz_tex_rotate90copy(texgz_tex_t* self);
 int          texgz_tex_rotate180(texgz_tex_t* self);
@@ -126,11 +175,22 @@ int          texgz_tex_rotate270(texgz_tex_t* self);
 texgz_tex_t* texgz_tex_rotate270copy(texgz_tex_t* self);
 int          texgz_tex_flipvertical(texgz_tex_t* self);
 texgz_tex_t* texgz_tex_flipverticalcopy(texgz_tex_t* self);
+int          texgz_tex_fliphorizontal(texgz_tex_t* self);
+texgz_tex_t* texgz_tex_fliphorizontalcopy(texgz_tex_t* self);
+int          texgz_tex_flipverticalconvert(texgz_tex_t* self,
+                                           int type, int format);
+texgz_tex_t* texgz_tex_flipverticalconvertcopy(texgz_tex_t* self,
+                                               int type,
+                                               int format);
 int          texgz_tex_crop(texgz_tex_t* self, int top, int left, int bottom, int right);
 texgz_tex_t* texgz_tex_cropcopy(texgz_tex_t* self, int top, int left, int bottom, int right);
 int          texgz_tex_pad(texgz_tex_t* self);
 texgz_tex_t* texgz_tex_padcopy(texgz_tex_t* self);
 texgz_tex_t* texgz_tex_outline(texgz_tex_t* self, int size);
+texgz_tex_t* texgz_tex_sdfF(texgz_tex_t* self);
+texgz_tex_t* texgz_tex_sdf(texgz_tex_t* self, float spread);
+texgz_tex_t* texgz_tex_outlineSDF(texgz_tex_t* self,
+                                  float radius);
 int          texgz_tex_blit(texgz_tex_t* src, texgz_tex_t* dst,
                             int width, int height,
                             int xs, int ys, int xd, int yd);
@@ -160,6 +220,35 @@ void         texgz_tex_sample(texgz_tex_t* self,
 void         texgz_tex_sampleBicubicRGBA(texgz_tex_t* self,
                                          float u, float v,
                                          unsigned char* pixel);
+int          texgz_tex_sampleN(texgz_tex_t* self,
+                               int filter, int address,
+                               int count,
+                               const float* u,
+                               const float* v,
+                               unsigned char* pixels);
+int          texgz_tex_sampleNF(texgz_tex_t* self,
+                                int filter, int address,
+                                int count,
+                                const float* u,
+                                const float* v,
+                                float* pixels);
+// remap
+// the map is a FLOAT/LUMINANCE_ALPHA texture containing
+// the src uv for each dst pixel and the affine (2x3) or
+// homography (3x3) matrices are row-major transforms from
+// the dst uv to the src uv (addressing is clamped)
+int          texgz_tex_remap(texgz_tex_t* src,
+                             texgz_tex_t* map,
+                             texgz_tex_t* dst,
+                             int filter);
+int          texgz_tex_remapAffine(texgz_tex_t* src,
+                                   const float* affine,
+                                   texgz_tex_t* dst,
+                                   int filter);
+int          texgz_tex_remapHomography(texgz_tex_t* src,
+                                       const float* homography,
+                                       texgz_tex_t* dst,
+                                       int filter);
 void         texgz_tex_getPixel(texgz_tex_t* self,
                                 int x, int y,
                                 unsigned char* pixel);
@@ -178,6 +267,19 @@ void         texgz_tex_setPixelF(texgz_tex_t* self,
 int          texgz_tex_mipmap(texgz_tex_t* self,
                               int miplevels,
                               texgz_tex_t** mipmaps);
+int          texgz_tex_mipmapPlan(int width, int height,
+                                  int method, int depth,
+                                  int miplevels,
+                                  texgz_mipmapPlan_t* plan);
+int          texgz_tex_mipmapPlanned(texgz_tex_t* self,
+                                     int method,
+                                     int miplevels,
+                                     const texgz_mipmapPlan_t* plan,
+                                     texgz_tex_t** mipmaps);
+int          texgz_tex_mipmapChain(texgz_tex_t* self,
+                                   int method, int depth,
+                                   int miplevels,
+                                   texgz_tex_t** mipmaps);
 int          texgz_tex_channels(texgz_tex_t* self);
 int          texgz_tex_bpp(texgz_tex_t* self);
 int          texgz_tex_size(texgz_tex_t* self);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Jeff Boody
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define LOG_TAG "texgz"
+#include "../libcc/cc_log.h"
+#include "texgz_thread.h"
+
+#define TEXGZ_THREAD_MAX 64
+
+typedef struct
+{
+	int   tid;
+	int   i0;
+	int   i1;
+	void* priv;
+
+	texgz_thread_runFn run_fn;
+} texgz_threadBand_t;
+
+/***********************************************************
+* private                                                  *
+***********************************************************/
+
+static void* texgz_thread_main(void* arg)
+{
+	ASSERT(arg);
+
+	texgz_threadBand_t* band = (texgz_threadBand_t*) arg;
+
+	band->run_fn(band->priv, band->tid, band->i0, band->i1);
+
+	return NULL;
+}
+
+/***********************************************************
+* public                                                   *
+***********************************************************/
+
+int texgz_thread_count(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if(count < 1)
+	{
+		count = 1;
+	}
+	else if(count > TEXGZ_THREAD_MAX)
+	{
+		count = TEXGZ_THREAD_MAX;
+	}
+
+	return (int) count;
+}
+
+void texgz_thread_parallel(int count, void* priv,
+                           texgz_thread_runFn run_fn)
+{
+	ASSERT(run_fn);
+
+	if(count <= 0)
+	{
+		return;
+	}
+
+	int n = texgz_thread_count();
+	if(n > count)
+	{
+		n = count;
+	}
+
+	// split the range into bands
+	int i;
+	texgz_threadBand_t band[TEXGZ_THREAD_MAX];
+	for(i = 0; i < n; ++i)
+	{
+		band[i].tid    = i;
+		band[i].i0     = (int) ((((long long) count)*i)/n);
+		band[i].i1     = (int) ((((long long) count)*(i + 1))/n);
+		band[i].priv   = priv;
+		band[i].run_fn = run_fn;
+	}
+
+	// the first band is run on the calling thread and
+	// bands are also run on the calling thread if a
+	// thread cannot be created
+	pthread_t thread[TEXGZ_THREAD_MAX];
+	int       started[TEXGZ_THREAD_MAX];
+	for(i = 1; i < n; ++i)
+	{
+		started[i] = 0;
+		if(pthread_create(&thread[i], NULL,
+		                  texgz_thread_main, &band[i]) == 0)
+		{
+			started[i] = 1;
+		}
+		else
+		{
+			LOGW("pthread_create failed");
+		}
+	}
+
+	texgz_thread_main(&band[0]);
+
+	for(i = 1; i < n; ++i)
+	{
+		if(started[i])
+		{
+			pthread_join(thread[i], NULL);
+		}
+		else
+		{
+			texgz_thread_main(&band[i]);
+		}
+	}
+}
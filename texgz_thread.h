@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Jeff Boody
+ * Copyright (c) 2026 Jeff Boody
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
  * copy of this software and associated documentation files (the "Software"),
@@ -21,12 +21,18 @@
  *
  */
 
-#ifndef texgz_inlier_H
-#define texgz_inlier_H
+#ifndef texgz_thread_H
+#define texgz_thread_H
 
-#include "texgz/texgz_tex.h"
+// run_fn is called once per band of the range [0, count)
+// where the bands are contiguous and tid is in the range
+// [0, texgz_thread_count()) so that callers may allocate
+// per-thread state in advance
+typedef void (*texgz_thread_runFn)(void* priv, int tid,
+                                   int i0, int i1);
 
-texgz_tex_t* texgz_tex_inlier(texgz_tex_t* tex,
-                              int s, float sdx);
+int  texgz_thread_count(void);
+void texgz_thread_parallel(int count, void* priv,
+                           texgz_thread_runFn run_fn);
 
 #endif